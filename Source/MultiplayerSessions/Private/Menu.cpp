@@ -4,6 +4,7 @@
 #include "Menu.h"
 #include "Components/Button.h"
 #include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionsLog.h"
 #include "OnlineSessionSettings.h"
 #include "Interfaces/OnlineSessionInterface.h"
 
@@ -12,6 +13,7 @@ void UMenu::MenuSetup(int32 NumberOfPublicConnections /*= 4*/, FString TypeOfMat
 	NumPublicConnections = NumberOfPublicConnections;
 	MatchType = TypeOfMatch;
 	PathToLobby = FString::Printf(TEXT("%s?listen"), *LobbyPath);
+	LobbyMapName = LobbyPath;
 
 	AddToViewport();
 	SetVisibility(ESlateVisibility::Visible);
@@ -43,9 +45,13 @@ void UMenu::MenuSetup(int32 NumberOfPublicConnections /*= 4*/, FString TypeOfMat
 
 	MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &UMenu::OnCreateSession); //For dynamic delegates
 	MultiplayerSessionsSubsystem->MultiplayerOnFindSessionComplete.AddUObject(this, &UMenu::OnFindSession);		//For non-dynamic delegates
+	MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsBatch.AddUObject(this, &UMenu::OnFindSessionsBatch);
+	MultiplayerSessionsSubsystem->MultiplayerOnFindBestSessionComplete.AddUObject(this, &UMenu::OnFindBestSession);
 	MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &UMenu::OnJoinSession);
 	MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete.AddDynamic(this, &UMenu::OnDestroySession);
 	MultiplayerSessionsSubsystem->MultiplayerOnStartSessionComplete.AddDynamic(this, &UMenu::OnDestroySession);
+
+	MultiplayerSessionsSubsystem->StartBackgroundRefresh(MakeSearchSettings(), SessionRefreshInterval);
 }
 
 bool UMenu::Initialize()
@@ -75,9 +81,17 @@ void UMenu::NativeDestruct()
 
 void UMenu::OnCreateSession(bool bWasSuccessfull)
 {
+	//A party created next to the menu is none of its business
+	if(MultiplayerSessionsSubsystem && MultiplayerSessionsSubsystem->GetOperationSessionName() != NAME_GameSession)
+		return;
+
 	if (!bWasSuccessfull)
 	{
-		LogError(TEXT("Failed to create session"));
+		MULTIPLAYER_LOG(Error, TEXT("Failed to create session"));
+		if (MultiplayerSessionsSubsystem)
+		{
+			MultiplayerSessionsSubsystem->ReleasePreloadedMap();
+		}
 		HostButton->SetIsEnabled(true);
 		JoinButton->SetIsEnabled(true);
 		return;
@@ -87,82 +101,109 @@ void UMenu::OnCreateSession(bool bWasSuccessfull)
 	if (!World)
 		return;
 
-	//Travel to the lobby level and open it as a server
+	//Travel to the lobby level and open it as a server, most of it is already loaded by now
 	World->ServerTravel(PathToLobby);
 }
 
 void UMenu::OnFindSession(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull)
 {
+	//Already ranking the sessions picked from the streamed batches
+	if(bIsRanking || bIsJoining)
+		return;
+
 	if (!bWasSuccessfull)
 	{
-		LogError(TEXT("Failed to find sessions"));
+		MULTIPLAYER_LOG(Error, TEXT("Failed to find sessions"));
+		HostButton->SetIsEnabled(true);
+		JoinButton->SetIsEnabled(true);
 		return;
 	}
 	else
 	{
-		LogSuccess(TEXT("Session found"));
+		MULTIPLAYER_LOG(Log, TEXT("Session found"));
 	}
 
 	if(!MultiplayerSessionsSubsystem)
 		return;
 
-	for (const auto Result : SearchResults)
-	{
+	if(TryRankMatchingSessions())
+		return;
+
+	HostButton->SetIsEnabled(true);
+	JoinButton->SetIsEnabled(true);
+}
+
+void UMenu::OnFindSessionsBatch(TArrayView<const FOnlineSessionSearchResult> SearchResults, int32 FirstResultIndex)
+{
+	if(bIsRanking || bIsJoining)
+		return;
 
-		LogSuccess(TEXT("Trying to connect"));
+	if(!MultiplayerSessionsSubsystem)
+		return;
 
-		FString SettingsValue;
-		Result.Session.SessionSettings.Get(FName("MatchType"), SettingsValue);
+	if(MultiplayerSessionsSubsystem->FindSearchResultsByMatchType(MatchType).Num() < NumSessionsToRank)
+		return;
 
-		if(SettingsValue != MatchType)
-			continue;
+	//Got enough candidates, no need to wait for the rest of the search
+	MultiplayerSessionsSubsystem->CancelFindSessions();
+	TryRankMatchingSessions();
+}
 
-		LogSuccess(TEXT("Connecting"));
-		MultiplayerSessionsSubsystem->JoinSession(Result);
+void UMenu::OnFindBestSession(const TArray<FMultiplayerRankedSession>& RankedSessions, bool bWasSuccessfull)
+{
+	if(!bIsRanking)
 		return;
-	}
 
-	if (!bWasSuccessfull || SearchResults.IsEmpty())
+	bIsRanking = false;
+
+	if (!bWasSuccessfull || !MultiplayerSessionsSubsystem)
 	{
+		MULTIPLAYER_LOG(Error, TEXT("None of the found sessions answered"));
 		HostButton->SetIsEnabled(true);
 		JoinButton->SetIsEnabled(true);
+		return;
 	}
+
+	//Falls back to the next best one by itself if the host filled up in the meantime
+	MULTIPLAYER_LOG(Log, TEXT("Connecting, ping %d"), RankedSessions[0].RttInMs);
+	bIsJoining = true;
+	MultiplayerSessionsSubsystem->JoinAnySession(RankedSessions);
 }
 
 void UMenu::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
 {
+	if(MultiplayerSessionsSubsystem && MultiplayerSessionsSubsystem->GetOperationSessionName() != NAME_GameSession)
+		return;
+
+	bIsJoining = false;
+
 	if (Result != EOnJoinSessionCompleteResult::Success)
 	{
-		LogError(TEXT("Failed to join session"));
+		MULTIPLAYER_LOG(Error, TEXT("Failed to join session"));
 		HostButton->SetIsEnabled(true);
 		JoinButton->SetIsEnabled(true);
 		return;
 	}
 	
-	LogSuccess(TEXT("Joining session"));
+	MULTIPLAYER_LOG(Verbose, TEXT("Joining session"));
 
 	if(!MultiplayerSessionsSubsystem)
 		return;
 
-	LogSuccess(TEXT("Subsystem available"));
+	MULTIPLAYER_LOG(Verbose, TEXT("Subsystem available"));
 
 	if(!GetGameInstance())
 		return;
 
-	LogSuccess(TEXT("Game instance available"));
+	MULTIPLAYER_LOG(Verbose, TEXT("Game instance available"));
 
 	APlayerController* PlayerController{ GetGameInstance()->GetFirstLocalPlayerController() };
 	if(!PlayerController)
 		return;
 
-	LogSuccess(TEXT("Client travel"));
-
-	FString SessionAddress{ MultiplayerSessionsSubsystem->GetSessionAddress() };
-	LogSuccess(SessionAddress);
+	MULTIPLAYER_LOG(Verbose, TEXT("Client travel to %s"), *MultiplayerSessionsSubsystem->GetSessionAddress());
 
-	UE_LOG(LogTemp, Warning, TEXT("Address: "), *SessionAddress);
-
-	PlayerController->ClientTravel(MultiplayerSessionsSubsystem->GetSessionAddress(), ETravelType::TRAVEL_Absolute);
+	MultiplayerSessionsSubsystem->TravelToSession(PlayerController);
 }
 
 void UMenu::OnDestroySession(bool bWasSuccessfull)
@@ -184,6 +225,9 @@ void UMenu::OnHostButtonClicked()
 		return;
 
 
+	//Load the lobby from disk while the backend creates the session, instead of one after the other
+	MultiplayerSessionsSubsystem->PreloadMap(LobbyMapName);
+
 	//Create session using plugin
 	MultiplayerSessionsSubsystem->CreateSession(NumPublicConnections, MatchType);
 
@@ -195,14 +239,26 @@ void UMenu::OnJoinButtonClicked()
 	if(!MultiplayerSessionsSubsystem)
 		return;
 
-	LogSuccess(TEXT("Searching for seassion started"));
-	MultiplayerSessionsSubsystem->FindSessions(10000);
+	MULTIPLAYER_LOG(Verbose, TEXT("Searching for seassion started"));
+	bIsRanking = false;
+	bIsJoining = false;
+
+	FMultiplayerSearchSettings SearchSettings{ MakeSearchSettings() };
+	SearchSettings.BatchSize = SearchBatchSize;
+	SearchSettings.MaxCacheAge = MaxSearchCacheAge;
 
+	//A cache hit reports back before FindSessions returns
 	HostButton->SetIsEnabled(false);
+	MultiplayerSessionsSubsystem->FindSessions(SearchSettings);
 }
 
 void UMenu::MenuTearDown()
 {
+	if (MultiplayerSessionsSubsystem)
+	{
+		MultiplayerSessionsSubsystem->StopBackgroundRefresh();
+	}
+
 	RemoveFromParent();
 
 	UWorld* World{ GetWorld() };
@@ -218,37 +274,25 @@ void UMenu::MenuTearDown()
 	PlayerController->SetShowMouseCursor(false);
 }
 
-void UMenu::LogError(FString ErrorText)
-{
-	DebugLog(ErrorText, FColor::Red);
-}
-
-void UMenu::LogWarning(FString WarningText)
+FMultiplayerSearchSettings UMenu::MakeSearchSettings() const
 {
-	DebugLog(WarningText, FColor::Yellow);
+	FMultiplayerSearchSettings SearchSettings;
+	SearchSettings.MaxSearchResults = 10000;
+	SearchSettings.MatchType = MatchType;
+	SearchSettings.MinOpenSlots = 1;
+	//Any of the first few open sessions will do, no need to list every host out there
+	SearchSettings.NumWantedResults = NumSessionsToRank;
+	SearchSettings.ProcessingBudgetMs = ResultsProcessingBudgetMs;
+	SearchSettings.bParseOnWorkerThreads = true;
+	return SearchSettings;
 }
 
-void UMenu::LogSuccess(FString SuccessText)
+bool UMenu::TryRankMatchingSessions()
 {
-	DebugLog(SuccessText, FColor::Green);
-}
-
-void UMenu::LogVerbose(FString VerboseText)
-{
-	DebugLog(VerboseText, FColor::Cyan);
-}
-
-void UMenu::DebugLog(FString Text, FColor Color)
-{
-	if(!GEngine)
-		return;
+	if(MultiplayerSessionsSubsystem->FindSearchResultsByMatchType(MatchType).IsEmpty())
+		return false;
 
-	GEngine->AddOnScreenDebugMessage
-	(
-		-1,
-		10.f,
-		Color,
-		Text
-	);
+	bIsRanking = true;
+	MultiplayerSessionsSubsystem->FindBestSession(MatchType, NumSessionsToRank);
+	return true;
 }
-
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsAdmission.h"
+
+void FMultiplayerSessionsAdmission::Start(int32 InNumSlots, int32 InMaxConcurrentHandshakes, float InReservationTimeout)
+{
+	Stop();
+
+	NumSlots = InNumSlots;
+	MaxConcurrentHandshakes = FMath::Max(InMaxConcurrentHandshakes, 1);
+	ReservationTimeout = FMath::Max(InReservationTimeout, 1.f);
+	bIsActive = true;
+}
+
+void FMultiplayerSessionsAdmission::Stop()
+{
+	Reservations.Reset();
+	Players.Reset();
+	NumSlots = 0;
+	NumHandshakes = 0;
+	bIsActive = false;
+}
+
+bool FMultiplayerSessionsAdmission::Reserve(const FString& PlayerId, double Now)
+{
+	if(!bIsActive || PlayerId.IsEmpty())
+		return false;
+
+	if(Players.Contains(PlayerId))
+		return true;
+
+	if (FReservation* Reservation{ Reservations.Find(PlayerId) })
+	{
+		Reservation->ExpireTime = Now + ReservationTimeout;
+		return true;
+	}
+
+	if(GetNumOpenSlots() <= 0)
+		return false;
+
+	Reservations.Add(PlayerId, FReservation{ Now + ReservationTimeout, false });
+	return true;
+}
+
+EMultiplayerAdmissionResult FMultiplayerSessionsAdmission::BeginHandshake(const FString& PlayerId, double Now)
+{
+	//Already in, e.g. logging in again after a travel
+	if(!bIsActive || PlayerId.IsEmpty() || Players.Contains(PlayerId))
+		return EMultiplayerAdmissionResult::Admitted;
+
+	FReservation* Reservation{ Reservations.Find(PlayerId) };
+	if (Reservation && Reservation->bIsHandshaking)
+	{
+		Reservation->ExpireTime = Now + ReservationTimeout;
+		return EMultiplayerAdmissionResult::Admitted;
+	}
+
+	//Checked first so a player with a reservation keeps it while trying again
+	if(NumHandshakes >= MaxConcurrentHandshakes)
+		return EMultiplayerAdmissionResult::Busy;
+
+	if (!Reservation)
+	{
+		if(GetNumOpenSlots() <= 0)
+			return EMultiplayerAdmissionResult::Full;
+
+		Reservation = &Reservations.Add(PlayerId);
+	}
+
+	Reservation->ExpireTime = Now + ReservationTimeout;
+	Reservation->bIsHandshaking = true;
+	++NumHandshakes;
+	return EMultiplayerAdmissionResult::Admitted;
+}
+
+void FMultiplayerSessionsAdmission::CompleteHandshake(const FString& PlayerId)
+{
+	if(!bIsActive || PlayerId.IsEmpty())
+		return;
+
+	RemoveReservation(PlayerId);
+	Players.Add(PlayerId);
+}
+
+void FMultiplayerSessionsAdmission::Release(const FString& PlayerId)
+{
+	if(!bIsActive || PlayerId.IsEmpty())
+		return;
+
+	RemoveReservation(PlayerId);
+	Players.Remove(PlayerId);
+}
+
+int32 FMultiplayerSessionsAdmission::ExpireReservations(double Now)
+{
+	int32 NumExpired{ 0 };
+
+	for (auto It{ Reservations.CreateIterator() }; It; ++It)
+	{
+		if(It->Value.ExpireTime > Now)
+			continue;
+
+		if (It->Value.bIsHandshaking)
+		{
+			--NumHandshakes;
+		}
+
+		It.RemoveCurrent();
+		++NumExpired;
+	}
+
+	return NumExpired;
+}
+
+void FMultiplayerSessionsAdmission::RemoveReservation(const FString& PlayerId)
+{
+	FReservation Reservation;
+	if(!Reservations.RemoveAndCopyValue(PlayerId, Reservation))
+		return;
+
+	if (Reservation.bIsHandshaking)
+	{
+		--NumHandshakes;
+	}
+}
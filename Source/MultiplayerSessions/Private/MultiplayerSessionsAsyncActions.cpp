@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsAsyncActions.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/PlayerController.h"
+
+void UMultiplayerSessionsAsyncAction::Cancel()
+{
+	if(!MultiplayerSessionsSubsystem.IsValid())
+		return;
+
+	MultiplayerSessionsSubsystem->CancelOperation(Handle);
+}
+
+UMultiplayerSessionsSubsystem* UMultiplayerSessionsAsyncAction::InitSubsystem(UObject* WorldContextObject)
+{
+	const UWorld* World{ GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr };
+	UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+	if(!GameInstance)
+		return nullptr;
+
+	RegisterWithGameInstance(GameInstance);
+	MultiplayerSessionsSubsystem = GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>();
+	return MultiplayerSessionsSubsystem.Get();
+}
+
+UAsyncCreateSession* UAsyncCreateSession::CreateSessionFromPreset(UObject* WorldContextObject, FName PresetName)
+{
+	UAsyncCreateSession* Action{ NewObject<UAsyncCreateSession>() };
+	Action->PresetName = PresetName;
+	Action->InitSubsystem(WorldContextObject);
+	return Action;
+}
+
+void UAsyncCreateSession::Activate()
+{
+	if (!MultiplayerSessionsSubsystem.IsValid())
+	{
+		OnFailure.Broadcast();
+		SetReadyToDestroy();
+		return;
+	}
+
+	MultiplayerSessionsSubsystem->CreateSessionAsync(PresetName, &Handle).Next([WeakThis = TWeakObjectPtr<UAsyncCreateSession>(this)](const FMultiplayerSessionResult& Result)
+	{
+		if(!WeakThis.IsValid())
+			return;
+
+		if (Result.bWasSuccessfull)
+		{
+			WeakThis->OnSuccess.Broadcast();
+		}
+		else
+		{
+			WeakThis->OnFailure.Broadcast();
+		}
+
+		WeakThis->SetReadyToDestroy();
+	});
+}
+
+UAsyncFindSessions* UAsyncFindSessions::FindSessions(UObject* WorldContextObject, const FString& MatchType, int32 MaxSearchResults /*= 10000*/, float MaxCacheAge /*= 0.f*/)
+{
+	UAsyncFindSessions* Action{ NewObject<UAsyncFindSessions>() };
+	Action->MatchType = MatchType;
+	Action->MaxSearchResults = MaxSearchResults;
+	Action->MaxCacheAge = MaxCacheAge;
+	Action->InitSubsystem(WorldContextObject);
+	return Action;
+}
+
+void UAsyncFindSessions::Activate()
+{
+	if (!MultiplayerSessionsSubsystem.IsValid())
+	{
+		OnFailure.Broadcast(0);
+		SetReadyToDestroy();
+		return;
+	}
+
+	FMultiplayerSearchSettings SearchSettings;
+	SearchSettings.MaxSearchResults = MaxSearchResults;
+	SearchSettings.MatchType = MatchType;
+	SearchSettings.MaxCacheAge = MaxCacheAge;
+
+	MultiplayerSessionsSubsystem->FindSessionsAsync(SearchSettings, &Handle).Next([WeakThis = TWeakObjectPtr<UAsyncFindSessions>(this)](const FMultiplayerFindSessionsResult& Result)
+	{
+		if(!WeakThis.IsValid())
+			return;
+
+		const int32 NumResults{ Result.Search.IsValid() ? Result.Search->SearchResults.Num() : 0 };
+		if (Result.bWasSuccessfull && NumResults > 0)
+		{
+			WeakThis->OnSuccess.Broadcast(NumResults);
+		}
+		else
+		{
+			WeakThis->OnFailure.Broadcast(NumResults);
+		}
+
+		WeakThis->SetReadyToDestroy();
+	});
+}
+
+UAsyncJoinSession* UAsyncJoinSession::JoinSessionByIndex(UObject* WorldContextObject, int32 ResultIndex, bool bTravel /*= true*/)
+{
+	UAsyncJoinSession* Action{ NewObject<UAsyncJoinSession>() };
+	Action->ResultIndex = ResultIndex;
+	Action->bTravel = bTravel;
+	Action->InitSubsystem(WorldContextObject);
+	return Action;
+}
+
+void UAsyncJoinSession::Activate()
+{
+	if (!MultiplayerSessionsSubsystem.IsValid())
+	{
+		OnFailure.Broadcast();
+		SetReadyToDestroy();
+		return;
+	}
+
+	MultiplayerSessionsSubsystem->JoinAnySessionAsync(TArray<int32>{ ResultIndex }, &Handle).Next([WeakThis = TWeakObjectPtr<UAsyncJoinSession>(this)](const FMultiplayerJoinSessionResult& Result)
+	{
+		if(!WeakThis.IsValid())
+			return;
+
+		bool bWasSuccessfull{ Result.WasSuccessfull() };
+		if (bWasSuccessfull && WeakThis->bTravel)
+		{
+			UGameInstance* GameInstance{ WeakThis->MultiplayerSessionsSubsystem.IsValid() ? WeakThis->MultiplayerSessionsSubsystem->GetGameInstance() : nullptr };
+			bWasSuccessfull = GameInstance && WeakThis->MultiplayerSessionsSubsystem->TravelToSession(GameInstance->GetFirstLocalPlayerController());
+		}
+
+		if (bWasSuccessfull)
+		{
+			WeakThis->OnSuccess.Broadcast();
+		}
+		else
+		{
+			WeakThis->OnFailure.Broadcast();
+		}
+
+		WeakThis->SetReadyToDestroy();
+	});
+}
+
+UAsyncDestroySession* UAsyncDestroySession::DestroySession(UObject* WorldContextObject)
+{
+	UAsyncDestroySession* Action{ NewObject<UAsyncDestroySession>() };
+	Action->InitSubsystem(WorldContextObject);
+	return Action;
+}
+
+void UAsyncDestroySession::Activate()
+{
+	if (!MultiplayerSessionsSubsystem.IsValid())
+	{
+		OnFailure.Broadcast();
+		SetReadyToDestroy();
+		return;
+	}
+
+	MultiplayerSessionsSubsystem->DestroySessionAsync(&Handle).Next([WeakThis = TWeakObjectPtr<UAsyncDestroySession>(this)](const FMultiplayerSessionResult& Result)
+	{
+		if(!WeakThis.IsValid())
+			return;
+
+		if (Result.bWasSuccessfull)
+		{
+			WeakThis->OnSuccess.Broadcast();
+		}
+		else
+		{
+			WeakThis->OnFailure.Broadcast();
+		}
+
+		WeakThis->SetReadyToDestroy();
+	});
+}
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsAttributes.h"
+
+const FName& MultiplayerSessionAttributes::GetKey(EMultiplayerSessionAttribute Attribute)
+{
+	static const FName Keys[]
+	{
+#define MULTIPLAYER_SESSION_ATTRIBUTE_KEY(ValueType, Name, Advertisement, Comparison, Default) FName(TEXT(#Name)),
+		MULTIPLAYER_SESSION_ATTRIBUTES(MULTIPLAYER_SESSION_ATTRIBUTE_KEY)
+#undef MULTIPLAYER_SESSION_ATTRIBUTE_KEY
+	};
+	static_assert(UE_ARRAY_COUNT(Keys) == static_cast<int32>(EMultiplayerSessionAttribute::Num), "Every attribute needs a key");
+
+	return Keys[static_cast<int32>(Attribute)];
+}
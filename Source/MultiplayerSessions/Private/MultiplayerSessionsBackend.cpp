@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsBackend.h"
+#include "OnlineSessionSettings.h"
+#include "Online/OnlineSessionNames.h"
+
+FMultiplayerSessionsOnlineBackend::FMultiplayerSessionsOnlineBackend(IOnlineSessionPtr InSessionInterface, FName InSubsystemName):
+	SessionInterface{ InSessionInterface },
+	SubsystemName{ InSubsystemName }
+{
+	if(!SessionInterface.IsValid())
+		return;
+
+	CreateSessionCompleteDelegate_Handle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateRaw(this, &FMultiplayerSessionsOnlineBackend::TriggerOnCreateSessionCompleteDelegates));
+	UpdateSessionCompleteDelegate_Handle = SessionInterface->AddOnUpdateSessionCompleteDelegate_Handle(FOnUpdateSessionCompleteDelegate::CreateRaw(this, &FMultiplayerSessionsOnlineBackend::TriggerOnUpdateSessionCompleteDelegates));
+	StartSessionCompleteDelegate_Handle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateRaw(this, &FMultiplayerSessionsOnlineBackend::TriggerOnStartSessionCompleteDelegates));
+	DestroySessionCompleteDelegate_Handle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(FOnDestroySessionCompleteDelegate::CreateRaw(this, &FMultiplayerSessionsOnlineBackend::TriggerOnDestroySessionCompleteDelegates));
+	FindSessionsCompleteDelegate_Handle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateRaw(this, &FMultiplayerSessionsOnlineBackend::TriggerOnFindSessionsCompleteDelegates));
+	JoinSessionCompleteDelegate_Handle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateRaw(this, &FMultiplayerSessionsOnlineBackend::TriggerOnJoinSessionCompleteDelegates));
+}
+
+FMultiplayerSessionsOnlineBackend::~FMultiplayerSessionsOnlineBackend()
+{
+	if(!SessionInterface.IsValid())
+		return;
+
+	SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+	SessionInterface->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate_Handle);
+	SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate_Handle);
+	SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+	SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
+	SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
+}
+
+bool FMultiplayerSessionsOnlineBackend::CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	if(!SessionInterface.IsValid())
+		return false;
+
+	if(HostingPlayerId.IsValid())
+		return SessionInterface->CreateSession(*HostingPlayerId, SessionName, NewSessionSettings);
+
+	return SessionInterface->CreateSession(0, SessionName, NewSessionSettings);
+}
+
+bool FMultiplayerSessionsOnlineBackend::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData /*= true*/)
+{
+	return SessionInterface.IsValid() && SessionInterface->UpdateSession(SessionName, UpdatedSessionSettings, bShouldRefreshOnlineData);
+}
+
+bool FMultiplayerSessionsOnlineBackend::StartSession(FName SessionName)
+{
+	return SessionInterface.IsValid() && SessionInterface->StartSession(SessionName);
+}
+
+bool FMultiplayerSessionsOnlineBackend::DestroySession(FName SessionName)
+{
+	return SessionInterface.IsValid() && SessionInterface->DestroySession(SessionName);
+}
+
+bool FMultiplayerSessionsOnlineBackend::FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	if(!SessionInterface.IsValid())
+		return false;
+
+	if(SearchingPlayerId.IsValid())
+		return SessionInterface->FindSessions(*SearchingPlayerId, SearchSettings);
+
+	return SessionInterface->FindSessions(0, SearchSettings);
+}
+
+bool FMultiplayerSessionsOnlineBackend::CancelFindSessions()
+{
+	return SessionInterface.IsValid() && SessionInterface->CancelFindSessions();
+}
+
+bool FMultiplayerSessionsOnlineBackend::JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	if(!SessionInterface.IsValid())
+		return false;
+
+	if(PlayerId.IsValid())
+		return SessionInterface->JoinSession(*PlayerId, SessionName, DesiredSession);
+
+	return SessionInterface->JoinSession(0, SessionName, DesiredSession);
+}
+
+bool FMultiplayerSessionsOnlineBackend::FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId)
+{
+	//The interface wants a real user to search for
+	if(!SessionInterface.IsValid() || !SearchingPlayerId.IsValid())
+		return false;
+
+	const FUniqueNetIdPtr SessionNetId{ SessionInterface->CreateSessionIdFromString(SessionId) };
+	if(!SessionNetId.IsValid())
+		return false;
+
+	return SessionInterface->FindSessionById(*SearchingPlayerId, *SessionNetId, *SearchingPlayerId, FOnSingleSessionResultCompleteDelegate::CreateLambda(
+		[this, WeakLifetimeToken = TWeakPtr<bool>(LifetimeToken)](int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult)
+		{
+			if(!WeakLifetimeToken.IsValid())
+				return;
+
+			TriggerOnFindSessionByIdCompleteDelegates(bWasSuccessful, SearchResult);
+		}));
+}
+
+FNamedOnlineSession* FMultiplayerSessionsOnlineBackend::GetNamedSession(FName SessionName)
+{
+	return SessionInterface.IsValid() ? SessionInterface->GetNamedSession(SessionName) : nullptr;
+}
+
+bool FMultiplayerSessionsOnlineBackend::GetResolvedConnectString(FName SessionName, FString& ConnectInfo)
+{
+	return SessionInterface.IsValid() && SessionInterface->GetResolvedConnectString(SessionName, ConnectInfo);
+}
+
+bool FMultiplayerSessionsOnlineBackend::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	return SessionInterface.IsValid() && SessionInterface->GetResolvedConnectString(SearchResult, PortType, ConnectInfo);
+}
+
+bool MultiplayerSessionsBackend::MatchesQuery(const FOnlineSession& Session, const FOnlineSessionSearch& Search)
+{
+	for (const TPair<FName, FOnlineSessionSearchParam>& SearchParam : Search.QuerySettings.SearchParams)
+	{
+		//Listed apart, same as on Steam
+		if (SearchParam.Key == SEARCH_LOBBIES)
+		{
+			if(Session.SessionSettings.bIsDedicated)
+				return false;
+
+			continue;
+		}
+
+		if (SearchParam.Key == SEARCH_DEDICATED_ONLY)
+		{
+			if(!Session.SessionSettings.bIsDedicated)
+				return false;
+
+			continue;
+		}
+
+		if (SearchParam.Key == SEARCH_MINSLOTSAVAILABLE)
+		{
+			int32 MinOpenSlots{ 0 };
+			SearchParam.Value.Data.GetValue(MinOpenSlots);
+			if(Session.NumOpenPublicConnections < MinOpenSlots)
+				return false;
+
+			continue;
+		}
+
+		//Only equality is needed by the subsystem's queries
+		const FOnlineSessionSetting* Setting{ Session.SessionSettings.Settings.Find(SearchParam.Key) };
+		const bool bIsEqual{ Setting && Setting->Data == SearchParam.Value.Data };
+
+		if(SearchParam.Value.ComparisonOp == EOnlineComparisonOp::Equals && !bIsEqual)
+			return false;
+
+		if(SearchParam.Value.ComparisonOp == EOnlineComparisonOp::NotEquals && bIsEqual)
+			return false;
+	}
+
+	return true;
+}
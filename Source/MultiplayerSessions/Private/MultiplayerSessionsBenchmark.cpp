@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsBenchmark.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionsLog.h"
+#include "Containers/Ticker.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+TWeakObjectPtr<UMultiplayerSessionsBenchmark> UMultiplayerSessionsBenchmark::ActiveBenchmark;
+
+#if !UE_BUILD_SHIPPING
+namespace MultiplayerSessionsConsole
+{
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("MultiplayerSessions.Benchmark"),
+		TEXT("Runs create/find/join cycles against an in-process fake backend and reports throughput and latency. ")
+		TEXT("Cycles= Sessions= MinLatency= MaxLatency= FullSessionRate= CreateFailureRate= FindFailureRate= JoinFailureRate= Seed= Quit"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+			UMultiplayerSessionsSubsystem* Subsystem{ GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr };
+			if(!Subsystem)
+				return;
+
+			const FString Params{ FString::Join(Args, TEXT(" ")) };
+
+			FMultiplayerSessionsBenchmarkSettings Settings;
+			FMultiplayerFakeBackendSettings& BackendSettings{ Settings.BackendSettings };
+			FParse::Value(*Params, TEXT("Cycles="), Settings.NumCycles);
+			FParse::Value(*Params, TEXT("Sessions="), BackendSettings.NumSessions);
+			FParse::Value(*Params, TEXT("MinLatency="), BackendSettings.MinResponseTime);
+			FParse::Value(*Params, TEXT("MaxLatency="), BackendSettings.MaxResponseTime);
+			FParse::Value(*Params, TEXT("FullSessionRate="), BackendSettings.FullSessionRate);
+			FParse::Value(*Params, TEXT("CreateFailureRate="), BackendSettings.CreateFailureRate);
+			FParse::Value(*Params, TEXT("FindFailureRate="), BackendSettings.FindFailureRate);
+			FParse::Value(*Params, TEXT("JoinFailureRate="), BackendSettings.JoinFailureRate);
+			FParse::Value(*Params, TEXT("Seed="), BackendSettings.RandomSeed);
+			Settings.bQuitWhenDone = Args.ContainsByPredicate([](const FString& Arg) { return Arg.Equals(TEXT("Quit"), ESearchCase::IgnoreCase); });
+
+			if (!UMultiplayerSessionsBenchmark::Run(Subsystem, Settings))
+			{
+				UE_LOG(LogMultiplayerSessions, Warning, TEXT("A benchmark is already running"));
+			}
+		}));
+}
+#endif
+
+UMultiplayerSessionsBenchmark* UMultiplayerSessionsBenchmark::Run(UMultiplayerSessionsSubsystem* InSubsystem, const FMultiplayerSessionsBenchmarkSettings& InSettings)
+{
+	if(!InSubsystem || ActiveBenchmark.IsValid())
+		return nullptr;
+
+	UMultiplayerSessionsBenchmark* Benchmark{ NewObject<UMultiplayerSessionsBenchmark>(InSubsystem) };
+	Benchmark->Start(InSubsystem, InSettings);
+	return Benchmark;
+}
+
+void UMultiplayerSessionsBenchmark::Start(UMultiplayerSessionsSubsystem* InSubsystem, const FMultiplayerSessionsBenchmarkSettings& InSettings)
+{
+	Subsystem = InSubsystem;
+	Settings = InSettings;
+	NumCompletedCycles = 0;
+	NumFailedSteps = 0;
+	NumSearchResults = 0;
+	NumScoringPasses = 0;
+	ScoringSeconds = 0.0;
+
+	ActiveBenchmark = this;
+	AddToRoot();
+
+	Subsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &ThisClass::OnCreateSession);
+	Subsystem->MultiplayerOnStartSessionComplete.AddDynamic(this, &ThisClass::OnStartSession);
+	Subsystem->MultiplayerOnDestroySessionComplete.AddDynamic(this, &ThisClass::OnDestroySession);
+	Subsystem->MultiplayerOnFindSessionComplete.AddUObject(this, &ThisClass::OnFindSessions);
+	Subsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &ThisClass::OnJoinSession);
+
+	PreviousBackend = Subsystem->GetSessionBackend();
+	Subsystem->SetSessionBackend(MakeShared<FMultiplayerSessionsFakeBackend>(Settings.BackendSettings));
+	Subsystem->ResetLatencyTracker();
+	bPreviousReconnectRecordEnabled = Subsystem->IsReconnectRecordEnabled();
+	Subsystem->SetReconnectRecordEnabled(false);
+
+	UE_LOG(LogMultiplayerSessions, Display, TEXT("Benchmark started, %d cycles against %d fake sessions"), Settings.NumCycles, Settings.BackendSettings.NumSessions);
+
+	StartTime = FPlatformTime::Seconds();
+	RunStep(Settings.NumCycles > 0 ? EStep::Create : EStep::Done);
+}
+
+void UMultiplayerSessionsBenchmark::OnCreateSession(bool bWasSuccessfull)
+{
+	if(Step != EStep::Create)
+		return;
+
+	//Nothing to start or tear down if hosting failed
+	CompleteStep(bWasSuccessfull, EStep::Start, EStep::Find);
+}
+
+void UMultiplayerSessionsBenchmark::OnStartSession(bool bWasSuccessfull)
+{
+	if(Step != EStep::Start)
+		return;
+
+	CompleteStep(bWasSuccessfull, EStep::StopHosting, EStep::StopHosting);
+}
+
+void UMultiplayerSessionsBenchmark::OnDestroySession(bool bWasSuccessfull)
+{
+	if (Step == EStep::StopHosting)
+	{
+		CompleteStep(bWasSuccessfull, EStep::Find, EStep::Find);
+	}
+	else if (Step == EStep::Leave)
+	{
+		CompleteStep(bWasSuccessfull, EStep::Create, EStep::Create);
+	}
+}
+
+void UMultiplayerSessionsBenchmark::OnFindSessions(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull)
+{
+	if(Step != EStep::Find)
+		return;
+
+	NumSearchResults += SearchResults.Num();
+
+	if (bWasSuccessfull)
+	{
+		FMultiplayerScoringQuery Query;
+		Query.MatchType = Settings.MatchType;
+
+		const double ScoringStartTime{ FPlatformTime::Seconds() };
+		Subsystem->ScoreSessions(Query, Settings.NumJoinCandidates);
+		ScoringSeconds += FPlatformTime::Seconds() - ScoringStartTime;
+		++NumScoringPasses;
+	}
+
+	CompleteStep(bWasSuccessfull, EStep::Join, EStep::Create);
+}
+
+void UMultiplayerSessionsBenchmark::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	if(Step != EStep::Join)
+		return;
+
+	CompleteStep(Result == EOnJoinSessionCompleteResult::Success, EStep::Leave, EStep::Create);
+}
+
+void UMultiplayerSessionsBenchmark::RunStep(EStep NextStep)
+{
+	Step = NextStep;
+
+	switch (Step)
+	{
+	case EStep::Create:
+	{
+		FMultiplayerMatchSettings MatchSettings;
+		MatchSettings.PublicConnections = Settings.BackendSettings.MaxPublicConnections;
+		MatchSettings.MatchType = Settings.MatchType;
+		MatchSettings.MatchName = TEXT("Benchmark");
+		Subsystem->CreateSession(MatchSettings);
+		break;
+	}
+	case EStep::Start:
+		Subsystem->StartSession();
+		break;
+	case EStep::StopHosting:
+	case EStep::Leave:
+		Subsystem->DestroySession();
+		break;
+	case EStep::Find:
+	{
+		FMultiplayerSearchSettings SearchSettings;
+		SearchSettings.MaxSearchResults = Settings.MaxSearchResults;
+		SearchSettings.BatchSize = Settings.SearchBatchSize;
+		SearchSettings.MatchType = Settings.MatchType;
+		SearchSettings.MinOpenSlots = 1;
+		Subsystem->FindSessions(SearchSettings);
+		break;
+	}
+	case EStep::Join:
+	{
+		const TConstArrayView<int32> MatchingResults{ Subsystem->FindSearchResultsByMatchType(Settings.MatchType) };
+		const int32 NumCandidates{ FMath::Min(MatchingResults.Num(), Settings.NumJoinCandidates) };
+		Subsystem->JoinAnySession(TArray<int32>(MatchingResults.GetData(), NumCandidates));
+		break;
+	}
+	default:
+		//Step callbacks fire from inside the subsystem, give it the backend back once it is done with them
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float DeltaTime)
+		{
+			Finish();
+			return false;
+		}));
+		break;
+	}
+}
+
+void UMultiplayerSessionsBenchmark::CompleteStep(bool bWasSuccessfull, EStep NextStep, EStep NextStepOnFailure)
+{
+	if (!bWasSuccessfull)
+	{
+		++NumFailedSteps;
+	}
+
+	const EStep Next{ bWasSuccessfull ? NextStep : NextStepOnFailure };
+	if (Next == EStep::Create && ++NumCompletedCycles >= Settings.NumCycles)
+	{
+		RunStep(EStep::Done);
+		return;
+	}
+
+	RunStep(Next);
+}
+
+void UMultiplayerSessionsBenchmark::Finish()
+{
+	Report();
+
+	Subsystem->MultiplayerOnCreateSessionComplete.RemoveDynamic(this, &ThisClass::OnCreateSession);
+	Subsystem->MultiplayerOnStartSessionComplete.RemoveDynamic(this, &ThisClass::OnStartSession);
+	Subsystem->MultiplayerOnDestroySessionComplete.RemoveDynamic(this, &ThisClass::OnDestroySession);
+	Subsystem->MultiplayerOnFindSessionComplete.RemoveAll(this);
+	Subsystem->MultiplayerOnJoinSessionComplete.RemoveAll(this);
+
+	Subsystem->SetSessionBackend(PreviousBackend);
+	PreviousBackend.Reset();
+	Subsystem->SetReconnectRecordEnabled(bPreviousReconnectRecordEnabled);
+
+	RemoveFromRoot();
+	ActiveBenchmark.Reset();
+
+	if (Settings.bQuitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, NumFailedSteps > 0 ? 1 : 0);
+	}
+}
+
+void UMultiplayerSessionsBenchmark::Report() const
+{
+	const double ElapsedSeconds{ FMath::Max(FPlatformTime::Seconds() - StartTime, UE_DOUBLE_SMALL_NUMBER) };
+	const FMultiplayerSessionsLatencyTracker& LatencyTracker{ Subsystem->GetLatencyTracker() };
+
+	UE_LOG(LogMultiplayerSessions, Display, TEXT("Benchmark finished %d cycles in %.2f s (%.1f cycles/s), %d failed steps, %d search results"),
+		NumCompletedCycles, ElapsedSeconds, NumCompletedCycles / ElapsedSeconds, NumFailedSteps, NumSearchResults);
+
+	for (int32 OperationIndex{ 0 }; OperationIndex < static_cast<int32>(EMultiplayerSessionOperation::Travel); ++OperationIndex)
+	{
+		const EMultiplayerSessionOperation Type{ static_cast<EMultiplayerSessionOperation>(OperationIndex) };
+		const FMultiplayerSessionsLatencyTracker::FOperationStats Stats{ LatencyTracker.GetStats(Type) };
+		const int32 NumOperations{ Stats.NumSucceeded + Stats.NumFailed };
+
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("%-8s %6d ops %8.1f ops/s  p50 %7.2f ms  p95 %7.2f ms  p99 %7.2f ms  max %7.2f ms  %d failed"),
+			FMultiplayerSessionsLatencyTracker::GetOperationName(Type), NumOperations, NumOperations / ElapsedSeconds,
+			Stats.P50Ms, Stats.P95Ms, Stats.P99Ms, Stats.MaxMs, Stats.NumFailed);
+	}
+
+	if (NumScoringPasses > 0)
+	{
+		UE_LOG(LogMultiplayerSessions, Display, TEXT("Scoring  %6d passes over %d results on average, %.3f ms each"),
+			NumScoringPasses, NumSearchResults / NumScoringPasses, ScoringSeconds * 1000.0 / NumScoringPasses);
+	}
+
+	//Kept next to the latency dumps so CI can pick both up as artifacts
+	const FString FilePath{ FPaths::ProfilingDir() / TEXT("MultiplayerSessions") / FString::Printf(TEXT("Benchmark-%s.csv"), *FDateTime::Now().ToString()) };
+	FFileHelper::SaveStringToFile(LatencyTracker.ToCsv(), *FilePath);
+}
@@ -0,0 +1,384 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsFakeBackend.h"
+#include "Algo/BinarySearch.h"
+#include "MultiplayerSessionsAttributes.h"
+#include "OnlineSubsystemTypes.h"
+
+const FName FMultiplayerSessionsFakeBackend::BackendName{ TEXT("Fake") };
+
+namespace MultiplayerSessionsFakeBackend
+{
+	class FFakeSessionInfo : public FOnlineSessionInfo
+	{
+	public:
+		FFakeSessionInfo(const FString& InSessionId, const FString& InHostAddress):
+			SessionId{ FUniqueNetIdString::Create(InSessionId, FMultiplayerSessionsFakeBackend::BackendName) },
+			HostAddress{ InHostAddress }
+		{
+		}
+
+		virtual const uint8* GetBytes() const override { return nullptr; }
+		virtual int32 GetSize() const override { return sizeof(FFakeSessionInfo); }
+		virtual bool IsValid() const override { return true; }
+		virtual const FUniqueNetId& GetSessionId() const override { return *SessionId; }
+		virtual FString ToString() const override { return SessionId->ToString(); }
+		virtual FString ToDebugString() const override { return FString::Printf(TEXT("SessionId: %s Host: %s"), *SessionId->ToString(), *HostAddress); }
+
+		const FString& GetHostAddress() const { return HostAddress; }
+
+	private:
+		FUniqueNetIdRef SessionId;
+		FString HostAddress;
+	};
+
+	bool GetHostAddress(const FOnlineSession& Session, FString& OutAddress)
+	{
+		//Every session this backend hands out carries our own session info
+		if(!Session.SessionInfo.IsValid())
+			return false;
+
+		OutAddress = StaticCastSharedPtr<const FFakeSessionInfo>(Session.SessionInfo)->GetHostAddress();
+		return true;
+	}
+}
+
+FMultiplayerSessionsFakeBackend::FMultiplayerSessionsFakeBackend(const FMultiplayerFakeBackendSettings& InSettings /*= FMultiplayerFakeBackendSettings()*/)
+{
+	Reset(InSettings);
+
+	Ticker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsFakeBackend::Tick));
+}
+
+FMultiplayerSessionsFakeBackend::~FMultiplayerSessionsFakeBackend()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(Ticker_Handle);
+}
+
+bool FMultiplayerSessionsFakeBackend::CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	if(NamedSessions.Contains(SessionName))
+		return false;
+
+	TUniquePtr<FNamedOnlineSession> NamedSession{ MakeUnique<FNamedOnlineSession>(SessionName, NewSessionSettings) };
+	NamedSession->SessionState = EOnlineSessionState::Creating;
+	NamedSession->bHosting = true;
+	NamedSession->OwningUserId = HostingPlayerId;
+	NamedSession->NumOpenPublicConnections = NewSessionSettings.NumPublicConnections;
+	NamedSession->SessionInfo = MakeShared<MultiplayerSessionsFakeBackend::FFakeSessionInfo>(FString::Printf(TEXT("Local_%s"), *SessionName.ToString()), TEXT("127.0.0.1:7777"));
+	NamedSessions.Add(SessionName, MoveTemp(NamedSession));
+
+	const bool bFails{ RollFailure(Settings.CreateFailureRate) };
+	Defer([this, SessionName, bFails]()
+	{
+		FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+		if (!NamedSession || bFails)
+		{
+			NamedSessions.Remove(SessionName);
+			TriggerOnCreateSessionCompleteDelegates(SessionName, false);
+			return;
+		}
+
+		NamedSession->SessionState = EOnlineSessionState::Pending;
+		TriggerOnCreateSessionCompleteDelegates(SessionName, true);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData /*= true*/)
+{
+	if(!GetNamedSession(SessionName))
+		return false;
+
+	const FOnlineSessionSettings SessionSettings{ UpdatedSessionSettings };
+	Defer([this, SessionName, SessionSettings]()
+	{
+		FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+		if (NamedSession)
+		{
+			//Players already in keep their slots
+			const int32 NumTakenSlots{ NamedSession->SessionSettings.NumPublicConnections - NamedSession->NumOpenPublicConnections };
+			NamedSession->SessionSettings = SessionSettings;
+			NamedSession->NumOpenPublicConnections = FMath::Max(0, SessionSettings.NumPublicConnections - NumTakenSlots);
+		}
+
+		TriggerOnUpdateSessionCompleteDelegates(SessionName, NamedSession != nullptr);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::StartSession(FName SessionName)
+{
+	FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	if (!NamedSession || (NamedSession->SessionState != EOnlineSessionState::Pending && NamedSession->SessionState != EOnlineSessionState::Ended))
+		return false;
+
+	NamedSession->SessionState = EOnlineSessionState::Starting;
+
+	Defer([this, SessionName]()
+	{
+		FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+		if (NamedSession)
+		{
+			NamedSession->SessionState = EOnlineSessionState::InProgress;
+		}
+
+		TriggerOnStartSessionCompleteDelegates(SessionName, NamedSession != nullptr);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::DestroySession(FName SessionName)
+{
+	FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	if (!NamedSession || NamedSession->SessionState == EOnlineSessionState::Destroying)
+		return false;
+
+	NamedSession->SessionState = EOnlineSessionState::Destroying;
+
+	Defer([this, SessionName]()
+	{
+		NamedSessions.Remove(SessionName);
+		TriggerOnDestroySessionCompleteDelegates(SessionName, true);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	if(ActiveSearch.IsValid())
+		return false;
+
+	ActiveSearch = SearchSettings;
+	ActiveSearch->SearchResults.Reset();
+	ActiveSearch->SearchState = EOnlineAsyncTaskState::InProgress;
+	NextSearchCandidate = 0;
+	SearchDueTime = FPlatformTime::Seconds() + GetResponseTime();
+	bSearchFails = RollFailure(Settings.FindFailureRate);
+
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::CancelFindSessions()
+{
+	if(!ActiveSearch.IsValid())
+		return false;
+
+	ActiveSearch->SearchState = EOnlineAsyncTaskState::Failed;
+	ActiveSearch.Reset();
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	const FString SessionId{ DesiredSession.GetSessionIdStr() };
+
+	Defer([this, SessionName, SessionId]()
+	{
+		if (NamedSessions.Contains(SessionName))
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::AlreadyInSession);
+			return;
+		}
+
+		const int32* HostedSessionIndex{ HostedSessionIndices.Find(SessionId) };
+		if (!HostedSessionIndex)
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::SessionDoesNotExist);
+			return;
+		}
+
+		FOnlineSession& HostedSession{ HostedSessions[*HostedSessionIndex] };
+		if (HostedSession.NumOpenPublicConnections <= 0)
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::SessionIsFull);
+			return;
+		}
+
+		if (RollFailure(Settings.JoinFailureRate))
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::CouldNotRetrieveAddress);
+			return;
+		}
+
+		--HostedSession.NumOpenPublicConnections;
+
+		TUniquePtr<FNamedOnlineSession> NamedSession{ MakeUnique<FNamedOnlineSession>(SessionName, HostedSession) };
+		NamedSession->SessionState = EOnlineSessionState::Pending;
+		NamedSessions.Add(SessionName, MoveTemp(NamedSession));
+
+		TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::Success);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsFakeBackend::FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId)
+{
+	Defer([this, SessionId]()
+	{
+		FOnlineSessionSearchResult SearchResult;
+
+		const int32* HostedSessionIndex{ HostedSessionIndices.Find(SessionId) };
+		if (!HostedSessionIndex)
+		{
+			TriggerOnFindSessionByIdCompleteDelegates(false, SearchResult);
+			return;
+		}
+
+		SearchResult.Session = HostedSessions[*HostedSessionIndex];
+		SearchResult.PingInMs = HostedSessionPings[*HostedSessionIndex];
+		TriggerOnFindSessionByIdCompleteDelegates(true, SearchResult);
+	});
+
+	return true;
+}
+
+FNamedOnlineSession* FMultiplayerSessionsFakeBackend::GetNamedSession(FName SessionName)
+{
+	TUniquePtr<FNamedOnlineSession>* NamedSession{ NamedSessions.Find(SessionName) };
+	return NamedSession ? NamedSession->Get() : nullptr;
+}
+
+bool FMultiplayerSessionsFakeBackend::GetResolvedConnectString(FName SessionName, FString& ConnectInfo)
+{
+	const FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	return NamedSession && MultiplayerSessionsFakeBackend::GetHostAddress(*NamedSession, ConnectInfo);
+}
+
+bool FMultiplayerSessionsFakeBackend::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	return MultiplayerSessionsFakeBackend::GetHostAddress(SearchResult.Session, ConnectInfo);
+}
+
+void FMultiplayerSessionsFakeBackend::Reset(const FMultiplayerFakeBackendSettings& InSettings)
+{
+	Settings = InSettings;
+	RandomStream.Initialize(Settings.RandomSeed);
+
+	PendingRequests.Reset();
+	CancelFindSessions();
+	NamedSessions.Reset();
+
+	BuildHostedSessions();
+}
+
+bool FMultiplayerSessionsFakeBackend::Tick(float DeltaTime)
+{
+	const double Now{ FPlatformTime::Seconds() };
+
+	TickSearch(Now);
+
+	//Requests made from a completion are due in a later tick
+	while (!PendingRequests.IsEmpty() && PendingRequests[0].DueTime <= Now)
+	{
+		TFunction<void()> Complete{ MoveTemp(PendingRequests[0].Complete) };
+		PendingRequests.RemoveAt(0);
+		Complete();
+	}
+
+	return true;
+}
+
+void FMultiplayerSessionsFakeBackend::TickSearch(double Now)
+{
+	if(!ActiveSearch.IsValid())
+		return;
+
+	TArray<FOnlineSessionSearchResult>& SearchResults{ ActiveSearch->SearchResults };
+
+	int32 NumAdded{ 0 };
+	while (!bSearchFails && NumAdded < Settings.ResultsPerTick && NextSearchCandidate < HostedSessions.Num() && SearchResults.Num() < ActiveSearch->MaxSearchResults)
+	{
+		const int32 CandidateIndex{ NextSearchCandidate++ };
+		if(!MultiplayerSessionsBackend::MatchesQuery(HostedSessions[CandidateIndex], *ActiveSearch))
+			continue;
+
+		FOnlineSessionSearchResult& SearchResult{ SearchResults.AddDefaulted_GetRef() };
+		SearchResult.Session = HostedSessions[CandidateIndex];
+		SearchResult.PingInMs = HostedSessionPings[CandidateIndex];
+		++NumAdded;
+	}
+
+	const bool bListExhausted{ bSearchFails || NextSearchCandidate >= HostedSessions.Num() || SearchResults.Num() >= ActiveSearch->MaxSearchResults };
+	if (bListExhausted && Now >= SearchDueTime)
+	{
+		CompleteSearch(!bSearchFails);
+	}
+}
+
+void FMultiplayerSessionsFakeBackend::CompleteSearch(bool bWasSuccessfull)
+{
+	ActiveSearch->SearchState = bWasSuccessfull ? EOnlineAsyncTaskState::Done : EOnlineAsyncTaskState::Failed;
+	ActiveSearch.Reset();
+
+	TriggerOnFindSessionsCompleteDelegates(bWasSuccessfull);
+}
+
+void FMultiplayerSessionsFakeBackend::Defer(TFunction<void()>&& Complete)
+{
+	FPendingRequest Request;
+	Request.DueTime = FPlatformTime::Seconds() + GetResponseTime();
+	Request.Complete = MoveTemp(Complete);
+
+	//Kept sorted by due time so completions come out in order
+	const int32 InsertIndex{ Algo::UpperBoundBy(PendingRequests, Request.DueTime, &FPendingRequest::DueTime) };
+	PendingRequests.Insert(MoveTemp(Request), InsertIndex);
+}
+
+double FMultiplayerSessionsFakeBackend::GetResponseTime()
+{
+	return RandomStream.FRandRange(Settings.MinResponseTime, FMath::Max(Settings.MinResponseTime, Settings.MaxResponseTime));
+}
+
+bool FMultiplayerSessionsFakeBackend::RollFailure(float FailureRate)
+{
+	return FailureRate > 0.f && RandomStream.FRand() < FailureRate;
+}
+
+void FMultiplayerSessionsFakeBackend::BuildHostedSessions()
+{
+	HostedSessions.Reset(Settings.NumSessions);
+	HostedSessionPings.Reset(Settings.NumSessions);
+	HostedSessionIndices.Reset();
+
+	for (int32 SessionIndex{ 0 }; SessionIndex < Settings.NumSessions; ++SessionIndex)
+	{
+		const FString SessionId{ FString::Printf(TEXT("Fake_%d"), SessionIndex) };
+		const FString HostAddress{ FString::Printf(TEXT("10.%d.%d.%d:7777"), (SessionIndex >> 16) & 0xFF, (SessionIndex >> 8) & 0xFF, SessionIndex & 0xFF) };
+		const FString MatchType{ Settings.MatchTypes.IsEmpty() ? FString() : Settings.MatchTypes[SessionIndex % Settings.MatchTypes.Num()] };
+
+		FOnlineSession& Session{ HostedSessions.AddDefaulted_GetRef() };
+		Session.OwningUserId = FUniqueNetIdString::Create(FString::Printf(TEXT("FakeHost_%d"), SessionIndex), BackendName);
+		Session.OwningUserName = FString::Printf(TEXT("FakeHost_%d"), SessionIndex);
+		Session.SessionInfo = MakeShared<MultiplayerSessionsFakeBackend::FFakeSessionInfo>(SessionId, HostAddress);
+		Session.SessionSettings.NumPublicConnections = Settings.MaxPublicConnections;
+		Session.SessionSettings.bShouldAdvertise = true;
+		Session.SessionSettings.bUsesPresence = true;
+		Session.SessionSettings.bUseLobbiesIfAvailable = true;
+		Session.SessionSettings.bAllowJoinInProgress = true;
+		Session.SessionSettings.BuildUniqueId = Settings.BuildId;
+		MultiplayerSessionAttributes::MatchType.Write(Session.SessionSettings, MatchType);
+		MultiplayerSessionAttributes::GameName.WriteDefault(Session.SessionSettings);
+		MultiplayerSessionAttributes::BuildId.Write(Session.SessionSettings, Settings.BuildId);
+
+		const bool bIsFull{ RandomStream.FRand() < Settings.FullSessionRate };
+		Session.NumOpenPublicConnections = bIsFull ? 0 : RandomStream.RandRange(1, FMath::Max(1, Settings.MaxPublicConnections));
+
+		//Rolled only when asked for, so the same seed still builds the same sessions without dedicated servers
+		if (RollFailure(Settings.DedicatedServerRate))
+		{
+			Session.SessionSettings.bIsDedicated = true;
+			Session.SessionSettings.bUsesPresence = false;
+			Session.SessionSettings.bUseLobbiesIfAvailable = false;
+		}
+
+		HostedSessionPings.Add(RandomStream.RandRange(10, 150));
+		HostedSessionIndices.Add(SessionId, SessionIndex);
+	}
+}
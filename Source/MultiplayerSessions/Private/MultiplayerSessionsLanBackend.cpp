@@ -0,0 +1,456 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsLanBackend.h"
+#include "MultiplayerSessionsLog.h"
+#include "OnlineSubsystemTypes.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+const FName FMultiplayerSessionsLanBackend::BackendName{ TEXT("Lan") };
+
+namespace MultiplayerSessionsLanBackend
+{
+	class FLanSessionInfo : public FOnlineSessionInfo
+	{
+	public:
+		FLanSessionInfo(const FString& InSessionId, const FString& InHostAddress):
+			SessionId{ FUniqueNetIdString::Create(InSessionId, FMultiplayerSessionsLanBackend::BackendName) },
+			HostAddress{ InHostAddress }
+		{
+		}
+
+		virtual const uint8* GetBytes() const override { return nullptr; }
+		virtual int32 GetSize() const override { return sizeof(FLanSessionInfo); }
+		virtual bool IsValid() const override { return true; }
+		virtual const FUniqueNetId& GetSessionId() const override { return *SessionId; }
+		virtual FString ToString() const override { return SessionId->ToString(); }
+		virtual FString ToDebugString() const override { return FString::Printf(TEXT("SessionId: %s Host: %s"), *SessionId->ToString(), *HostAddress); }
+
+		const FString& GetHostAddress() const { return HostAddress; }
+
+	private:
+		FUniqueNetIdRef SessionId;
+		FString HostAddress;
+	};
+
+	bool GetHostAddress(const FOnlineSession& Session, FString& OutAddress)
+	{
+		//Every session this backend hands out carries our own session info
+		if(!Session.SessionInfo.IsValid())
+			return false;
+
+		OutAddress = StaticCastSharedPtr<const FLanSessionInfo>(Session.SessionInfo)->GetHostAddress();
+		return true;
+	}
+}
+
+FMultiplayerSessionsLanBackend::FMultiplayerSessionsLanBackend(const FMultiplayerLanDiscoverySettings& InSettings /*= FMultiplayerLanDiscoverySettings()*/):
+	Settings{ InSettings }
+{
+	Ticker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsLanBackend::Tick));
+}
+
+FMultiplayerSessionsLanBackend::~FMultiplayerSessionsLanBackend()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(Ticker_Handle);
+}
+
+bool FMultiplayerSessionsLanBackend::CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	if(NamedSessions.Contains(SessionName))
+		return false;
+
+	const FString SessionId{ FGuid::NewGuid().ToString(EGuidFormats::Digits) };
+
+	TUniquePtr<FNamedOnlineSession> NamedSession{ MakeUnique<FNamedOnlineSession>(SessionName, NewSessionSettings) };
+	NamedSession->SessionState = EOnlineSessionState::Creating;
+	NamedSession->bHosting = true;
+	NamedSession->OwningUserId = HostingPlayerId;
+	NamedSession->OwningUserName = FPlatformProcess::ComputerName();
+	NamedSession->NumOpenPublicConnections = NewSessionSettings.NumPublicConnections;
+	NamedSession->SessionInfo = MakeShared<MultiplayerSessionsLanBackend::FLanSessionInfo>(SessionId, FString::Printf(TEXT("127.0.0.1:%d"), GetGamePort()));
+	NamedSessions.Add(SessionName, MoveTemp(NamedSession));
+
+	Defer([this, SessionName]()
+	{
+		FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+		if (!NamedSession)
+		{
+			TriggerOnCreateSessionCompleteDelegates(SessionName, false);
+			return;
+		}
+
+		NamedSession->SessionState = EOnlineSessionState::Pending;
+		UpdateBeacon();
+		TriggerOnCreateSessionCompleteDelegates(SessionName, true);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData /*= true*/)
+{
+	FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	if(!NamedSession)
+		return false;
+
+	//Nothing tells this backend who joined, the admission's OpenSlots attribute advertises the real count
+	const int32 NumTakenSlots{ NamedSession->SessionSettings.NumPublicConnections - NamedSession->NumOpenPublicConnections };
+	NamedSession->SessionSettings = UpdatedSessionSettings;
+	NamedSession->NumOpenPublicConnections = FMath::Max(0, UpdatedSessionSettings.NumPublicConnections - NumTakenSlots);
+	UpdateBeacon();
+
+	Defer([this, SessionName]()
+	{
+		TriggerOnUpdateSessionCompleteDelegates(SessionName, GetNamedSession(SessionName) != nullptr);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::StartSession(FName SessionName)
+{
+	FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	if (!NamedSession || (NamedSession->SessionState != EOnlineSessionState::Pending && NamedSession->SessionState != EOnlineSessionState::Ended))
+		return false;
+
+	NamedSession->SessionState = EOnlineSessionState::Starting;
+
+	Defer([this, SessionName]()
+	{
+		FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+		if (NamedSession)
+		{
+			NamedSession->SessionState = EOnlineSessionState::InProgress;
+		}
+
+		TriggerOnStartSessionCompleteDelegates(SessionName, NamedSession != nullptr);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::DestroySession(FName SessionName)
+{
+	FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	if (!NamedSession || NamedSession->SessionState == EOnlineSessionState::Destroying)
+		return false;
+
+	NamedSession->SessionState = EOnlineSessionState::Destroying;
+	UpdateBeacon();
+
+	Defer([this, SessionName]()
+	{
+		NamedSessions.Remove(SessionName);
+		TriggerOnDestroySessionCompleteDelegates(SessionName, true);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	if(ActiveSearch.IsValid())
+		return false;
+
+	ActiveSearch = SearchSettings;
+	ActiveSearch->SearchResults.Reset();
+	ActiveSearch->SearchState = EOnlineAsyncTaskState::InProgress;
+	ActiveSearchSessionIds.Reset();
+	SearchStartTime = FPlatformTime::Seconds();
+
+	if (!UpdateDiscovery())
+	{
+		ActiveSearch->SearchState = EOnlineAsyncTaskState::Failed;
+		ActiveSearch.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::CancelFindSessions()
+{
+	if(!ActiveSearch.IsValid())
+		return false;
+
+	ActiveSearch->SearchState = EOnlineAsyncTaskState::Failed;
+	ActiveSearch.Reset();
+	UpdateDiscovery();
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	const FOnlineSession Session{ DesiredSession.Session };
+
+	Defer([this, SessionName, Session]()
+	{
+		if (NamedSessions.Contains(SessionName))
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::AlreadyInSession);
+			return;
+		}
+
+		FString HostAddress;
+		if (!MultiplayerSessionsLanBackend::GetHostAddress(Session, HostAddress))
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::CouldNotRetrieveAddress);
+			return;
+		}
+
+		//The host turns players away itself once it is full, this only goes by what it advertised last
+		if (Session.NumOpenPublicConnections <= 0)
+		{
+			TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::SessionIsFull);
+			return;
+		}
+
+		TUniquePtr<FNamedOnlineSession> NamedSession{ MakeUnique<FNamedOnlineSession>(SessionName, Session) };
+		NamedSession->SessionState = EOnlineSessionState::Pending;
+		NamedSessions.Add(SessionName, MoveTemp(NamedSession));
+
+		TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::Success);
+	});
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanBackend::FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId)
+{
+	//Already known while listening, otherwise it is asked for until the host answers or the response timeout passes
+	if (const FMultiplayerLanHost* Host{ Discovery.FindHost(SessionId) })
+	{
+		const FOnlineSessionSearchResult SearchResult{ MakeSearchResult(*Host) };
+		Defer([this, SearchResult]()
+		{
+			TriggerOnFindSessionByIdCompleteDelegates(true, SearchResult);
+		});
+
+		return true;
+	}
+
+	PendingLookups.Add(FPendingLookup{ SessionId, FPlatformTime::Seconds() + Settings.ResponseTimeout });
+	if (!UpdateDiscovery())
+	{
+		PendingLookups.Pop();
+		return false;
+	}
+
+	return true;
+}
+
+FNamedOnlineSession* FMultiplayerSessionsLanBackend::GetNamedSession(FName SessionName)
+{
+	TUniquePtr<FNamedOnlineSession>* NamedSession{ NamedSessions.Find(SessionName) };
+	return NamedSession ? NamedSession->Get() : nullptr;
+}
+
+bool FMultiplayerSessionsLanBackend::GetResolvedConnectString(FName SessionName, FString& ConnectInfo)
+{
+	const FNamedOnlineSession* NamedSession{ GetNamedSession(SessionName) };
+	return NamedSession && MultiplayerSessionsLanBackend::GetHostAddress(*NamedSession, ConnectInfo);
+}
+
+bool FMultiplayerSessionsLanBackend::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	return MultiplayerSessionsLanBackend::GetHostAddress(SearchResult.Session, ConnectInfo);
+}
+
+bool FMultiplayerSessionsLanBackend::StartListening()
+{
+	if(bIsListening)
+		return true;
+
+	bIsListening = true;
+	ListenStartTime = FPlatformTime::Seconds();
+
+	if (!UpdateDiscovery())
+	{
+		bIsListening = false;
+		return false;
+	}
+
+	return true;
+}
+
+void FMultiplayerSessionsLanBackend::StopListening()
+{
+	bIsListening = false;
+	UpdateDiscovery();
+}
+
+bool FMultiplayerSessionsLanBackend::Tick(float DeltaTime)
+{
+	const double Now{ FPlatformTime::Seconds() };
+
+	TickSearch(Now);
+	TickLookups(Now);
+
+	//Requests made from a completion are due in a later tick
+	TArray<TFunction<void()>> Completions{ MoveTemp(PendingCompletions) };
+	PendingCompletions.Reset();
+
+	for (TFunction<void()>& Complete : Completions)
+	{
+		Complete();
+	}
+
+	return true;
+}
+
+void FMultiplayerSessionsLanBackend::TickSearch(double Now)
+{
+	if(!ActiveSearch.IsValid())
+		return;
+
+	TArray<FOnlineSessionSearchResult>& SearchResults{ ActiveSearch->SearchResults };
+
+	//Results show up as hosts answer, so the subsystem can stream them in before the search ends
+	for (const TPair<FString, FMultiplayerLanHost>& Host : Discovery.GetHosts())
+	{
+		if(SearchResults.Num() >= ActiveSearch->MaxSearchResults)
+			break;
+
+		if(ActiveSearchSessionIds.Contains(Host.Key))
+			continue;
+
+		ActiveSearchSessionIds.Add(Host.Key);
+
+		FOnlineSessionSearchResult SearchResult{ MakeSearchResult(Host.Value) };
+		if(!MultiplayerSessionsBackend::MatchesQuery(SearchResult.Session, *ActiveSearch))
+			continue;
+
+		SearchResults.Add(MoveTemp(SearchResult));
+	}
+
+	//Listening long enough already knows everyone who would answer
+	const bool bHasListened{ bIsListening && Now - ListenStartTime >= Settings.ResponseTimeout };
+	const bool bHasEnoughResponders{ Settings.NumRespondersToComplete > 0 && SearchResults.Num() >= Settings.NumRespondersToComplete };
+	const bool bIsFull{ SearchResults.Num() >= ActiveSearch->MaxSearchResults };
+
+	if (bHasListened || bHasEnoughResponders || bIsFull || Now - SearchStartTime >= Settings.ResponseTimeout)
+	{
+		CompleteSearch(true);
+	}
+}
+
+void FMultiplayerSessionsLanBackend::TickLookups(double Now)
+{
+	if(PendingLookups.IsEmpty())
+		return;
+
+	for (int32 LookupIndex{ 0 }; LookupIndex < PendingLookups.Num();)
+	{
+		const FPendingLookup& Lookup{ PendingLookups[LookupIndex] };
+		const FMultiplayerLanHost* Host{ Discovery.FindHost(Lookup.SessionId) };
+		if (!Host && Now < Lookup.Deadline)
+		{
+			++LookupIndex;
+			continue;
+		}
+
+		const FOnlineSessionSearchResult SearchResult{ Host ? MakeSearchResult(*Host) : FOnlineSessionSearchResult() };
+		PendingLookups.RemoveAt(LookupIndex);
+		Defer([this, bWasFound = Host != nullptr, SearchResult]()
+		{
+			TriggerOnFindSessionByIdCompleteDelegates(bWasFound, SearchResult);
+		});
+	}
+
+	if (PendingLookups.IsEmpty())
+	{
+		UpdateDiscovery();
+	}
+}
+
+void FMultiplayerSessionsLanBackend::CompleteSearch(bool bWasSuccessfull)
+{
+	ActiveSearch->SearchState = bWasSuccessfull ? EOnlineAsyncTaskState::Done : EOnlineAsyncTaskState::Failed;
+	ActiveSearch.Reset();
+	ActiveSearchSessionIds.Reset();
+	UpdateDiscovery();
+
+	TriggerOnFindSessionsCompleteDelegates(bWasSuccessfull);
+}
+
+void FMultiplayerSessionsLanBackend::Defer(TFunction<void()>&& Complete)
+{
+	PendingCompletions.Add(MoveTemp(Complete));
+}
+
+bool FMultiplayerSessionsLanBackend::UpdateDiscovery()
+{
+	const bool bIsSearching{ ActiveSearch.IsValid() || !PendingLookups.IsEmpty() };
+	if (!bIsListening && !bIsSearching)
+	{
+		Discovery.Stop();
+		return true;
+	}
+
+	if (!Discovery.IsRunning() && !Discovery.Start(Settings))
+	{
+		MULTIPLAYER_LOG(Warning, TEXT("Could not open a socket for LAN discovery"));
+		return false;
+	}
+
+	Discovery.SetSearching(bIsSearching);
+	return true;
+}
+
+void FMultiplayerSessionsLanBackend::UpdateBeacon()
+{
+	TArray<const FOnlineSession*, TInlineAllocator<4>> AdvertisedSessions;
+	for (const TPair<FName, TUniquePtr<FNamedOnlineSession>>& NamedSession : NamedSessions)
+	{
+		const FNamedOnlineSession& Session{ *NamedSession.Value };
+		if(!Session.bHosting || !Session.SessionSettings.bShouldAdvertise)
+			continue;
+
+		if(Session.SessionState == EOnlineSessionState::Creating || Session.SessionState == EOnlineSessionState::Destroying)
+			continue;
+
+		AdvertisedSessions.Add(&Session);
+	}
+
+	if (AdvertisedSessions.IsEmpty())
+	{
+		Beacon.Stop();
+		return;
+	}
+
+	if (!Beacon.IsRunning())
+	{
+		if(!Beacon.Start(Settings))
+			return;
+
+		MULTIPLAYER_LOG(Log, TEXT("Answering LAN discovery on port %d"), Beacon.GetPort());
+	}
+
+	Beacon.SetSessions(AdvertisedSessions, GetGamePort());
+}
+
+int32 FMultiplayerSessionsLanBackend::GetGamePort() const
+{
+	if(Settings.GamePort > 0)
+		return Settings.GamePort;
+
+	//Same as the listen server picks, a second instance on one machine is started with its own -Port=
+	int32 GamePort{ 0 };
+	if(FParse::Value(FCommandLine::Get(), TEXT("Port="), GamePort) && GamePort > 0)
+		return GamePort;
+
+	return FURL::UrlConfig.DefaultPort;
+}
+
+FOnlineSessionSearchResult FMultiplayerSessionsLanBackend::MakeSearchResult(const FMultiplayerLanHost& Host) const
+{
+	FOnlineSessionSearchResult SearchResult;
+	SearchResult.Session = Host.Session;
+	SearchResult.Session.OwningUserId = FUniqueNetIdString::Create(FString::Printf(TEXT("LanHost_%s"), *Host.SessionId), BackendName);
+	SearchResult.Session.SessionInfo = MakeShared<MultiplayerSessionsLanBackend::FLanSessionInfo>(Host.SessionId, Host.Address);
+	SearchResult.PingInMs = Host.PingInMs;
+	return SearchResult;
+}
@@ -0,0 +1,583 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsLanDiscovery.h"
+#include "MultiplayerSessionsLog.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Misc/Crc.h"
+
+namespace MultiplayerSessionsLanDiscovery
+{
+	constexpr uint32 QueryMagic{ 0x514C534D };
+	constexpr uint32 ReplyMagic{ 0x524C534D };
+	//Bumped whenever the layout changes, hosts and clients of other versions ignore each other
+	constexpr uint8 ProtocolVersion{ 1 };
+	//Magic, version, nonce, send time
+	constexpr int32 QuerySize{ sizeof(uint32) + sizeof(uint8) + sizeof(uint32) + sizeof(double) };
+	//Fits a few sessions with all of their attributes, and well within a single UDP datagram
+	constexpr int32 MaxPacketSize{ 8192 };
+	//Garbage that made it past the magic still can't make us loop for long
+	constexpr int32 MaxSessionsPerReply{ 64 };
+	constexpr int32 MaxSettingsPerSession{ 256 };
+
+	void WriteString(FArchive& Ar, const FString& Value)
+	{
+		FTCHARToUTF8 Utf8Value(*Value);
+		int32 Length{ Utf8Value.Length() };
+		Ar << Length;
+		Ar.Serialize((void*)Utf8Value.Get(), Length);
+	}
+
+	bool ReadString(FArchive& Ar, FString& OutValue)
+	{
+		int32 Length{ 0 };
+		Ar << Length;
+		if (Ar.IsError() || Length < 0 || Length > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		TArray<UTF8CHAR, TInlineAllocator<128>> Utf8Value;
+		Utf8Value.SetNumUninitialized(Length);
+		Ar.Serialize(Utf8Value.GetData(), Length);
+
+		FUTF8ToTCHAR Value(Utf8Value.GetData(), Length);
+		OutValue = FString(Value.Length(), Value.Get());
+		return !Ar.IsError();
+	}
+
+	//Blobs and json are not advertised, nothing the plugin sets uses them
+	bool IsSerializable(const FVariantData& Data)
+	{
+		switch (Data.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+		case EOnlineKeyValuePairDataType::UInt32:
+		case EOnlineKeyValuePairDataType::Int64:
+		case EOnlineKeyValuePairDataType::UInt64:
+		case EOnlineKeyValuePairDataType::Float:
+		case EOnlineKeyValuePairDataType::Double:
+		case EOnlineKeyValuePairDataType::Bool:
+		case EOnlineKeyValuePairDataType::String:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	template<typename ValueType>
+	void WriteValue(FArchive& Ar, const FVariantData& Data)
+	{
+		ValueType Value{};
+		Data.GetValue(Value);
+		Ar << Value;
+	}
+
+	template<typename ValueType>
+	void ReadValue(FArchive& Ar, FVariantData& OutData)
+	{
+		ValueType Value{};
+		Ar << Value;
+		OutData.SetValue(Value);
+	}
+
+	void WriteData(FArchive& Ar, const FVariantData& Data)
+	{
+		uint8 Type{ static_cast<uint8>(Data.GetType()) };
+		Ar << Type;
+
+		switch (Data.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32: WriteValue<int32>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::UInt32: WriteValue<uint32>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Int64: WriteValue<int64>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::UInt64: WriteValue<uint64>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Float: WriteValue<float>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Double: WriteValue<double>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Bool:
+		{
+			bool bValue{ false };
+			Data.GetValue(bValue);
+			uint8 Value{ bValue ? uint8(1) : uint8(0) };
+			Ar << Value;
+			break;
+		}
+		case EOnlineKeyValuePairDataType::String:
+		{
+			FString Value;
+			Data.GetValue(Value);
+			WriteString(Ar, Value);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	bool ReadData(FArchive& Ar, FVariantData& OutData)
+	{
+		uint8 Type{ 0 };
+		Ar << Type;
+
+		switch (static_cast<EOnlineKeyValuePairDataType::Type>(Type))
+		{
+		case EOnlineKeyValuePairDataType::Int32: ReadValue<int32>(Ar, OutData); break;
+		case EOnlineKeyValuePairDataType::UInt32: ReadValue<uint32>(Ar, OutData); break;
+		case EOnlineKeyValuePairDataType::Int64: ReadValue<int64>(Ar, OutData); break;
+		case EOnlineKeyValuePairDataType::UInt64: ReadValue<uint64>(Ar, OutData); break;
+		case EOnlineKeyValuePairDataType::Float: ReadValue<float>(Ar, OutData); break;
+		case EOnlineKeyValuePairDataType::Double: ReadValue<double>(Ar, OutData); break;
+		case EOnlineKeyValuePairDataType::Bool:
+		{
+			uint8 Value{ 0 };
+			Ar << Value;
+			OutData.SetValue(Value != 0);
+			break;
+		}
+		case EOnlineKeyValuePairDataType::String:
+		{
+			FString Value;
+			ReadString(Ar, Value);
+			OutData.SetValue(Value);
+			break;
+		}
+		default:
+			Ar.SetError();
+			break;
+		}
+
+		return !Ar.IsError();
+	}
+
+	void WriteSession(FArchive& Ar, const FOnlineSession& Session)
+	{
+		const FOnlineSessionSettings& SessionSettings{ Session.SessionSettings };
+
+		WriteString(Ar, Session.GetSessionIdStr());
+		WriteString(Ar, Session.OwningUserName);
+
+		int32 NumPublicConnections{ SessionSettings.NumPublicConnections };
+		int32 NumOpenPublicConnections{ Session.NumOpenPublicConnections };
+		int32 BuildUniqueId{ SessionSettings.BuildUniqueId };
+		uint8 Flags{ static_cast<uint8>(
+			(SessionSettings.bIsDedicated ? 1 : 0) |
+			(SessionSettings.bAllowJoinInProgress ? 2 : 0) |
+			(SessionSettings.bUsesPresence ? 4 : 0) |
+			(SessionSettings.bUseLobbiesIfAvailable ? 8 : 0)) };
+		Ar << NumPublicConnections << NumOpenPublicConnections << BuildUniqueId << Flags;
+
+		TArray<const TPair<FName, FOnlineSessionSetting>*, TInlineAllocator<32>> AdvertisedSettings;
+		for (const TPair<FName, FOnlineSessionSetting>& Setting : SessionSettings.Settings)
+		{
+			if(Setting.Value.AdvertisementType == EOnlineDataAdvertisementType::DontAdvertise || !IsSerializable(Setting.Value.Data))
+				continue;
+
+			AdvertisedSettings.Add(&Setting);
+		}
+
+		int32 NumSettings{ FMath::Min(AdvertisedSettings.Num(), MaxSettingsPerSession) };
+		Ar << NumSettings;
+
+		for (int32 SettingIndex{ 0 }; SettingIndex < NumSettings; ++SettingIndex)
+		{
+			const TPair<FName, FOnlineSessionSetting>& Setting{ *AdvertisedSettings[SettingIndex] };
+			uint8 AdvertisementType{ static_cast<uint8>(Setting.Value.AdvertisementType) };
+
+			WriteString(Ar, Setting.Key.ToString());
+			Ar << AdvertisementType;
+			WriteData(Ar, Setting.Value.Data);
+		}
+	}
+
+	bool ReadSession(FArchive& Ar, FString& OutSessionId, FOnlineSession& OutSession)
+	{
+		FOnlineSessionSettings& SessionSettings{ OutSession.SessionSettings };
+
+		ReadString(Ar, OutSessionId);
+		ReadString(Ar, OutSession.OwningUserName);
+
+		uint8 Flags{ 0 };
+		Ar << SessionSettings.NumPublicConnections << OutSession.NumOpenPublicConnections << SessionSettings.BuildUniqueId << Flags;
+		SessionSettings.bIsDedicated = (Flags & 1) != 0;
+		SessionSettings.bAllowJoinInProgress = (Flags & 2) != 0;
+		SessionSettings.bUsesPresence = (Flags & 4) != 0;
+		SessionSettings.bUseLobbiesIfAvailable = (Flags & 8) != 0;
+		SessionSettings.bShouldAdvertise = true;
+		SessionSettings.bIsLANMatch = true;
+
+		int32 NumSettings{ 0 };
+		Ar << NumSettings;
+		if (Ar.IsError() || NumSettings < 0 || NumSettings > MaxSettingsPerSession)
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		for (int32 SettingIndex{ 0 }; SettingIndex < NumSettings && !Ar.IsError(); ++SettingIndex)
+		{
+			FString Key;
+			uint8 AdvertisementType{ 0 };
+			ReadString(Ar, Key);
+			Ar << AdvertisementType;
+
+			FOnlineSessionSetting Setting;
+			if(!ReadData(Ar, Setting.Data))
+				return false;
+
+			Setting.AdvertisementType = static_cast<EOnlineDataAdvertisementType::Type>(AdvertisementType);
+			SessionSettings.Settings.Add(FName(*Key), MoveTemp(Setting));
+		}
+
+		return !Ar.IsError() && !OutSessionId.IsEmpty();
+	}
+
+	void DestroySocket(FSocket*& Socket)
+	{
+		if(!Socket)
+			return;
+
+		Socket->Close();
+		if (ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) })
+		{
+			SocketSubsystem->DestroySocket(Socket);
+		}
+
+		Socket = nullptr;
+	}
+}
+
+FMultiplayerSessionsLanBeacon::~FMultiplayerSessionsLanBeacon()
+{
+	Stop();
+}
+
+bool FMultiplayerSessionsLanBeacon::Start(const FMultiplayerLanDiscoverySettings& InSettings)
+{
+	Stop();
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	if(!SocketSubsystem)
+		return false;
+
+	for (int32 PortOffset{ 0 }; PortOffset < FMath::Max(InSettings.NumPorts, 1) && !Socket; ++PortOffset)
+	{
+		FSocket* NewSocket{ SocketSubsystem->CreateSocket(NAME_DGram, TEXT("MultiplayerSessionsLanBeacon"), false) };
+		if(!NewSocket)
+			return false;
+
+		NewSocket->SetNonBlocking(true);
+
+		TSharedRef<FInternetAddr> BindAddress{ SocketSubsystem->CreateInternetAddr() };
+		BindAddress->SetAnyAddress();
+		BindAddress->SetPort(InSettings.Port + PortOffset);
+
+		if (!NewSocket->Bind(*BindAddress))
+		{
+			SocketSubsystem->DestroySocket(NewSocket);
+			continue;
+		}
+
+		Socket = NewSocket;
+		Port = InSettings.Port + PortOffset;
+	}
+
+	if (!Socket)
+	{
+		MULTIPLAYER_LOG(Warning, TEXT("LAN discovery ports %d-%d are all taken, this host can't be discovered"), InSettings.Port, InSettings.Port + FMath::Max(InSettings.NumPorts, 1) - 1);
+		return false;
+	}
+
+	Ticker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsLanBeacon::Tick));
+	return true;
+}
+
+void FMultiplayerSessionsLanBeacon::Stop()
+{
+	if (Ticker_Handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(Ticker_Handle);
+		Ticker_Handle.Reset();
+	}
+
+	MultiplayerSessionsLanDiscovery::DestroySocket(Socket);
+	Port = 0;
+}
+
+void FMultiplayerSessionsLanBeacon::SetSessions(TConstArrayView<const FOnlineSession*> Sessions, int32 GamePort)
+{
+	using namespace MultiplayerSessionsLanDiscovery;
+
+	Description.Reset();
+	NumSessions = FMath::Min(Sessions.Num(), MaxSessionsPerReply);
+
+	FMemoryWriter Writer(Description);
+	Writer << GamePort << NumSessions;
+
+	for (int32 SessionIndex{ 0 }; SessionIndex < NumSessions; ++SessionIndex)
+	{
+		WriteSession(Writer, *Sessions[SessionIndex]);
+	}
+
+	if (QuerySize + Description.Num() > MaxPacketSize)
+	{
+		MULTIPLAYER_LOG(Warning, TEXT("Advertised LAN sessions take %d bytes, more than fits a discovery reply. Advertise fewer attributes"), Description.Num());
+		Description.Reset();
+		NumSessions = 0;
+	}
+}
+
+bool FMultiplayerSessionsLanBeacon::Tick(float DeltaTime)
+{
+	using namespace MultiplayerSessionsLanDiscovery;
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	if(!Socket || !SocketSubsystem)
+		return true;
+
+	TSharedRef<FInternetAddr> FromAddress{ SocketSubsystem->CreateInternetAddr() };
+	uint8 Query[QuerySize];
+	int32 BytesRead{ 0 };
+
+	while (Socket->RecvFrom(Query, QuerySize, BytesRead, *FromAddress))
+	{
+		if(BytesRead != QuerySize || NumSessions == 0)
+			continue;
+
+		FMemoryReaderView Reader(TArrayView<const uint8>(Query, QuerySize));
+		uint32 Magic{ 0 };
+		uint8 Version{ 0 };
+		uint32 Nonce{ 0 };
+		double SendTime{ 0.0 };
+		Reader << Magic << Version << Nonce << SendTime;
+
+		if(Reader.IsError() || Magic != QueryMagic || Version != ProtocolVersion)
+			continue;
+
+		//The nonce and send time go back as they came, the client measures the round trip with its own clock
+		TArray<uint8, TInlineAllocator<1024>> Reply;
+		Reply.Reserve(QuerySize + Description.Num());
+		Reply.SetNumUninitialized(QuerySize);
+		FMemory::Memcpy(Reply.GetData(), Query, QuerySize);
+		FMemory::Memcpy(Reply.GetData(), &ReplyMagic, sizeof(uint32));
+		Reply.Append(Description);
+
+		int32 BytesSent{ 0 };
+		Socket->SendTo(Reply.GetData(), Reply.Num(), BytesSent, *FromAddress);
+	}
+
+	return true;
+}
+
+FMultiplayerSessionsLanDiscovery::~FMultiplayerSessionsLanDiscovery()
+{
+	Stop();
+}
+
+bool FMultiplayerSessionsLanDiscovery::Start(const FMultiplayerLanDiscoverySettings& InSettings)
+{
+	Stop();
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	if(!SocketSubsystem)
+		return false;
+
+	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("MultiplayerSessionsLanDiscovery"), false);
+	if(!Socket)
+		return false;
+
+	Socket->SetNonBlocking(true);
+	Socket->SetBroadcast(true);
+
+	TSharedRef<FInternetAddr> BindAddress{ SocketSubsystem->CreateInternetAddr() };
+	BindAddress->SetAnyAddress();
+	BindAddress->SetPort(0);
+
+	if (!Socket->Bind(*BindAddress))
+	{
+		MultiplayerSessionsLanDiscovery::DestroySocket(Socket);
+		return false;
+	}
+
+	Settings = InSettings;
+
+	//Broadcasts reach hosts on other machines, loopback the ones on this machine even without a network
+	QueryAddresses.Reset();
+	for (int32 PortOffset{ 0 }; PortOffset < FMath::Max(Settings.NumPorts, 1); ++PortOffset)
+	{
+		TSharedRef<FInternetAddr> BroadcastAddress{ SocketSubsystem->CreateInternetAddr() };
+		BroadcastAddress->SetBroadcastAddress();
+		BroadcastAddress->SetPort(Settings.Port + PortOffset);
+		QueryAddresses.Add(BroadcastAddress);
+
+		TSharedRef<FInternetAddr> LoopbackAddress{ SocketSubsystem->CreateInternetAddr() };
+		LoopbackAddress->SetLoopbackAddress();
+		LoopbackAddress->SetPort(Settings.Port + PortOffset);
+		QueryAddresses.Add(LoopbackAddress);
+	}
+
+	Nonce = FPlatformTime::Cycles() ^ static_cast<uint32>(FMath::Rand());
+	Broadcast();
+
+	Ticker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsLanDiscovery::Tick));
+	return true;
+}
+
+void FMultiplayerSessionsLanDiscovery::Stop()
+{
+	if (Ticker_Handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(Ticker_Handle);
+		Ticker_Handle.Reset();
+	}
+
+	MultiplayerSessionsLanDiscovery::DestroySocket(Socket);
+	QueryAddresses.Reset();
+	Hosts.Reset();
+	bSearching = false;
+}
+
+void FMultiplayerSessionsLanDiscovery::SetSearching(bool bInSearching)
+{
+	const bool bStartsSearching{ bInSearching && !bSearching };
+	bSearching = bInSearching;
+
+	if (bStartsSearching)
+	{
+		Broadcast();
+	}
+}
+
+void FMultiplayerSessionsLanDiscovery::Broadcast()
+{
+	using namespace MultiplayerSessionsLanDiscovery;
+
+	if(!Socket)
+		return;
+
+	LastQueryTime = FPlatformTime::Seconds();
+
+	uint32 Magic{ QueryMagic };
+	uint8 Version{ ProtocolVersion };
+	double SendTime{ LastQueryTime };
+
+	TArray<uint8> Query;
+	Query.Reserve(QuerySize);
+	FMemoryWriter Writer(Query);
+	Writer << Magic << Version << Nonce << SendTime;
+
+	for (const TSharedRef<FInternetAddr>& QueryAddress : QueryAddresses)
+	{
+		int32 BytesSent{ 0 };
+		Socket->SendTo(Query.GetData(), Query.Num(), BytesSent, *QueryAddress);
+	}
+}
+
+bool FMultiplayerSessionsLanDiscovery::Tick(float DeltaTime)
+{
+	const double Now{ FPlatformTime::Seconds() };
+
+	bool bHostsChanged{ ReceiveReplies(Now) };
+	bHostsChanged |= ExpireHosts(Now);
+
+	if (Now - LastQueryTime >= (bSearching ? Settings.BroadcastInterval : Settings.ListenInterval))
+	{
+		Broadcast();
+	}
+
+	//Last, whoever is told may stop discovery right away
+	if (bHostsChanged)
+	{
+		OnHostsChanged.Broadcast();
+	}
+
+	return true;
+}
+
+bool FMultiplayerSessionsLanDiscovery::ReceiveReplies(double Now)
+{
+	using namespace MultiplayerSessionsLanDiscovery;
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	if(!Socket || !SocketSubsystem)
+		return false;
+
+	bool bHostsChanged{ false };
+
+	TSharedRef<FInternetAddr> FromAddress{ SocketSubsystem->CreateInternetAddr() };
+	uint8 Packet[MaxPacketSize];
+	int32 BytesRead{ 0 };
+
+	while (Socket->RecvFrom(Packet, MaxPacketSize, BytesRead, *FromAddress))
+	{
+		FMemoryReaderView Reader(TArrayView<const uint8>(Packet, BytesRead));
+		uint32 Magic{ 0 };
+		uint8 Version{ 0 };
+		uint32 PacketNonce{ 0 };
+		double SendTime{ 0.0 };
+		int32 GamePort{ 0 };
+		int32 NumSessions{ 0 };
+		Reader << Magic << Version << PacketNonce << SendTime << GamePort << NumSessions;
+
+		if(Reader.IsError() || Magic != ReplyMagic || Version != ProtocolVersion || PacketNonce != Nonce)
+			continue;
+
+		if(NumSessions <= 0 || NumSessions > MaxSessionsPerReply || GamePort <= 0)
+			continue;
+
+		const int32 PingInMs{ FMath::Max(1, FMath::RoundToInt((Now - SendTime) * 1000.0)) };
+		const FString Address{ FString::Printf(TEXT("%s:%d"), *FromAddress->ToString(false), GamePort) };
+
+		for (int32 SessionIndex{ 0 }; SessionIndex < NumSessions; ++SessionIndex)
+		{
+			const int64 SessionStart{ Reader.Tell() };
+
+			FString SessionId;
+			FOnlineSession Session;
+			if(!ReadSession(Reader, SessionId, Session))
+				break;
+
+			const uint32 DescriptionHash{ FCrc::MemCrc32(Packet + SessionStart, static_cast<int32>(Reader.Tell() - SessionStart)) };
+
+			FMultiplayerLanHost* Host{ Hosts.Find(SessionId) };
+			if (!Host)
+			{
+				//A host on this machine answers the broadcast and the loopback query, the address of the first answer is kept
+				Host = &Hosts.Add(SessionId);
+				Host->SessionId = SessionId;
+				Host->Address = Address;
+				bHostsChanged = true;
+			}
+			else if (Host->DescriptionHash != DescriptionHash)
+			{
+				bHostsChanged = true;
+			}
+
+			Host->Session = MoveTemp(Session);
+			Host->DescriptionHash = DescriptionHash;
+			Host->PingInMs = PingInMs;
+			Host->LastSeenTime = Now;
+		}
+	}
+
+	return bHostsChanged;
+}
+
+bool FMultiplayerSessionsLanDiscovery::ExpireHosts(double Now)
+{
+	const int32 NumHosts{ Hosts.Num() };
+
+	for (auto It{ Hosts.CreateIterator() }; It; ++It)
+	{
+		if(Now - It->Value.LastSeenTime <= Settings.HostTimeout)
+			continue;
+
+		It.RemoveCurrent();
+	}
+
+	return Hosts.Num() != NumHosts;
+}
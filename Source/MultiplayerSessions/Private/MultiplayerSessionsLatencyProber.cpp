@@ -0,0 +1,359 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsLatencyProber.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "HAL/RunnableThread.h"
+
+namespace MultiplayerSessionsLatencyProber
+{
+	//Magic, probe id, target index, send time
+	constexpr uint32 PacketMagic{ 0x5150534D };
+	constexpr int32 PacketSize{ sizeof(uint32) + sizeof(uint32) + sizeof(int32) + sizeof(double) };
+
+	//The host's ip with the echo port, the game port of the connect string has nothing answering probes
+	TSharedPtr<FInternetAddr> ParseAddress(ISocketSubsystem& SocketSubsystem, const FString& Address, int32 EchoPort)
+	{
+		if(EchoPort <= 0)
+			return nullptr;
+
+		FString Ip{ Address };
+		Address.Split(TEXT(":"), &Ip, nullptr, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+
+		TSharedRef<FInternetAddr> InternetAddr{ SocketSubsystem.CreateInternetAddr() };
+
+		bool bIsValid{ false };
+		InternetAddr->SetIp(*Ip, bIsValid);
+		if(!bIsValid)
+			return nullptr;
+
+		InternetAddr->SetPort(EchoPort);
+		return InternetAddr;
+	}
+
+	int32 GetReportedRtt(const FMultiplayerLatencyProbeTarget& Target)
+	{
+		//Backends report 9999 or 0 when they could not ping the host
+		const bool bWasMeasured{ Target.ReportedPingInMs > 0 && Target.ReportedPingInMs < 9999 };
+		return bWasMeasured ? Target.ReportedPingInMs : INDEX_NONE;
+	}
+}
+
+void FMultiplayerSessionsReportedPingProber::ProbeAsync(const TArray<FMultiplayerLatencyProbeTarget>& Targets, float TimeoutSeconds, FOnMultiplayerLatencyProbeComplete OnComplete)
+{
+	TArray<int32> RttInMs;
+	RttInMs.Reserve(Targets.Num());
+
+	for (const FMultiplayerLatencyProbeTarget& Target : Targets)
+	{
+		RttInMs.Add(MultiplayerSessionsLatencyProber::GetReportedRtt(Target));
+	}
+
+	OnComplete.ExecuteIfBound(RttInMs);
+}
+
+FMultiplayerSessionsUdpEchoProber::FMultiplayerSessionsUdpEchoProber(int32 InEchoPort /*= 0*/):
+	EchoPort{ InEchoPort }
+{
+
+}
+
+FMultiplayerSessionsUdpEchoProber::~FMultiplayerSessionsUdpEchoProber()
+{
+	CancelProbe();
+}
+
+void FMultiplayerSessionsUdpEchoProber::ProbeAsync(const TArray<FMultiplayerLatencyProbeTarget>& Targets, float TimeoutSeconds, FOnMultiplayerLatencyProbeComplete OnComplete)
+{
+	CancelProbe();
+
+	OnProbeComplete = MoveTemp(OnComplete);
+	RttInMs.Reset(Targets.Num());
+	ProbedRttInMs.Init(INDEX_NONE, Targets.Num());
+	TargetAddresses.Reset(Targets.Num());
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+
+	//Whatever can't be probed keeps its reported ping, measured ones replace it
+	for (const FMultiplayerLatencyProbeTarget& Target : Targets)
+	{
+		const int32 TargetEchoPort{ Target.EchoPort > 0 ? Target.EchoPort : EchoPort };
+		RttInMs.Add(MultiplayerSessionsLatencyProber::GetReportedRtt(Target));
+		TargetAddresses.Add(SocketSubsystem ? MultiplayerSessionsLatencyProber::ParseAddress(*SocketSubsystem, Target.Address, TargetEchoPort) : nullptr);
+	}
+
+	//Nobody to probe, the reported pings are all there is
+	if (!TargetAddresses.ContainsByPredicate([](const TSharedPtr<FInternetAddr>& Address) { return Address.IsValid(); }))
+	{
+		FinishProbe();
+		return;
+	}
+
+	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("MultiplayerSessionsLatencyProbe"), false);
+	if (!Socket)
+	{
+		FinishProbe();
+		return;
+	}
+
+	Socket->SetNonBlocking(true);
+
+	++ProbeId;
+	ProbeTimeout = TimeoutSeconds;
+	ProbeStartTime = FPlatformTime::Seconds();
+
+	SendPings();
+
+	Ticker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsUdpEchoProber::TickProbe));
+}
+
+void FMultiplayerSessionsUdpEchoProber::CancelProbe()
+{
+	if (Ticker_Handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(Ticker_Handle);
+		Ticker_Handle.Reset();
+	}
+
+	OnProbeComplete.Unbind();
+	CloseSocket();
+}
+
+bool FMultiplayerSessionsUdpEchoProber::TickProbe(float DeltaTime)
+{
+	ReceivePongs();
+
+	bool bAllAnswered{ true };
+	for (int32 TargetIndex{ 0 }; TargetIndex < TargetAddresses.Num() && bAllAnswered; ++TargetIndex)
+	{
+		bAllAnswered = !TargetAddresses[TargetIndex].IsValid() || ProbedRttInMs[TargetIndex] != INDEX_NONE;
+	}
+
+	const double Now{ FPlatformTime::Seconds() };
+	if (bAllAnswered || Now - ProbeStartTime >= ProbeTimeout)
+	{
+		Ticker_Handle.Reset();
+		FinishProbe();
+		return false;
+	}
+
+	if (Now - LastSendTime >= ResendInterval)
+	{
+		SendPings();
+	}
+
+	return true;
+}
+
+void FMultiplayerSessionsUdpEchoProber::SendPings()
+{
+	if(!Socket)
+		return;
+
+	LastSendTime = FPlatformTime::Seconds();
+
+	for (int32 TargetIndex{ 0 }; TargetIndex < TargetAddresses.Num(); ++TargetIndex)
+	{
+		if(!TargetAddresses[TargetIndex].IsValid() || ProbedRttInMs[TargetIndex] != INDEX_NONE)
+			continue;
+
+		//The send time travels with the packet, so a late answer to an earlier resend is still measured correctly
+		uint8 Packet[MultiplayerSessionsLatencyProber::PacketSize];
+		const double SendTime{ FPlatformTime::Seconds() };
+		FMemory::Memcpy(Packet, &MultiplayerSessionsLatencyProber::PacketMagic, sizeof(uint32));
+		FMemory::Memcpy(Packet + 4, &ProbeId, sizeof(uint32));
+		FMemory::Memcpy(Packet + 8, &TargetIndex, sizeof(int32));
+		FMemory::Memcpy(Packet + 12, &SendTime, sizeof(double));
+
+		int32 BytesSent{ 0 };
+		Socket->SendTo(Packet, MultiplayerSessionsLatencyProber::PacketSize, BytesSent, *TargetAddresses[TargetIndex]);
+	}
+}
+
+void FMultiplayerSessionsUdpEchoProber::ReceivePongs()
+{
+	if(!Socket)
+		return;
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	if(!SocketSubsystem)
+		return;
+
+	TSharedRef<FInternetAddr> FromAddress{ SocketSubsystem->CreateInternetAddr() };
+	uint8 Packet[MultiplayerSessionsLatencyProber::PacketSize];
+	int32 BytesRead{ 0 };
+
+	while (Socket->RecvFrom(Packet, MultiplayerSessionsLatencyProber::PacketSize, BytesRead, *FromAddress))
+	{
+		if(BytesRead != MultiplayerSessionsLatencyProber::PacketSize)
+			continue;
+
+		uint32 Magic{ 0 };
+		uint32 PacketProbeId{ 0 };
+		int32 TargetIndex{ INDEX_NONE };
+		double SendTime{ 0.0 };
+		FMemory::Memcpy(&Magic, Packet, sizeof(uint32));
+		FMemory::Memcpy(&PacketProbeId, Packet + 4, sizeof(uint32));
+		FMemory::Memcpy(&TargetIndex, Packet + 8, sizeof(int32));
+		FMemory::Memcpy(&SendTime, Packet + 12, sizeof(double));
+
+		if(Magic != MultiplayerSessionsLatencyProber::PacketMagic || PacketProbeId != ProbeId)
+			continue;
+
+		if(!ProbedRttInMs.IsValidIndex(TargetIndex) || ProbedRttInMs[TargetIndex] != INDEX_NONE)
+			continue;
+
+		ProbedRttInMs[TargetIndex] = FMath::Max(1, FMath::RoundToInt((FPlatformTime::Seconds() - SendTime) * 1000.0));
+	}
+}
+
+void FMultiplayerSessionsUdpEchoProber::FinishProbe()
+{
+	CloseSocket();
+
+	//A firewall may drop the probes of a host that is fine otherwise, those keep their reported ping
+	for (int32 TargetIndex{ 0 }; TargetIndex < ProbedRttInMs.Num(); ++TargetIndex)
+	{
+		if (ProbedRttInMs[TargetIndex] != INDEX_NONE)
+		{
+			RttInMs[TargetIndex] = ProbedRttInMs[TargetIndex];
+		}
+	}
+	ProbedRttInMs.Reset();
+
+	//The delegate may start the next probe right away
+	FOnMultiplayerLatencyProbeComplete CompletedDelegate{ MoveTemp(OnProbeComplete) };
+	OnProbeComplete.Unbind();
+	CompletedDelegate.ExecuteIfBound(RttInMs);
+}
+
+void FMultiplayerSessionsUdpEchoProber::CloseSocket()
+{
+	if(!Socket)
+		return;
+
+	Socket->Close();
+	if (ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) })
+	{
+		SocketSubsystem->DestroySocket(Socket);
+	}
+
+	Socket = nullptr;
+}
+
+FMultiplayerSessionsUdpEchoServer::FMultiplayerSessionsUdpEchoServer(int32 InPort, int32 InArtificialLatencyMs /*= 0*/):
+	Port{ InPort },
+	ArtificialLatencyMs{ InArtificialLatencyMs }
+{
+
+}
+
+FMultiplayerSessionsUdpEchoServer::~FMultiplayerSessionsUdpEchoServer()
+{
+	Shutdown();
+}
+
+bool FMultiplayerSessionsUdpEchoServer::Start()
+{
+	if(Thread)
+		return true;
+
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	if(!SocketSubsystem)
+		return false;
+
+	Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("MultiplayerSessionsEchoServer"), false);
+	if(!Socket)
+		return false;
+
+	Socket->SetNonBlocking(true);
+
+	TSharedRef<FInternetAddr> BindAddress{ SocketSubsystem->CreateInternetAddr() };
+	//Probes come from clients on other machines
+	BindAddress->SetAnyAddress();
+	BindAddress->SetPort(Port);
+
+	if (!Socket->Bind(*BindAddress))
+	{
+		SocketSubsystem->DestroySocket(Socket);
+		Socket = nullptr;
+		return false;
+	}
+
+	bStopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("MultiplayerSessionsEchoServer"));
+	return Thread != nullptr;
+}
+
+void FMultiplayerSessionsUdpEchoServer::Shutdown()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (Socket)
+	{
+		Socket->Close();
+		if (ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) })
+		{
+			SocketSubsystem->DestroySocket(Socket);
+		}
+
+		Socket = nullptr;
+	}
+}
+
+uint32 FMultiplayerSessionsUdpEchoServer::Run()
+{
+	ISocketSubsystem* SocketSubsystem{ ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM) };
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(1024);
+
+	while (!bStopping)
+	{
+		//Wake up in time for the next delayed echo
+		double WaitSeconds{ 0.05 };
+		const double Now{ FPlatformTime::Seconds() };
+		for (const FPendingEcho& PendingEcho : PendingEchoes)
+		{
+			WaitSeconds = FMath::Min(WaitSeconds, FMath::Max(0.0, PendingEcho.DueTime - Now));
+		}
+
+		if (Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(WaitSeconds)))
+		{
+			TSharedRef<FInternetAddr> FromAddress{ SocketSubsystem->CreateInternetAddr() };
+			int32 BytesRead{ 0 };
+			while (Socket->RecvFrom(Buffer.GetData(), Buffer.Num(), BytesRead, *FromAddress))
+			{
+				FPendingEcho& PendingEcho{ PendingEchoes.AddDefaulted_GetRef() };
+				PendingEcho.Data = TArray<uint8>(Buffer.GetData(), BytesRead);
+				PendingEcho.Address = FromAddress->Clone();
+				PendingEcho.DueTime = FPlatformTime::Seconds() + ArtificialLatencyMs / 1000.0;
+			}
+		}
+
+		const double SendTime{ FPlatformTime::Seconds() };
+		for (int32 EchoIndex{ PendingEchoes.Num() - 1 }; EchoIndex >= 0; --EchoIndex)
+		{
+			const FPendingEcho& PendingEcho{ PendingEchoes[EchoIndex] };
+			if(PendingEcho.DueTime > SendTime)
+				continue;
+
+			int32 BytesSent{ 0 };
+			Socket->SendTo(PendingEcho.Data.GetData(), PendingEcho.Data.Num(), BytesSent, *PendingEcho.Address);
+			PendingEchoes.RemoveAtSwap(EchoIndex);
+		}
+	}
+
+	return 0;
+}
+
+void FMultiplayerSessionsUdpEchoServer::Stop()
+{
+	bStopping = true;
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsLog.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogMultiplayerSessions);
+
+namespace MultiplayerSessionsLog
+{
+	static TAutoConsoleVariable<bool> CVarLogToScreen(
+		TEXT("MultiplayerSessions.LogToScreen"),
+		false,
+		TEXT("Mirrors LogMultiplayerSessions messages to the screen"));
+
+	bool IsScreenSinkEnabled()
+	{
+		return CVarLogToScreen.GetValueOnAnyThread();
+	}
+
+	void SetScreenSinkEnabled(bool bEnabled)
+	{
+		CVarLogToScreen->Set(bEnabled, ECVF_SetByCode);
+	}
+
+	void AddScreenMessage(ELogVerbosity::Type Verbosity, const FString& Message)
+	{
+		//Probe and backend threads can log too, the screen is game thread only
+		if(!GEngine || !IsInGameThread())
+			return;
+
+		FColor Color{ FColor::Cyan };
+		switch (Verbosity & ELogVerbosity::VerbosityMask)
+		{
+		case ELogVerbosity::Fatal:
+		case ELogVerbosity::Error:		Color = FColor::Red; break;
+		case ELogVerbosity::Warning:	Color = FColor::Yellow; break;
+		case ELogVerbosity::Display:	Color = FColor::Green; break;
+		default: break;
+		}
+
+		GEngine->AddOnScreenDebugMessage(-1, 10.f, Color, Message);
+	}
+}
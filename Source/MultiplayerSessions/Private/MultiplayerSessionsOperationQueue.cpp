@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsOperationQueue.h"
+
+FMultiplayerSessionsOperationQueue::~FMultiplayerSessionsOperationQueue()
+{
+	StopTimeoutTicker();
+}
+
+FMultiplayerOperationHandle FMultiplayerSessionsOperationQueue::Enqueue(EMultiplayerSessionOperation Type, FExecuteFunction Execute, FAbortFunction Abort, float TimeoutSeconds, bool bSupersedeActive /*= false*/, FName SessionName /*= NAME_None*/)
+{
+	//Button mashing, only the newest request matters. Requests for different sessions are unrelated.
+	//Searched from the back, a request is never moved ahead of one that creates, destroys or joins its session
+	for (int32 PendingIndex{ PendingOperations.Num() - 1 }; PendingIndex >= 0; --PendingIndex)
+	{
+		FOperation& PendingOperation{ PendingOperations[PendingIndex] };
+		if(PendingOperation.SessionName != SessionName)
+			continue;
+
+		if (PendingOperation.Type != Type)
+		{
+			if(!SessionName.IsNone() && IsSessionLifetimeOperation(PendingOperation.Type))
+				break;
+
+			continue;
+		}
+
+		//It never ran, so there is nothing to abort
+		PendingOperation.Execute = MoveTemp(Execute);
+		PendingOperation.Abort = MoveTemp(Abort);
+		PendingOperation.TimeoutSeconds = TimeoutSeconds;
+		return PendingOperation.Handle;
+	}
+
+	FOperation& Operation{ PendingOperations.AddDefaulted_GetRef() };
+	Operation.Handle.Id = NextHandleId++;
+	Operation.Type = Type;
+	Operation.SessionName = SessionName;
+	Operation.Execute = MoveTemp(Execute);
+	Operation.Abort = MoveTemp(Abort);
+	Operation.TimeoutSeconds = TimeoutSeconds;
+
+	const FMultiplayerOperationHandle Handle{ Operation.Handle };
+
+	if (bSupersedeActive && IsActive(Type))
+	{
+		AbortActive(EMultiplayerOperationAbortReason::Superseded);
+	}
+
+	StartNext();
+	return Handle;
+}
+
+void FMultiplayerSessionsOperationQueue::CompleteActive(EMultiplayerSessionOperation Type, FName SessionName /*= NAME_None*/)
+{
+	//Late callback of something that already timed out or was cancelled
+	if(!IsActive(Type) || (!SessionName.IsNone() && ActiveOperation->SessionName != SessionName))
+		return;
+
+	ActiveOperation.Reset();
+	StopTimeoutTicker();
+	StartNext();
+}
+
+bool FMultiplayerSessionsOperationQueue::Cancel(FMultiplayerOperationHandle Handle, bool bAllowActive)
+{
+	if(!Handle.IsValid())
+		return false;
+
+	if (ActiveOperation.IsSet() && ActiveOperation->Handle == Handle)
+	{
+		if(!bAllowActive)
+			return false;
+
+		AbortActive(EMultiplayerOperationAbortReason::Cancelled);
+		StartNext();
+		return true;
+	}
+
+	const int32 PendingIndex{ PendingOperations.IndexOfByPredicate([Handle](const FOperation& Operation) { return Operation.Handle == Handle; }) };
+	if(PendingIndex == INDEX_NONE)
+		return false;
+
+	//Waiting ones never ran, they only have to be dropped
+	FOperation Operation{ MoveTemp(PendingOperations[PendingIndex]) };
+	PendingOperations.RemoveAt(PendingIndex);
+
+	if (OnDropped)
+	{
+		OnDropped(Operation.Handle, Operation.Type, EMultiplayerOperationAbortReason::Cancelled, false);
+	}
+
+	return true;
+}
+
+bool FMultiplayerSessionsOperationQueue::CancelType(EMultiplayerSessionOperation Type, bool bAllowActive)
+{
+	bool bWasCancelled{ false };
+
+	for (int32 PendingIndex{ PendingOperations.Num() - 1 }; PendingIndex >= 0; --PendingIndex)
+	{
+		if (PendingOperations[PendingIndex].Type == Type)
+		{
+			bWasCancelled |= Cancel(PendingOperations[PendingIndex].Handle, false);
+		}
+	}
+
+	if (bAllowActive && IsActive(Type))
+	{
+		bWasCancelled |= Cancel(ActiveOperation->Handle, true);
+	}
+
+	return bWasCancelled;
+}
+
+void FMultiplayerSessionsOperationQueue::Reset()
+{
+	PendingOperations.Reset();
+	ActiveOperation.Reset();
+	StopTimeoutTicker();
+}
+
+bool FMultiplayerSessionsOperationQueue::IsActive(EMultiplayerSessionOperation Type) const
+{
+	return ActiveOperation.IsSet() && ActiveOperation->Type == Type;
+}
+
+bool FMultiplayerSessionsOperationQueue::IsPending(EMultiplayerSessionOperation Type) const
+{
+	return PendingOperations.ContainsByPredicate([Type](const FOperation& Operation) { return Operation.Type == Type; });
+}
+
+FMultiplayerOperationHandle FMultiplayerSessionsOperationQueue::GetActiveHandle() const
+{
+	return ActiveOperation.IsSet() ? ActiveOperation->Handle : FMultiplayerOperationHandle();
+}
+
+void FMultiplayerSessionsOperationQueue::StartNext()
+{
+	//Operations may complete synchronously from inside Execute, the outer loop picks up from there
+	if(bIsStartingNext)
+		return;
+
+	TGuardValue<bool> StartingNextGuard(bIsStartingNext, true);
+
+	while (!ActiveOperation.IsSet() && !PendingOperations.IsEmpty())
+	{
+		ActiveOperation = MoveTemp(PendingOperations[0]);
+		PendingOperations.RemoveAt(0);
+		ActiveOperation->StartTime = FPlatformTime::Seconds();
+
+		const FMultiplayerOperationHandle Handle{ ActiveOperation->Handle };
+		const bool bWasStarted{ ActiveOperation->Execute() };
+
+		//Failed to start, or already finished synchronously
+		if (!bWasStarted && ActiveOperation.IsSet() && ActiveOperation->Handle == Handle)
+		{
+			ActiveOperation.Reset();
+		}
+	}
+
+	if (ActiveOperation.IsSet() && ActiveOperation->TimeoutSeconds > 0.f && !TimeoutTicker_Handle.IsValid())
+	{
+		TimeoutTicker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMultiplayerSessionsOperationQueue::TickTimeouts), 0.1f);
+	}
+}
+
+void FMultiplayerSessionsOperationQueue::AbortActive(EMultiplayerOperationAbortReason Reason)
+{
+	if(!ActiveOperation.IsSet())
+		return;
+
+	FOperation Operation{ MoveTemp(ActiveOperation.GetValue()) };
+	ActiveOperation.Reset();
+	StopTimeoutTicker();
+
+	if (Operation.Abort)
+	{
+		Operation.Abort(Reason);
+	}
+
+	if (OnDropped)
+	{
+		OnDropped(Operation.Handle, Operation.Type, Reason, true);
+	}
+}
+
+bool FMultiplayerSessionsOperationQueue::TickTimeouts(float DeltaTime)
+{
+	if (!ActiveOperation.IsSet())
+	{
+		TimeoutTicker_Handle.Reset();
+		return false;
+	}
+
+	if (ActiveOperation->TimeoutSeconds <= 0.f || FPlatformTime::Seconds() - ActiveOperation->StartTime < ActiveOperation->TimeoutSeconds)
+		return true;
+
+	//The ticker is removed by AbortActive, StartNext may add a fresh one for the next operation
+	TimeoutTicker_Handle.Reset();
+	AbortActive(EMultiplayerOperationAbortReason::TimedOut);
+	StartNext();
+	return false;
+}
+
+bool FMultiplayerSessionsOperationQueue::IsSessionLifetimeOperation(EMultiplayerSessionOperation Type)
+{
+	return Type == EMultiplayerSessionOperation::Create || Type == EMultiplayerSessionOperation::Destroy || Type == EMultiplayerSessionOperation::Join;
+}
+
+void FMultiplayerSessionsOperationQueue::StopTimeoutTicker()
+{
+	if(!TimeoutTicker_Handle.IsValid())
+		return;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(TimeoutTicker_Handle);
+	TimeoutTicker_Handle.Reset();
+}
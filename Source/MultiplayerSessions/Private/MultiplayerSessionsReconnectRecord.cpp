@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsReconnectRecord.h"
+
+const FString UMultiplayerSessionsReconnectRecord::SlotName{ TEXT("MultiplayerSessionsReconnect") };
+
+bool UMultiplayerSessionsReconnectRecord::IsValidFor(FTimespan MaxAge) const
+{
+	if(SessionId.IsEmpty() || SessionAddress.IsEmpty())
+		return false;
+
+	//Hosts don't stick around forever, an old record is more likely to waste a connection attempt than not
+	return FDateTime::UtcNow() - JoinedTime <= MaxAge;
+}
@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsScoring.h"
+#include "MultiplayerSessionsSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Score sessions"), STAT_MultiplayerSessions_ScoreSessions, STATGROUP_MultiplayerSessions);
+
+namespace MultiplayerSessionsScoring
+{
+	//Added instead of branching, a handful of them still fit in a float
+	static constexpr float ExcludedScore{ 1.e30f };
+	//Matches no row, for a region the player asked for that no session advertises
+	static constexpr uint16 UnknownRegionId{ MAX_uint16 };
+}
+
+void FMultiplayerSessionsScoringTable::Reset()
+{
+	ResultIndices.Reset();
+	PingsMs.Reset();
+	FillRatios.Reset();
+	SkillBrackets.Reset();
+	BuildIds.Reset();
+	OpenSlots.Reset();
+	MatchTypeIds.Reset();
+	RegionIds.Reset();
+	StaleFlags.Reset();
+}
+
+void FMultiplayerSessionsScoringTable::Reserve(int32 NumRows)
+{
+	ResultIndices.Reserve(NumRows);
+	PingsMs.Reserve(NumRows);
+	FillRatios.Reserve(NumRows);
+	SkillBrackets.Reserve(NumRows);
+	BuildIds.Reserve(NumRows);
+	OpenSlots.Reserve(NumRows);
+	MatchTypeIds.Reserve(NumRows);
+	RegionIds.Reserve(NumRows);
+	StaleFlags.Reserve(NumRows);
+}
+
+void FMultiplayerSessionsScoringTable::AddRow(int32 ResultIndex, int32 PingInMs, int16 InOpenSlots, int16 MaxSlots, uint16 MatchTypeId, int32 SkillBracket, uint16 RegionId, int32 BuildId)
+{
+	ResultIndices.Add(ResultIndex);
+	PingsMs.Add(static_cast<float>(PingInMs));
+	FillRatios.Add(MaxSlots > 0 ? 1.f - static_cast<float>(InOpenSlots) / MaxSlots : 0.f);
+	SkillBrackets.Add(SkillBracket);
+	BuildIds.Add(BuildId);
+	OpenSlots.Add(InOpenSlots);
+	MatchTypeIds.Add(MatchTypeId);
+	RegionIds.Add(RegionId);
+	StaleFlags.Add(0);
+}
+
+void FMultiplayerSessionsScoringTable::SetStale(int32 Row)
+{
+	if(!StaleFlags.IsValidIndex(Row))
+		return;
+
+	StaleFlags[Row] = 1;
+}
+
+SIZE_T FMultiplayerSessionsScoringTable::GetAllocatedSize() const
+{
+	return ResultIndices.GetAllocatedSize() + PingsMs.GetAllocatedSize() + FillRatios.GetAllocatedSize() + SkillBrackets.GetAllocatedSize()
+		+ BuildIds.GetAllocatedSize() + OpenSlots.GetAllocatedSize() + MatchTypeIds.GetAllocatedSize() + RegionIds.GetAllocatedSize()
+		+ StaleFlags.GetAllocatedSize() + Scores.GetAllocatedSize() + RegionIdsByName.GetAllocatedSize();
+}
+
+uint16 FMultiplayerSessionsScoringTable::InternRegion(const FString& Region)
+{
+	if(Region.IsEmpty())
+		return 0;
+
+	if(const uint16* RegionId{ RegionIdsByName.Find(Region) })
+		return *RegionId;
+
+	if(RegionIdsByName.Num() >= MultiplayerSessionsScoring::UnknownRegionId - 1)
+		return 0;
+
+	return RegionIdsByName.Add(Region, static_cast<uint16>(RegionIdsByName.Num() + 1));
+}
+
+uint16 FMultiplayerSessionsScoringTable::FindRegionId(const FString& Region) const
+{
+	const uint16* RegionId{ RegionIdsByName.Find(Region) };
+	return RegionId ? *RegionId : 0;
+}
+
+void FMultiplayerSessionsScoringTable::Score(const FMultiplayerScoringWeights& Weights, const FMultiplayerScoringQuery& Query, uint16 MatchTypeId, int32 NumResults, TArray<FMultiplayerRankedSession>& OutRankedSessions)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MultiplayerSessions_ScoreSessions);
+	using namespace MultiplayerSessionsScoring;
+
+	OutRankedSessions.Reset();
+
+	const int32 NumRows{ ResultIndices.Num() };
+	if(NumRows == 0 || NumResults <= 0)
+		return;
+
+	Scores.SetNumUninitialized(NumRows);
+	float* RESTRICT ScoreData{ Scores.GetData() };
+
+	//One criterion per loop over one or two packed columns, no branches inside so each of them vectorizes
+	{
+		const float* RESTRICT PingData{ PingsMs.GetData() };
+		const float UnknownPingMs{ Weights.UnknownPingMs };
+		const float PingWeight{ Weights.PingWeight };
+		const float MaxPingMs{ Weights.MaxPingMs > 0.f ? Weights.MaxPingMs : MAX_flt };
+
+		for (int32 Row{ 0 }; Row < NumRows; ++Row)
+		{
+			const float PingMs{ PingData[Row] > 0.f ? PingData[Row] : UnknownPingMs };
+			ScoreData[Row] = PingMs * PingWeight + (PingMs > MaxPingMs ? ExcludedScore : 0.f);
+		}
+	}
+
+	{
+		const float* RESTRICT FillData{ FillRatios.GetData() };
+		const float TargetFillRatio{ Weights.TargetFillRatio };
+		const float FillWeight{ Weights.FillWeight };
+
+		for (int32 Row{ 0 }; Row < NumRows; ++Row)
+		{
+			ScoreData[Row] += FMath::Abs(FillData[Row] - TargetFillRatio) * FillWeight;
+		}
+	}
+
+	{
+		const int32* RESTRICT SkillData{ SkillBrackets.GetData() };
+		const int32 SkillBracket{ Query.SkillBracket };
+		const float SkillWeight{ Weights.SkillWeight };
+		const int32 MaxDistance{ Weights.MaxSkillBracketDistance >= 0 ? Weights.MaxSkillBracketDistance : MAX_int32 };
+
+		for (int32 Row{ 0 }; Row < NumRows; ++Row)
+		{
+			const int32 Distance{ FMath::Abs(SkillData[Row] - SkillBracket) };
+			ScoreData[Row] += Distance * SkillWeight + (Distance > MaxDistance ? ExcludedScore : 0.f);
+		}
+	}
+
+	if (!Query.Region.IsEmpty())
+	{
+		const uint16* RESTRICT RegionData{ RegionIds.GetData() };
+		const uint16 RegionId{ FindRegionId(Query.Region) };
+		const uint16 QueryRegionId{ RegionId != 0 ? RegionId : UnknownRegionId };
+		const float RegionMismatchPenalty{ Weights.RegionMismatchPenalty };
+
+		for (int32 Row{ 0 }; Row < NumRows; ++Row)
+		{
+			ScoreData[Row] += RegionData[Row] != QueryRegionId ? RegionMismatchPenalty : 0.f;
+		}
+	}
+
+	if (Weights.bRequireSameBuild && Query.BuildId != 0)
+	{
+		const int32* RESTRICT BuildData{ BuildIds.GetData() };
+		const int32 BuildId{ Query.BuildId };
+
+		for (int32 Row{ 0 }; Row < NumRows; ++Row)
+		{
+			ScoreData[Row] += (BuildData[Row] != 0 && BuildData[Row] != BuildId) ? ExcludedScore : 0.f;
+		}
+	}
+
+	{
+		const uint16* RESTRICT MatchTypeData{ MatchTypeIds.GetData() };
+		const int16* RESTRICT OpenSlotsData{ OpenSlots.GetData() };
+		const uint8* RESTRICT StaleData{ StaleFlags.GetData() };
+		const bool bAnyMatchType{ MatchTypeId == 0 };
+
+		for (int32 Row{ 0 }; Row < NumRows; ++Row)
+		{
+			const bool bIsExcluded{ (StaleData[Row] != 0) | (OpenSlotsData[Row] <= 0) | (!bAnyMatchType & (MatchTypeData[Row] != MatchTypeId)) };
+			ScoreData[Row] += bIsExcluded ? ExcludedScore : 0.f;
+		}
+	}
+
+	//Keeps the worst of the best NumResults on top, most rows are rejected by a single compare against it
+	auto IsWorse = [ScoreData](int32 A, int32 B)
+	{
+		return ScoreData[A] > ScoreData[B] || (ScoreData[A] == ScoreData[B] && A > B);
+	};
+
+	TArray<int32> BestRows;
+	BestRows.Reserve(FMath::Min(NumResults, NumRows) + 1);
+
+	for (int32 Row{ 0 }; Row < NumRows; ++Row)
+	{
+		if(ScoreData[Row] >= ExcludedScore)
+			continue;
+
+		if (BestRows.Num() < NumResults)
+		{
+			BestRows.HeapPush(Row, IsWorse);
+			continue;
+		}
+
+		if(!IsWorse(BestRows.HeapTop(), Row))
+			continue;
+
+		BestRows.HeapPopDiscard(IsWorse);
+		BestRows.HeapPush(Row, IsWorse);
+	}
+
+	BestRows.Sort([&IsWorse](int32 A, int32 B) { return IsWorse(B, A); });
+
+	OutRankedSessions.Reserve(BestRows.Num());
+	for (const int32 Row : BestRows)
+	{
+		FMultiplayerRankedSession& RankedSession{ OutRankedSessions.AddDefaulted_GetRef() };
+		RankedSession.ResultIndex = ResultIndices[Row];
+		RankedSession.RttInMs = static_cast<int32>(PingsMs[Row]);
+		RankedSession.OpenSlots = OpenSlots[Row];
+		RankedSession.Score = ScoreData[Row];
+	}
+}
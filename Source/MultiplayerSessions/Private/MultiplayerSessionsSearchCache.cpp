@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsSearchCache.h"
+#include "OnlineSessionSettings.h"
+#include "MultiplayerSessionsAttributes.h"
+
+FMultiplayerSessionsSearchCache::FMultiplayerSessionsSearchCache()
+{
+	//Id 0 is reserved for sessions without a match type
+	MatchTypeNames.Add(FString());
+	MatchTypeToResults.SetNum(1);
+}
+
+void FMultiplayerSessionsSearchCache::Reset()
+{
+	SessionIdToResult.Reset();
+	Summaries.Reset();
+	ResultToSummary.Reset();
+	ScoringTable.Reset();
+	NumIndexed = 0;
+	++Generation;
+
+	for (TArray<int32>& Results : MatchTypeToResults)
+	{
+		Results.Reset();
+	}
+}
+
+void FMultiplayerSessionsSearchCache::IndexResults(const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	IndexResults(SearchResults, MAX_dbl);
+}
+
+bool FMultiplayerSessionsSearchCache::IndexResults(const TArray<FOnlineSessionSearchResult>& SearchResults, double EndTime)
+{
+	if (SearchResults.Num() <= NumIndexed)
+		return true;
+
+	ReserveFor(SearchResults.Num());
+
+	const double SeenTime{ FPlatformTime::Seconds() };
+
+	while (NumIndexed < SearchResults.Num())
+	{
+		AddParsedResult(NumIndexed, ParseResult(SearchResults[NumIndexed]), SeenTime);
+
+		//Reading the clock is not free, check it every few results only
+		if (NumIndexed % TimeCheckInterval == 0 && FPlatformTime::Seconds() > EndTime)
+			break;
+	}
+
+	return NumIndexed >= SearchResults.Num();
+}
+
+bool FMultiplayerSessionsSearchCache::IndexParsedResults(TArrayView<FParsedResult> ParsedResults, int32 FirstResultIndex, double EndTime)
+{
+	const int32 NumResults{ FirstResultIndex + ParsedResults.Num() };
+
+	//Parsed for a different state of the cache
+	if (NumIndexed < FirstResultIndex)
+		return false;
+
+	if (NumIndexed >= NumResults)
+		return true;
+
+	ReserveFor(NumResults);
+
+	const double SeenTime{ FPlatformTime::Seconds() };
+
+	while (NumIndexed < NumResults)
+	{
+		AddParsedResult(NumIndexed, MoveTemp(ParsedResults[NumIndexed - FirstResultIndex]), SeenTime);
+
+		if (NumIndexed % TimeCheckInterval == 0 && FPlatformTime::Seconds() > EndTime)
+			break;
+	}
+
+	return NumIndexed >= NumResults;
+}
+
+FMultiplayerSessionsSearchCache::FParsedResult FMultiplayerSessionsSearchCache::ParseResult(const FOnlineSessionSearchResult& SearchResult)
+{
+	FParsedResult ParsedResult;
+	ParsedResult.SessionId = SearchResult.GetSessionIdStr();
+	ParsedResult.SessionIdHash = GetTypeHash(ParsedResult.SessionId);
+	ParsedResult.PingInMs = SearchResult.PingInMs;
+	ParsedResult.OpenSlots = static_cast<int16>(SearchResult.Session.NumOpenPublicConnections);
+	ParsedResult.MaxSlots = static_cast<int16>(SearchResult.Session.SessionSettings.NumPublicConnections);
+	ParsedResult.BuildId = SearchResult.Session.SessionSettings.BuildUniqueId;
+	MultiplayerSessionAttributes::MatchType.TryRead(SearchResult.Session.SessionSettings, ParsedResult.MatchType);
+	MultiplayerSessionAttributes::SkillBracket.TryRead(SearchResult.Session.SessionSettings, ParsedResult.SkillBracket);
+	MultiplayerSessionAttributes::Region.TryRead(SearchResult.Session.SessionSettings, ParsedResult.Region);
+
+	//Hosts with admission control also subtract the slots reserved for players on their way
+	int32 AdvertisedOpenSlots{ 0 };
+	if (MultiplayerSessionAttributes::OpenSlots.TryRead(SearchResult.Session.SessionSettings, AdvertisedOpenSlots))
+	{
+		ParsedResult.OpenSlots = static_cast<int16>(FMath::Min<int32>(ParsedResult.OpenSlots, AdvertisedOpenSlots));
+	}
+
+	return ParsedResult;
+}
+
+void FMultiplayerSessionsSearchCache::ReserveFor(int32 NumResults)
+{
+	SessionIdToResult.Reserve(NumResults);
+	Summaries.Reserve(NumResults);
+	ResultToSummary.Reserve(NumResults);
+	ScoringTable.Reserve(NumResults);
+}
+
+void FMultiplayerSessionsSearchCache::AddParsedResult(int32 ResultIndex, FParsedResult&& ParsedResult, double SeenTime)
+{
+	check(ResultIndex == NumIndexed);
+
+	ResultToSummary.Add(INDEX_NONE);
+	++NumIndexed;
+
+	//Keep the first one, backends may report the same session more than once
+	if(SessionIdToResult.FindByHash(ParsedResult.SessionIdHash, ParsedResult.SessionId))
+		return;
+
+	SessionIdToResult.AddByHash(ParsedResult.SessionIdHash, MoveTemp(ParsedResult.SessionId), ResultIndex);
+
+	const uint16 MatchTypeId{ InternMatchType(ParsedResult.MatchType) };
+	MatchTypeToResults[MatchTypeId].Add(ResultIndex);
+
+	ResultToSummary[ResultIndex] = Summaries.Num();
+	FMultiplayerSessionSummary& Summary{ Summaries.AddDefaulted_GetRef() };
+	Summary.SessionIdHash = ParsedResult.SessionIdHash;
+	Summary.ResultIndex = ResultIndex;
+	Summary.PingInMs = ParsedResult.PingInMs;
+	Summary.OpenSlots = ParsedResult.OpenSlots;
+	Summary.MaxSlots = ParsedResult.MaxSlots;
+	Summary.MatchTypeId = MatchTypeId;
+	Summary.SeenTime = SeenTime;
+
+	ScoringTable.AddRow(ResultIndex, ParsedResult.PingInMs, ParsedResult.OpenSlots, ParsedResult.MaxSlots, MatchTypeId,
+		ParsedResult.SkillBracket, ScoringTable.InternRegion(ParsedResult.Region), ParsedResult.BuildId);
+}
+
+int32 FMultiplayerSessionsSearchCache::FindById(const FString& SessionId) const
+{
+	const int32* ResultIndex{ SessionIdToResult.Find(SessionId) };
+	return ResultIndex ? *ResultIndex : INDEX_NONE;
+}
+
+TConstArrayView<int32> FMultiplayerSessionsSearchCache::FindByMatchType(const FString& MatchType) const
+{
+	const uint16 MatchTypeId{ FindMatchTypeId(MatchType) };
+	if (!MatchTypeToResults.IsValidIndex(MatchTypeId))
+		return TConstArrayView<int32>();
+
+	return MatchTypeToResults[MatchTypeId];
+}
+
+const FMultiplayerSessionSummary* FMultiplayerSessionsSearchCache::FindSummary(int32 ResultIndex) const
+{
+	if(!ResultToSummary.IsValidIndex(ResultIndex) || ResultToSummary[ResultIndex] == INDEX_NONE)
+		return nullptr;
+
+	return &Summaries[ResultToSummary[ResultIndex]];
+}
+
+void FMultiplayerSessionsSearchCache::MarkStale(int32 ResultIndex)
+{
+	if(!ResultToSummary.IsValidIndex(ResultIndex) || ResultToSummary[ResultIndex] == INDEX_NONE)
+		return;
+
+	Summaries[ResultToSummary[ResultIndex]].bIsStale = true;
+	ScoringTable.SetStale(ResultToSummary[ResultIndex]);
+}
+
+bool FMultiplayerSessionsSearchCache::IsStale(int32 ResultIndex) const
+{
+	const FMultiplayerSessionSummary* Summary{ FindSummary(ResultIndex) };
+	return Summary && Summary->bIsStale;
+}
+
+int32 FMultiplayerSessionsSearchCache::ExpireSeenBefore(double Time)
+{
+	int32 NumExpired{ 0 };
+
+	for (int32 SummaryIndex{ 0 }; SummaryIndex < Summaries.Num(); ++SummaryIndex)
+	{
+		FMultiplayerSessionSummary& Summary{ Summaries[SummaryIndex] };
+		if(Summary.bIsStale || Summary.SeenTime >= Time)
+			continue;
+
+		Summary.bIsStale = true;
+		ScoringTable.SetStale(SummaryIndex);
+		++NumExpired;
+	}
+
+	return NumExpired;
+}
+
+void FMultiplayerSessionsSearchCache::MarkTrimmed(int32 ResultIndex)
+{
+	if(!ResultToSummary.IsValidIndex(ResultIndex) || ResultToSummary[ResultIndex] == INDEX_NONE)
+		return;
+
+	Summaries[ResultToSummary[ResultIndex]].bIsTrimmed = true;
+}
+
+bool FMultiplayerSessionsSearchCache::IsTrimmed(int32 ResultIndex) const
+{
+	const FMultiplayerSessionSummary* Summary{ FindSummary(ResultIndex) };
+	return Summary && Summary->bIsTrimmed;
+}
+
+double FMultiplayerSessionsSearchCache::GetAge(int32 ResultIndex) const
+{
+	const FMultiplayerSessionSummary* Summary{ FindSummary(ResultIndex) };
+	return Summary ? FPlatformTime::Seconds() - Summary->SeenTime : -1.0;
+}
+
+SIZE_T FMultiplayerSessionsSearchCache::GetAllocatedSize() const
+{
+	SIZE_T Size{ SessionIdToResult.GetAllocatedSize() + MatchTypeToResults.GetAllocatedSize() + Summaries.GetAllocatedSize() + ResultToSummary.GetAllocatedSize() };
+
+	for (const TPair<FString, int32>& SessionId : SessionIdToResult)
+	{
+		Size += SessionId.Key.GetAllocatedSize();
+	}
+
+	for (const TArray<int32>& Results : MatchTypeToResults)
+	{
+		Size += Results.GetAllocatedSize();
+	}
+
+	return Size + ScoringTable.GetAllocatedSize();
+}
+
+uint16 FMultiplayerSessionsSearchCache::InternMatchType(const FString& MatchType)
+{
+	if(MatchType.IsEmpty())
+		return 0;
+
+	if (const uint16* MatchTypeId{ MatchTypeIds.Find(MatchType) })
+		return *MatchTypeId;
+
+	//Match types are a handful of designer-made names, running out of ids means something is advertising garbage
+	if (MatchTypeNames.Num() > MAX_uint16)
+		return 0;
+
+	const uint16 MatchTypeId{ static_cast<uint16>(MatchTypeNames.Add(MatchType)) };
+	MatchTypeIds.Add(MatchType, MatchTypeId);
+	MatchTypeToResults.SetNum(MatchTypeNames.Num());
+	return MatchTypeId;
+}
+
+uint16 FMultiplayerSessionsSearchCache::FindMatchTypeId(const FString& MatchType) const
+{
+	const uint16* MatchTypeId{ MatchTypeIds.Find(MatchType) };
+	return MatchTypeId ? *MatchTypeId : 0;
+}
+
+const FString& FMultiplayerSessionsSearchCache::GetMatchTypeName(uint16 MatchTypeId) const
+{
+	return MatchTypeNames.IsValidIndex(MatchTypeId) ? MatchTypeNames[MatchTypeId] : MatchTypeNames[0];
+}
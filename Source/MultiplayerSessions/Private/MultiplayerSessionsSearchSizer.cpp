@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsSearchSizer.h"
+
+int32 FMultiplayerSessionsSearchSizer::GetInitialSize(const FString& MatchType, int32 NumWanted, int32 MaxResults) const
+{
+	return GetSizeFor(GetHitRate(MatchType), NumWanted, MaxResults);
+}
+
+int32 FMultiplayerSessionsSearchSizer::GetWidenedSize(int32 CurrentSize, int32 NumWanted, int32 NumReturned, int32 NumQualified, int32 MaxResults) const
+{
+	//What this search saw, the smoothed rate may still remember better times
+	const float HitRate{ NumReturned > 0 ? static_cast<float>(NumQualified) / NumReturned : MinHitRate };
+
+	//At least double, otherwise a rate close to the old guess would widen in tiny steps
+	const int32 NextSize{ FMath::Max(GetSizeFor(HitRate, NumWanted, MaxResults), CurrentSize * 2) };
+	return FMath::Clamp(NextSize, 1, FMath::Max(MaxResults, 1));
+}
+
+void FMultiplayerSessionsSearchSizer::RecordSearch(const FString& MatchType, int32 NumReturned, int32 NumQualified)
+{
+	//Nothing out there tells nothing about the share of usable hosts
+	if(NumReturned <= 0)
+		return;
+
+	const float HitRate{ FMath::Clamp(static_cast<float>(NumQualified) / NumReturned, 0.f, 1.f) };
+
+	float* SmoothedHitRate{ HitRates.Find(MatchType) };
+	if (!SmoothedHitRate)
+	{
+		HitRates.Add(MatchType, HitRate);
+		return;
+	}
+
+	*SmoothedHitRate = FMath::Lerp(*SmoothedHitRate, HitRate, Smoothing);
+}
+
+float FMultiplayerSessionsSearchSizer::GetHitRate(const FString& MatchType) const
+{
+	const float* HitRate{ HitRates.Find(MatchType) };
+	return HitRate ? *HitRate : DefaultHitRate;
+}
+
+int32 FMultiplayerSessionsSearchSizer::GetSizeFor(float HitRate, int32 NumWanted, int32 MaxResults) const
+{
+	const float Size{ FMath::Max(NumWanted, 1) * Headroom / FMath::Max(HitRate, MinHitRate) };
+	return FMath::Clamp(FMath::Max(FMath::CeilToInt(Size), MinSearchSize), 1, FMath::Max(MaxResults, 1));
+}
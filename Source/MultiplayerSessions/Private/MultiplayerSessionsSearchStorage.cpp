@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsSearchStorage.h"
+#include "OnlineSessionSettings.h"
+#include "MultiplayerSessionsSearchCache.h"
+#include "MultiplayerSessionsStats.h"
+
+DECLARE_MEMORY_STAT(TEXT("Retained search results"), STAT_MultiplayerSessions_SearchResultsMemory, STATGROUP_MultiplayerSessions);
+DECLARE_MEMORY_STAT(TEXT("Search cache"), STAT_MultiplayerSessions_SearchCacheMemory, STATGROUP_MultiplayerSessions);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trimmed search results"), STAT_MultiplayerSessions_TrimmedSearchResults, STATGROUP_MultiplayerSessions);
+
+TSharedRef<FOnlineSessionSearch> FMultiplayerSessionsSearchStorage::Acquire()
+{
+	if(!SpareSearch.IsValid())
+		return MakeShared<FOnlineSessionSearch>();
+
+	const TSharedRef<FOnlineSessionSearch> Search{ SpareSearch.ToSharedRef() };
+	SpareSearch.Reset();
+	return Search;
+}
+
+void FMultiplayerSessionsSearchStorage::Recycle(TSharedPtr<FOnlineSessionSearch>&& Search, SIZE_T BudgetBytes)
+{
+	//Still held by a future, a listener or the backend, it goes away with the last of them
+	if(!Search.IsValid() || !Search.IsUnique())
+	{
+		Search.Reset();
+		return;
+	}
+
+	TArray<FOnlineSessionSearchResult> Results{ MoveTemp(Search->SearchResults) };
+	Results.Reset();
+
+	if (BudgetBytes > 0 && Results.GetAllocatedSize() > BudgetBytes)
+	{
+		Results.Empty();
+	}
+
+	*Search = FOnlineSessionSearch();
+	Search->SearchResults = MoveTemp(Results);
+	SpareSearch = MoveTemp(Search);
+}
+
+SIZE_T FMultiplayerSessionsSearchStorage::EstimateFootprint(const FOnlineSessionSearch& Search) const
+{
+	return Search.SearchResults.GetAllocatedSize() + GetAverageResultHeapSize(Search) * Search.SearchResults.Num();
+}
+
+int32 FMultiplayerSessionsSearchStorage::GetNumResultsWithin(const FOnlineSessionSearch& Search, SIZE_T BudgetBytes) const
+{
+	const SIZE_T ArraySize{ Search.SearchResults.GetAllocatedSize() };
+	const SIZE_T AverageResultSize{ FMath::Max<SIZE_T>(GetAverageResultHeapSize(Search), 1) };
+	if(BudgetBytes <= ArraySize)
+		return 1;
+
+	return static_cast<int32>(FMath::Clamp<SIZE_T>((BudgetBytes - ArraySize) / AverageResultSize, 1, MAX_int32));
+}
+
+TArray<int32> FMultiplayerSessionsSearchStorage::Trim(FOnlineSessionSearch& Search, const TBitArray<>& KeptResults)
+{
+	TArray<int32> TrimmedResults;
+
+	for (int32 ResultIndex{ 0 }; ResultIndex < Search.SearchResults.Num(); ++ResultIndex)
+	{
+		if(KeptResults.IsValidIndex(ResultIndex) && KeptResults[ResultIndex])
+			continue;
+
+		//Already trimmed by an earlier pass
+		FOnlineSessionSearchResult& SearchResult{ Search.SearchResults[ResultIndex] };
+		if(!SearchResult.Session.SessionInfo.IsValid() && SearchResult.Session.SessionSettings.Settings.IsEmpty())
+			continue;
+
+		SearchResult = FOnlineSessionSearchResult();
+		TrimmedResults.Add(ResultIndex);
+	}
+
+	INC_DWORD_STAT_BY(STAT_MultiplayerSessions_TrimmedSearchResults, TrimmedResults.Num());
+	return TrimmedResults;
+}
+
+void FMultiplayerSessionsSearchStorage::UpdateStats(const FOnlineSessionSearch* Search, const FMultiplayerSessionsSearchCache& SearchCache)
+{
+	RetainedSize = Search ? EstimateFootprint(*Search) : 0;
+
+	SET_MEMORY_STAT(STAT_MultiplayerSessions_SearchResultsMemory, RetainedSize);
+	SET_MEMORY_STAT(STAT_MultiplayerSessions_SearchCacheMemory, SearchCache.GetAllocatedSize());
+}
+
+SIZE_T FMultiplayerSessionsSearchStorage::GetResultHeapSize(const FOnlineSessionSearchResult& SearchResult)
+{
+	const FOnlineSessionSettings& SessionSettings{ SearchResult.Session.SessionSettings };
+
+	SIZE_T Size{ SearchResult.Session.OwningUserName.GetAllocatedSize() + SessionSettings.Settings.GetAllocatedSize() + SessionSettings.MemberSettings.GetAllocatedSize() };
+
+	//The strings of string settings are allocated apart from the map
+	for (const TPair<FName, FOnlineSessionSetting>& Setting : SessionSettings.Settings)
+	{
+		if (Setting.Value.Data.GetType() == EOnlineKeyValuePairDataType::String)
+		{
+			Size += Setting.Value.Data.ToString().GetAllocatedSize();
+		}
+	}
+
+	for (const TPair<FUniqueNetIdRef, FSessionSettings>& MemberSettings : SessionSettings.MemberSettings)
+	{
+		Size += MemberSettings.Value.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+SIZE_T FMultiplayerSessionsSearchStorage::GetAverageResultHeapSize(const FOnlineSessionSearch& Search) const
+{
+	const int32 NumResults{ Search.SearchResults.Num() };
+	if(NumResults == 0)
+		return 0;
+
+	//Spread over the whole array, trimmed results count as the little they still are
+	const int32 NumSamples{ FMath::Min(NumResults, NumSampledResults) };
+	SIZE_T SampledSize{ 0 };
+
+	for (int32 SampleIndex{ 0 }; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		SampledSize += GetResultHeapSize(Search.SearchResults[static_cast<int64>(SampleIndex) * NumResults / NumSamples]);
+	}
+
+	return SampledSize / NumSamples;
+}
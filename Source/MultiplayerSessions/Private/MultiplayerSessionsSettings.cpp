@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsSettings.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+UMultiplayerSessionsSettings::UMultiplayerSessionsSettings()
+{
+	//Same as the menu defaults
+	FMultiplayerSessionPreset& FreeForAll{ SessionPresets.AddDefaulted_GetRef() };
+	FreeForAll.Name = TEXT("FreeForAll");
+	FreeForAll.PublicConnections = 4;
+	FreeForAll.MatchType = TEXT("FreeForAll");
+}
+
+EMultiplayerSessionsBackendType UMultiplayerSessionsSettings::GetBackendType() const
+{
+	//Dedicated and test builds pick theirs without a config of their own
+	FString BackendName;
+	if(!FParse::Value(FCommandLine::Get(), TEXT("MultiplayerSessionsBackend="), BackendName))
+		return Backend;
+
+	const UEnum* BackendEnum{ StaticEnum<EMultiplayerSessionsBackendType>() };
+	const int64 BackendValue{ BackendEnum->GetValueByNameString(BackendName) };
+	if(BackendValue == INDEX_NONE)
+		return Backend;
+
+	return static_cast<EMultiplayerSessionsBackendType>(BackendValue);
+}
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerSessionsStats.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Trace/Trace.inl"
+
+#define MULTIPLAYER_DECLARE_OPERATION_STATS(Operation) \
+	DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT(#Operation " p50 (ms)"), STAT_MultiplayerSessions_##Operation##_P50, STATGROUP_MultiplayerSessions); \
+	DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT(#Operation " p95 (ms)"), STAT_MultiplayerSessions_##Operation##_P95, STATGROUP_MultiplayerSessions); \
+	DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT(#Operation " p99 (ms)"), STAT_MultiplayerSessions_##Operation##_P99, STATGROUP_MultiplayerSessions); \
+	DECLARE_DWORD_ACCUMULATOR_STAT(TEXT(#Operation " succeeded"), STAT_MultiplayerSessions_##Operation##_Succeeded, STATGROUP_MultiplayerSessions); \
+	DECLARE_DWORD_ACCUMULATOR_STAT(TEXT(#Operation " failed"), STAT_MultiplayerSessions_##Operation##_Failed, STATGROUP_MultiplayerSessions);
+
+MULTIPLAYER_DECLARE_OPERATION_STATS(Create)
+MULTIPLAYER_DECLARE_OPERATION_STATS(Find)
+MULTIPLAYER_DECLARE_OPERATION_STATS(Join)
+MULTIPLAYER_DECLARE_OPERATION_STATS(Destroy)
+MULTIPLAYER_DECLARE_OPERATION_STATS(Start)
+MULTIPLAYER_DECLARE_OPERATION_STATS(Update)
+MULTIPLAYER_DECLARE_OPERATION_STATS(Travel)
+
+#undef MULTIPLAYER_DECLARE_OPERATION_STATS
+
+#if UE_TRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(MultiplayerSessionsChannel)
+
+UE_TRACE_EVENT_BEGIN(MultiplayerSessions, OperationCompleted)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(uint8, Operation)
+	UE_TRACE_EVENT_FIELD(bool, bSucceeded)
+UE_TRACE_EVENT_END()
+#endif
+
+namespace MultiplayerSessionsStats
+{
+	float GetPercentile(const TArray<float>& SortedDurationsMs, float Percentile)
+	{
+		if(SortedDurationsMs.IsEmpty())
+			return 0.f;
+
+		const int32 Index{ FMath::Clamp(FMath::CeilToInt(Percentile * SortedDurationsMs.Num()) - 1, 0, SortedDurationsMs.Num() - 1) };
+		return SortedDurationsMs[Index];
+	}
+}
+
+FMultiplayerSessionsLatencyTracker::FMultiplayerSessionsLatencyTracker()
+{
+	for (FOperationSamples& Samples : Operations)
+	{
+		Samples.DurationsMs.Reserve(MaxSamples);
+	}
+}
+
+void FMultiplayerSessionsLatencyTracker::Begin(EMultiplayerSessionOperation Type)
+{
+	FOperationSamples& Samples{ Operations[static_cast<int32>(Type)] };
+	if(Samples.StartCycles != 0)
+		return;
+
+	Samples.StartCycles = FPlatformTime::Cycles64();
+}
+
+void FMultiplayerSessionsLatencyTracker::End(EMultiplayerSessionOperation Type, bool bWasSuccessfull, const TCHAR* FailureReason /*= nullptr*/)
+{
+	FOperationSamples& Samples{ Operations[static_cast<int32>(Type)] };
+	if(Samples.StartCycles == 0)
+		return;
+
+	const uint64 StartCycles{ Samples.StartCycles };
+	const uint64 EndCycles{ FPlatformTime::Cycles64() };
+	Samples.StartCycles = 0;
+
+	const float DurationMs{ static_cast<float>(FPlatformTime::ToMilliseconds64(EndCycles - StartCycles)) };
+	if (Samples.DurationsMs.Num() < MaxSamples)
+	{
+		Samples.DurationsMs.Add(DurationMs);
+	}
+	else
+	{
+		Samples.DurationsMs[Samples.NextSample] = DurationMs;
+	}
+
+	Samples.NextSample = (Samples.NextSample + 1) % MaxSamples;
+
+	if (bWasSuccessfull)
+	{
+		++Samples.NumSucceeded;
+	}
+	else
+	{
+		++Samples.NumFailed;
+		++Samples.FailureReasons.FindOrAdd(FailureReason ? FailureReason : TEXT("Unknown"));
+	}
+
+#if UE_TRACE_ENABLED
+	UE_TRACE_LOG(MultiplayerSessions, OperationCompleted, MultiplayerSessionsChannel)
+		<< OperationCompleted.StartCycle(StartCycles)
+		<< OperationCompleted.EndCycle(EndCycles)
+		<< OperationCompleted.Operation(static_cast<uint8>(Type))
+		<< OperationCompleted.bSucceeded(bWasSuccessfull);
+#endif
+
+	TRACE_BOOKMARK(TEXT("MultiplayerSessions %s %s"), GetOperationName(Type), bWasSuccessfull ? TEXT("succeeded") : TEXT("failed"));
+
+	PublishStats(Type);
+}
+
+void FMultiplayerSessionsLatencyTracker::Discard(EMultiplayerSessionOperation Type)
+{
+	Operations[static_cast<int32>(Type)].StartCycles = 0;
+}
+
+bool FMultiplayerSessionsLatencyTracker::IsTiming(EMultiplayerSessionOperation Type) const
+{
+	return Operations[static_cast<int32>(Type)].StartCycles != 0;
+}
+
+FMultiplayerSessionsLatencyTracker::FOperationStats FMultiplayerSessionsLatencyTracker::GetStats(EMultiplayerSessionOperation Type) const
+{
+	const FOperationSamples& Samples{ Operations[static_cast<int32>(Type)] };
+
+	TArray<float> SortedDurationsMs{ Samples.DurationsMs };
+	SortedDurationsMs.Sort();
+
+	FOperationStats Stats;
+	Stats.NumSucceeded = Samples.NumSucceeded;
+	Stats.NumFailed = Samples.NumFailed;
+	Stats.P50Ms = MultiplayerSessionsStats::GetPercentile(SortedDurationsMs, 0.50f);
+	Stats.P95Ms = MultiplayerSessionsStats::GetPercentile(SortedDurationsMs, 0.95f);
+	Stats.P99Ms = MultiplayerSessionsStats::GetPercentile(SortedDurationsMs, 0.99f);
+	Stats.MaxMs = SortedDurationsMs.IsEmpty() ? 0.f : SortedDurationsMs.Last();
+	Stats.FailureReasons = Samples.FailureReasons;
+	return Stats;
+}
+
+FString FMultiplayerSessionsLatencyTracker::ToCsv() const
+{
+	FString Csv{ TEXT("Operation,Succeeded,Failed,P50Ms,P95Ms,P99Ms,MaxMs,FailureReasons\n") };
+
+	for (int32 OperationIndex{ 0 }; OperationIndex < NumOperations; ++OperationIndex)
+	{
+		const EMultiplayerSessionOperation Type{ static_cast<EMultiplayerSessionOperation>(OperationIndex) };
+		const FOperationStats Stats{ GetStats(Type) };
+
+		//Reason:Count pairs separated by ';' to keep them in one column
+		TArray<FString> FailureReasons;
+		for (const TPair<FString, int32>& FailureReason : Stats.FailureReasons)
+		{
+			FailureReasons.Add(FString::Printf(TEXT("%s:%d"), *FailureReason.Key, FailureReason.Value));
+		}
+
+		Csv += FString::Printf(TEXT("%s,%d,%d,%.2f,%.2f,%.2f,%.2f,%s\n"),
+			GetOperationName(Type),
+			Stats.NumSucceeded,
+			Stats.NumFailed,
+			Stats.P50Ms,
+			Stats.P95Ms,
+			Stats.P99Ms,
+			Stats.MaxMs,
+			*FString::Join(FailureReasons, TEXT(";")));
+	}
+
+	return Csv;
+}
+
+void FMultiplayerSessionsLatencyTracker::Reset()
+{
+	for (int32 OperationIndex{ 0 }; OperationIndex < NumOperations; ++OperationIndex)
+	{
+		FOperationSamples& Samples{ Operations[OperationIndex] };
+		Samples.DurationsMs.Reset();
+		Samples.NextSample = 0;
+		Samples.NumSucceeded = 0;
+		Samples.NumFailed = 0;
+		Samples.FailureReasons.Reset();
+		Samples.StartCycles = 0;
+
+		PublishStats(static_cast<EMultiplayerSessionOperation>(OperationIndex));
+	}
+}
+
+const TCHAR* FMultiplayerSessionsLatencyTracker::GetOperationName(EMultiplayerSessionOperation Type)
+{
+	switch (Type)
+	{
+	case EMultiplayerSessionOperation::Create:	return TEXT("Create");
+	case EMultiplayerSessionOperation::Find:	return TEXT("Find");
+	case EMultiplayerSessionOperation::Join:	return TEXT("Join");
+	case EMultiplayerSessionOperation::Destroy:	return TEXT("Destroy");
+	case EMultiplayerSessionOperation::Start:	return TEXT("Start");
+	case EMultiplayerSessionOperation::Update:	return TEXT("Update");
+	case EMultiplayerSessionOperation::Travel:	return TEXT("Travel");
+	default:									return TEXT("Unknown");
+	}
+}
+
+void FMultiplayerSessionsLatencyTracker::PublishStats(EMultiplayerSessionOperation Type) const
+{
+#if STATS
+	const FOperationStats Stats{ GetStats(Type) };
+
+#define MULTIPLAYER_SET_OPERATION_STATS(Operation) \
+	SET_FLOAT_STAT(STAT_MultiplayerSessions_##Operation##_P50, Stats.P50Ms); \
+	SET_FLOAT_STAT(STAT_MultiplayerSessions_##Operation##_P95, Stats.P95Ms); \
+	SET_FLOAT_STAT(STAT_MultiplayerSessions_##Operation##_P99, Stats.P99Ms); \
+	SET_DWORD_STAT(STAT_MultiplayerSessions_##Operation##_Succeeded, Stats.NumSucceeded); \
+	SET_DWORD_STAT(STAT_MultiplayerSessions_##Operation##_Failed, Stats.NumFailed);
+
+	switch (Type)
+	{
+	case EMultiplayerSessionOperation::Create:	MULTIPLAYER_SET_OPERATION_STATS(Create) break;
+	case EMultiplayerSessionOperation::Find:	MULTIPLAYER_SET_OPERATION_STATS(Find) break;
+	case EMultiplayerSessionOperation::Join:	MULTIPLAYER_SET_OPERATION_STATS(Join) break;
+	case EMultiplayerSessionOperation::Destroy:	MULTIPLAYER_SET_OPERATION_STATS(Destroy) break;
+	case EMultiplayerSessionOperation::Start:	MULTIPLAYER_SET_OPERATION_STATS(Start) break;
+	case EMultiplayerSessionOperation::Update:	MULTIPLAYER_SET_OPERATION_STATS(Update) break;
+	case EMultiplayerSessionOperation::Travel:	MULTIPLAYER_SET_OPERATION_STATS(Travel) break;
+	default: break;
+	}
+
+#undef MULTIPLAYER_SET_OPERATION_STATS
+#endif
+}
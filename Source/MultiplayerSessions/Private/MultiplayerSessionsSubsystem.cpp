@@ -7,366 +7,2959 @@
 #include "OnlineSubsystemUtils.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "Online/OnlineSessionNames.h"
+#include "Engine/Engine.h"
+#include "MultiplayerSessionsLog.h"
+#include "MultiplayerSessionsAttributes.h"
+#include "MultiplayerSessionsSettings.h"
+#include "MultiplayerSessionsReconnectRecord.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/Package.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "MultiplayerSessionsFakeBackend.h"
+#include "Misc/Parse.h"
+
+namespace MultiplayerSessionsAdmission
+{
+	static FString GetPlayerId(const FUniqueNetIdRepl& UniqueId)
+	{
+		return UniqueId.IsValid() ? UniqueId->ToString() : FString();
+	}
+
+	static FString GetPlayerId(const AController* Controller)
+	{
+		return Controller && Controller->PlayerState ? GetPlayerId(Controller->PlayerState->GetUniqueId()) : FString();
+	}
+}
+
+namespace MultiplayerSessionsAsync
+{
+	//Requests that return an invalid handle were turned down before they were queued
+	template<typename ResultType>
+	TFuture<ResultType> WaitForResult(TMultiplayerPendingResults<ResultType>& PendingResults, FMultiplayerOperationHandle Handle, FMultiplayerOperationHandle* OutHandle, ResultType&& NotQueuedResult = ResultType())
+	{
+		if (OutHandle)
+		{
+			*OutHandle = Handle;
+		}
+
+		if(!Handle.IsValid())
+			return MakeFulfilledPromise<ResultType>(MoveTemp(NotQueuedResult)).GetFuture();
+
+		return PendingResults.Add(Handle);
+	}
+
+	template<typename ResultType>
+	void Forward(TFuture<ResultType>&& Future, TSharedRef<TPromise<ResultType>> Promise)
+	{
+		Future.Next([Promise](const ResultType& Result) { Promise->SetValue(Result); });
+	}
+}
+
+namespace MultiplayerSessionsConsole
+{
+	static FAutoConsoleCommandWithWorldAndArgs DumpLatencyCsvCommand(
+		TEXT("MultiplayerSessions.DumpLatencyCsv"),
+		TEXT("Writes request to completion timings of all session operations as CSV. Optional argument: output file path"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+			UMultiplayerSessionsSubsystem* Subsystem{ GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr };
+			if(!Subsystem)
+				return;
+
+			const FString FilePath{ Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("MultiplayerSessions") / FString::Printf(TEXT("Latency-%s.csv"), *FDateTime::Now().ToString()) };
+			if (FFileHelper::SaveStringToFile(Subsystem->GetLatencyTracker().ToCsv(), *FilePath))
+			{
+				UE_LOG(LogMultiplayerSessions, Display, TEXT("Latency written to %s"), *FilePath);
+			}
+		}));
+
+#if !UE_BUILD_SHIPPING
+	static FAutoConsoleCommandWithWorldAndArgs HostDedicatedCommand(
+		TEXT("MultiplayerSessions.HostDedicated"),
+		TEXT("Registers this server as a dedicated session. Slots= MatchType= MatchName=, Fake hosts it on the in-process fake backend"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+			UMultiplayerSessionsSubsystem* Subsystem{ GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr };
+			if(!Subsystem)
+				return;
+
+			const FString Params{ FString::Join(Args, TEXT(" ")) };
+
+			FMultiplayerMatchSettings MatchSettings;
+			FParse::Value(*Params, TEXT("Slots="), MatchSettings.PublicConnections);
+			FParse::Value(*Params, TEXT("MatchType="), MatchSettings.MatchType);
+			FParse::Value(*Params, TEXT("MatchName="), MatchSettings.MatchName);
+
+			if (Args.ContainsByPredicate([](const FString& Arg) { return Arg.Equals(TEXT("Fake"), ESearchCase::IgnoreCase); }))
+			{
+				Subsystem->SetSessionBackend(MakeShared<FMultiplayerSessionsFakeBackend>());
+			}
+
+			Subsystem->HostDedicatedSession(MatchSettings);
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs LanListenCommand(
+		TEXT("MultiplayerSessions.LanListen"),
+		TEXT("Keeps a live list of LAN hosts and logs it whenever it changes, Stop ends it. Needs the Lan backend"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance{ World ? World->GetGameInstance() : nullptr };
+			UMultiplayerSessionsSubsystem* Subsystem{ GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr };
+			TSharedPtr<FMultiplayerSessionsLanBackend> LanBackend{ Subsystem ? Subsystem->GetLanBackend() : nullptr };
+			if (!LanBackend.IsValid())
+			{
+				UE_LOG(LogMultiplayerSessions, Warning, TEXT("Not using the Lan session backend, start with -MultiplayerSessionsBackend=Lan"));
+				return;
+			}
+
+			static FDelegateHandle HostsChangedDelegate_Handle;
+			LanBackend->OnHostsChanged().Remove(HostsChangedDelegate_Handle);
+
+			if (Args.Num() > 0 && Args[0].Equals(TEXT("Stop"), ESearchCase::IgnoreCase))
+			{
+				LanBackend->StopListening();
+				return;
+			}
+
+			TWeakPtr<FMultiplayerSessionsLanBackend> WeakLanBackend{ LanBackend };
+			HostsChangedDelegate_Handle = LanBackend->OnHostsChanged().AddLambda([WeakLanBackend]()
+			{
+				TSharedPtr<FMultiplayerSessionsLanBackend> PinnedLanBackend{ WeakLanBackend.Pin() };
+				if(!PinnedLanBackend.IsValid())
+					return;
+
+				UE_LOG(LogMultiplayerSessions, Display, TEXT("%d LAN hosts"), PinnedLanBackend->GetHosts().Num());
+				for (const TPair<FString, FMultiplayerLanHost>& Host : PinnedLanBackend->GetHosts())
+				{
+					UE_LOG(LogMultiplayerSessions, Display, TEXT("  %s at %s, %d ms, %d/%d open"), *Host.Key, *Host.Value.Address, Host.Value.PingInMs,
+						Host.Value.Session.NumOpenPublicConnections, Host.Value.Session.SessionSettings.NumPublicConnections);
+				}
+			});
+
+			LanBackend->StartListening();
+		}));
+#endif
+}
+
+UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
+	CreateSessionCompleteDelegate{ FOnCreateSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnCreateSessionComplete) },
+	FindSessionsCompleteDelegate{ FOnFindSessionsCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnFindSessionsComplete) },
+	JoinSessionCompleteDelegate{ FOnJoinSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnJoinSessionComplete) },
+	DestroySessionCompleteDelegate{ FOnDestroySessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnDestroySessionComplete) },
+	StartSessionCompleteDelegate{ FOnStartSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnStartSessionComplete)},
+	UpdateSessionCompleteDelegate{ FOnUpdateSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnUpdateSessionComplete) },
+	FindSessionByIdCompleteDelegate{ FOnFindSessionByIdCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnFindSessionByIdComplete) }
+{
+	LatencyProber = MakeShared<FMultiplayerSessionsUdpEchoProber>();
+}
+
+void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapDelegate_Handle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UMultiplayerSessionsSubsystem::OnPostLoadMap);
+
+	if (GEngine)
+	{
+		TravelFailureDelegate_Handle = GEngine->OnTravelFailure().AddUObject(this, &UMultiplayerSessionsSubsystem::OnTravelFailure);
+		NetworkFailureDelegate_Handle = GEngine->OnNetworkFailure().AddUObject(this, &UMultiplayerSessionsSubsystem::OnNetworkFailure);
+	}
+
+	GameModePreLoginDelegate_Handle = FGameModeEvents::GameModePreLoginEvent.AddUObject(this, &UMultiplayerSessionsSubsystem::OnGameModePreLogin);
+	GameModePostLoginDelegate_Handle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &UMultiplayerSessionsSubsystem::OnGameModePostLogin);
+	GameModeLogoutDelegate_Handle = FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &UMultiplayerSessionsSubsystem::OnGameModeLogout);
+
+	BuildSessionPresets();
+
+	MultiplayerOnCreateSessionComplete.AddDynamic(this, &UMultiplayerSessionsSubsystem::ResolveCreateSession);
+	MultiplayerOnDestroySessionComplete.AddDynamic(this, &UMultiplayerSessionsSubsystem::ResolveDestroySession);
+	MultiplayerOnStartSessionComplete.AddDynamic(this, &UMultiplayerSessionsSubsystem::ResolveStartSession);
+	MultiplayerOnUpdateSessionComplete.AddDynamic(this, &UMultiplayerSessionsSubsystem::ResolveUpdateSession);
+	MultiplayerOnFindSessionComplete.AddUObject(this, &UMultiplayerSessionsSubsystem::ResolveFindSessions);
+	MultiplayerOnFindBestSessionComplete.AddUObject(this, &UMultiplayerSessionsSubsystem::ResolveFindBestSession);
+	MultiplayerOnJoinSessionComplete.AddUObject(this, &UMultiplayerSessionsSubsystem::ResolveJoinSession);
+
+	UGameplayStatics::AsyncLoadGameFromSlot(UMultiplayerSessionsReconnectRecord::SlotName, 0, FAsyncLoadGameFromSlotDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnReconnectRecordLoaded));
+
+	OperationQueue.SetOnDropped([this](FMultiplayerOperationHandle Handle, EMultiplayerSessionOperation Type, EMultiplayerOperationAbortReason Reason, bool bWasStarted)
+	{
+		OnOperationDropped(Handle, Type, Reason, bWasStarted);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapDelegate_Handle);
+
+	if (GEngine)
+	{
+		GEngine->OnTravelFailure().Remove(TravelFailureDelegate_Handle);
+		GEngine->OnNetworkFailure().Remove(NetworkFailureDelegate_Handle);
+	}
+
+	FGameModeEvents::GameModePreLoginEvent.Remove(GameModePreLoginDelegate_Handle);
+	FGameModeEvents::GameModePostLoginEvent.Remove(GameModePostLoginDelegate_Handle);
+	FGameModeEvents::GameModeLogoutEvent.Remove(GameModeLogoutDelegate_Handle);
+	StopAdmission();
+
+	OperationQueue.Reset();
+	StopSearchStream();
+	StopResultsProcessing();
+	CancelPendingResults();
+
+	//Nobody is left to hear back, but the backend still takes the server off the list
+	if (IsHostingDedicated())
+	{
+		StopDedicatedHeartbeat();
+		DedicatedSessionSettings.Reset();
+
+		if (SessionBackend.IsValid() && SessionBackend->GetNamedSession(NAME_GameSession))
+		{
+			MULTIPLAYER_LOG(Log, TEXT("Deregistering dedicated session"));
+			SessionBackend->DestroySession(NAME_GameSession);
+		}
+	}
+
+	if (RefreshTicker_Handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(RefreshTicker_Handle);
+		RefreshTicker_Handle.Reset();
+	}
+
+	if (LatencyProber.IsValid())
+	{
+		LatencyProber->CancelProbe();
+	}
+
+	StopLatencyEchoServer();
+
+	Super::Deinitialize();
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType)
+{
+	FMultiplayerMatchSettings MatchSettings;
+	MatchSettings.PublicConnections = NumPublicConnections;
+	MatchSettings.MatchType = MatchType;
+
+	return CreateSession(MatchSettings);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::CreateSession(const FMultiplayerMatchSettings& InMatchSettings, FName SessionName /*= NAME_GameSession*/)
+{
+	return EnqueueCreateSession(MakeSessionSettings(InMatchSettings), SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::CreateSession(FName PresetName, FName SessionName /*= NAME_GameSession*/)
+{
+	const TSharedRef<const FOnlineSessionSettings>* SessionSettings{ SessionPresets.Find(PresetName) };
+	if (!SessionSettings)
+	{
+		MULTIPLAYER_LOG(Error, TEXT("Failed to create session, no preset named %s"), *PresetName.ToString());
+		return FMultiplayerOperationHandle();
+	}
+
+	return EnqueueCreateSession(*SessionSettings, SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::EnqueueCreateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName)
+{
+	YieldRefreshSearch();
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Create);
+
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Create,
+		[this, InSessionSettings, SessionName]() { return ExecuteCreateSession(InSessionSettings, SessionName); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortCreateSession(Reason); },
+		CreateSessionTimeout,
+		false,
+		SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::UpdateSession(FName PresetName, FName SessionName /*= NAME_GameSession*/)
+{
+	const TSharedRef<const FOnlineSessionSettings>* SessionSettings{ SessionPresets.Find(PresetName) };
+	if (!SessionSettings)
+	{
+		MULTIPLAYER_LOG(Error, TEXT("Failed to update session, no preset named %s"), *PresetName.ToString());
+		return FMultiplayerOperationHandle();
+	}
+
+	return EnqueueUpdateSession(*SessionSettings, SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::UpdateSession(const FMultiplayerMatchSettings& InMatchSettings, FName SessionName /*= NAME_GameSession*/)
+{
+	return EnqueueUpdateSession(MakeSessionSettings(InMatchSettings), SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::EnqueueUpdateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName)
+{
+	YieldRefreshSearch();
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Update);
+
+	//Only the latest settings matter, a waiting update of the same session is replaced by a newer one
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Update,
+		[this, InSessionSettings, SessionName]() { return ExecuteUpdateSession(InSessionSettings, SessionName); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortUpdateSession(Reason); },
+		UpdateSessionTimeout,
+		false,
+		SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults, int32 BatchSize /*= 0*/)
+{
+	FMultiplayerSearchSettings SearchSettings;
+	SearchSettings.MaxSearchResults = MaxSearchResults;
+	SearchSettings.BatchSize = BatchSize;
+
+	return FindSessions(SearchSettings);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::FindSessions(const FMultiplayerSearchSettings& InSearchSettings)
+{
+	//Cache hits are not timed, the Find latency stays a measure of the backend
+	if (InSearchSettings.MaxCacheAge > 0.f && IsSearchCacheFresh(InSearchSettings, InSearchSettings.MaxCacheAge))
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("Serving %d sessions from a search %.1f s ago"), LastSessionSearch->SearchResults.Num(), FPlatformTime::Seconds() - LastSearchCompletedTime);
+
+		//Revalidate as soon as the player is done with the results
+		NextRefreshTime = 0.0;
+		MultiplayerOnFindSessionComplete.Broadcast(LastSessionSearch->SearchResults, true);
+		return FMultiplayerOperationHandle();
+	}
+
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Find);
+
+	//Whoever searched before wants the new results now, the running search is cancelled
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Find,
+		[this, InSearchSettings]() { return ExecuteFindSessions(InSearchSettings); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortFindSessions(Reason); },
+		FindSessionsTimeout,
+		true);
+}
+
+void UMultiplayerSessionsSubsystem::CancelFindSessions()
+{
+	OperationQueue.CancelType(EMultiplayerSessionOperation::Find, true);
+}
+
+void UMultiplayerSessionsSubsystem::FindBestSession(const FString& InMatchType, int32 NumCandidates /*= 8*/)
+{
+	//Whoever waits for a probe that is still running gets nothing
+	DropFindBestResults();
+	ProbeBestSessions(InMatchType, NumCandidates);
+}
+
+void UMultiplayerSessionsSubsystem::ProbeBestSessions(const FString& InMatchType, int32 NumCandidates)
+{
+	LatencyProber->CancelProbe();
+	ProbeCandidates.Reset();
+	RankedSessions.Reset();
+
+	if (!ResolveSessionBackend() || NumCandidates <= 0)
+	{
+		MultiplayerOnFindBestSessionComplete.Broadcast(RankedSessions, false);
+		return;
+	}
+
+	FMultiplayerScoringQuery Query{ ScoringQuery };
+	Query.MatchType = InMatchType;
+	ProbeCandidates = ScoreSessions(Query, NumCandidates);
+
+	TArray<FMultiplayerLatencyProbeTarget> ProbeTargets;
+	ProbeTargets.Reserve(ProbeCandidates.Num());
+
+	for (const FMultiplayerRankedSession& Candidate : ProbeCandidates)
+	{
+		FMultiplayerLatencyProbeTarget& ProbeTarget{ ProbeTargets.AddDefaulted_GetRef() };
+		ProbeTarget.ResultIndex = Candidate.ResultIndex;
+		ProbeTarget.ReportedPingInMs = Candidate.RttInMs;
+
+		if (const FOnlineSessionSearchResult* SearchResult{ GetSearchResult(Candidate.ResultIndex) })
+		{
+			SessionBackend->GetResolvedConnectString(*SearchResult, NAME_GamePort, ProbeTarget.Address);
+			ProbeTarget.EchoPort = MultiplayerSessionAttributes::LatencyEchoPort.Read(SearchResult->Session.SessionSettings);
+		}
+	}
+
+	if (ProbeTargets.IsEmpty())
+	{
+		MultiplayerOnFindBestSessionComplete.Broadcast(RankedSessions, false);
+		return;
+	}
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Probing latency of %d sessions"), ProbeTargets.Num());
+
+	LatencyProber->ProbeAsync(ProbeTargets, LatencyProbeTimeout, FOnMultiplayerLatencyProbeComplete::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnLatencyProbeComplete));
+}
+
+TArray<FMultiplayerRankedSession> UMultiplayerSessionsSubsystem::ScoreSessions(const FMultiplayerScoringQuery& Query, int32 NumResults, const UMultiplayerSessionsScoringProfile* Profile /*= nullptr*/)
+{
+	TArray<FMultiplayerRankedSession> ScoredSessions;
+
+	//Nothing of that match type was found
+	const uint16 MatchTypeId{ SearchCache.FindMatchTypeId(Query.MatchType) };
+	if(!Query.MatchType.IsEmpty() && MatchTypeId == 0)
+		return ScoredSessions;
+
+	SearchCache.GetScoringTable().Score(GetScoringWeights(Profile), Query, MatchTypeId, NumResults, ScoredSessions);
+	return ScoredSessions;
+}
+
+const FMultiplayerScoringWeights& UMultiplayerSessionsSubsystem::GetScoringWeights(const UMultiplayerSessionsScoringProfile* Profile)
+{
+	static const FMultiplayerScoringWeights DefaultWeights;
+
+	if(Profile)
+		return Profile->Weights;
+
+	//Loaded once on first use, matchmaking may never be needed at all
+	if (!bDefaultScoringProfileLoaded)
+	{
+		bDefaultScoringProfileLoaded = true;
+
+		const TSoftObjectPtr<UMultiplayerSessionsScoringProfile>& ScoringProfile{ GetDefault<UMultiplayerSessionsSettings>()->ScoringProfile };
+		if (!ScoringProfile.IsNull())
+		{
+			DefaultScoringProfile = ScoringProfile.LoadSynchronous();
+			if (!DefaultScoringProfile)
+			{
+				MULTIPLAYER_LOG(Error, TEXT("Failed to load scoring profile %s, using the built in weights"), *ScoringProfile.ToString());
+			}
+		}
+	}
+
+	return DefaultScoringProfile ? DefaultScoringProfile->Weights : DefaultWeights;
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& FindSessionsResult, FName SessionName /*= NAME_GameSession*/)
+{
+	YieldRefreshSearch();
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Join);
+
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Join,
+		[this, FindSessionsResult, SessionName]() { return ExecuteJoinSession(FindSessionsResult, SessionName); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortJoinSession(Reason); },
+		JoinSessionTimeout,
+		false,
+		SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::JoinSession(const FString& InSessionId, FName SessionName /*= NAME_GameSession*/)
+{
+	MULTIPLAYER_LOG(Verbose, TEXT("Trying to join using session id %s"), *InSessionId);
+
+	const int32 ResultIndex{ SearchCache.FindById(InSessionId) };
+	if (ResultIndex == INDEX_NONE)
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("Failed to join using session id %s, not found on search list"), *InSessionId);
+		return FMultiplayerOperationHandle();
+	}
+
+	if (SearchCache.IsTrimmed(ResultIndex))
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("Failed to join using session id %s, its search result was trimmed, use JoinSessionByIdAsync"), *InSessionId);
+		return FMultiplayerOperationHandle();
+	}
+
+	//Goes through the candidate path so a failed join marks the result stale
+	return JoinAnySession(TArray<int32>{ ResultIndex }, SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::JoinAnySession(const TArray<FMultiplayerRankedSession>& InRankedSessions, FName SessionName /*= NAME_GameSession*/)
+{
+	TArray<int32> CandidateResultIndices;
+	CandidateResultIndices.Reserve(InRankedSessions.Num());
+
+	for (const FMultiplayerRankedSession& RankedSession : InRankedSessions)
+	{
+		CandidateResultIndices.Add(RankedSession.ResultIndex);
+	}
+
+	return JoinAnySession(CandidateResultIndices, SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::JoinAnySession(const TArray<int32>& InCandidateResultIndices, FName SessionName /*= NAME_GameSession*/)
+{
+	//The indices only mean something for the search they came from
+	TSharedPtr<FOnlineSessionSearch> CandidateSearch{ LastSessionSearch };
+
+	YieldRefreshSearch();
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Join);
+
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Join,
+		[this, InCandidateResultIndices, CandidateSearch, SessionName]() { return ExecuteJoinAnySession(InCandidateResultIndices, CandidateSearch, SessionName); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortJoinSession(Reason); },
+		JoinSessionTimeout,
+		false,
+		SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::DestroySession(FName SessionName /*= NAME_GameSession*/)
+{
+	YieldRefreshSearch();
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Destroy);
+
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Destroy,
+		[this, SessionName]() { return ExecuteDestroySession(SessionName); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortDestroySession(Reason); },
+		DestroySessionTimeout,
+		false,
+		SessionName);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::StartSession(FName SessionName /*= NAME_GameSession*/)
+{
+	YieldRefreshSearch();
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Start);
+
+	return OperationQueue.Enqueue(EMultiplayerSessionOperation::Start,
+		[this, SessionName]() { return ExecuteStartSession(SessionName); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortStartSession(Reason); },
+		StartSessionTimeout,
+		false,
+		SessionName);
+}
+
+bool UMultiplayerSessionsSubsystem::CancelOperation(FMultiplayerOperationHandle Handle)
+{
+	//Only a search can be taken back once the backend is working on it
+	const bool bAllowActive{ OperationQueue.IsActive(EMultiplayerSessionOperation::Find) };
+	return OperationQueue.Cancel(Handle, bAllowActive);
+}
+
+TFuture<FMultiplayerSessionResult> UMultiplayerSessionsSubsystem::CreateSessionAsync(const FMultiplayerMatchSettings& InMatchSettings, FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	return MultiplayerSessionsAsync::WaitForResult(PendingCreateResults, CreateSession(InMatchSettings, SessionName), OutHandle);
+}
+
+TFuture<FMultiplayerSessionResult> UMultiplayerSessionsSubsystem::CreateSessionAsync(FName PresetName, FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	return MultiplayerSessionsAsync::WaitForResult(PendingCreateResults, CreateSession(PresetName, SessionName), OutHandle);
+}
+
+TFuture<FMultiplayerSessionResult> UMultiplayerSessionsSubsystem::UpdateSessionAsync(FName PresetName, FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	return MultiplayerSessionsAsync::WaitForResult(PendingUpdateResults, UpdateSession(PresetName, SessionName), OutHandle);
+}
+
+TFuture<FMultiplayerFindSessionsResult> UMultiplayerSessionsSubsystem::FindSessionsAsync(const FMultiplayerSearchSettings& InSearchSettings, FMultiplayerOperationHandle* OutHandle /*= nullptr*/)
+{
+	const FMultiplayerOperationHandle Handle{ FindSessions(InSearchSettings) };
+
+	//Not queued means it was answered from the cache
+	FMultiplayerFindSessionsResult CachedResult;
+	CachedResult.Search = LastSessionSearch;
+	CachedResult.bWasSuccessfull = LastSessionSearch.IsValid() && !LastSessionSearch->SearchResults.IsEmpty();
+
+	return MultiplayerSessionsAsync::WaitForResult(PendingFindResults, Handle, OutHandle, MoveTemp(CachedResult));
+}
+
+TFuture<FMultiplayerFindBestSessionResult> UMultiplayerSessionsSubsystem::FindBestSessionAsync(const FString& InMatchType, int32 NumCandidates /*= 8*/)
+{
+	DropFindBestResults();
+
+	TFuture<FMultiplayerFindBestSessionResult> Future{ PendingFindBestResults.Emplace_GetRef().GetFuture() };
+	ProbeBestSessions(InMatchType, NumCandidates);
+	return Future;
+}
+
+TFuture<FMultiplayerJoinSessionResult> UMultiplayerSessionsSubsystem::JoinSessionAsync(const FString& InSessionId, FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	FMultiplayerJoinSessionResult NotFoundResult;
+	NotFoundResult.SessionName = SessionName;
+	NotFoundResult.Result = EOnJoinSessionCompleteResult::SessionDoesNotExist;
+
+	return MultiplayerSessionsAsync::WaitForResult(PendingJoinResults, JoinSession(InSessionId, SessionName), OutHandle, MoveTemp(NotFoundResult));
+}
+
+TFuture<FMultiplayerJoinSessionResult> UMultiplayerSessionsSubsystem::JoinAnySessionAsync(const TArray<int32>& InCandidateResultIndices, FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	return MultiplayerSessionsAsync::WaitForResult(PendingJoinResults, JoinAnySession(InCandidateResultIndices, SessionName), OutHandle);
+}
+
+TFuture<FMultiplayerSessionResult> UMultiplayerSessionsSubsystem::DestroySessionAsync(FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	return MultiplayerSessionsAsync::WaitForResult(PendingDestroyResults, DestroySession(SessionName), OutHandle);
+}
+
+TFuture<FMultiplayerSessionResult> UMultiplayerSessionsSubsystem::StartSessionAsync(FMultiplayerOperationHandle* OutHandle /*= nullptr*/, FName SessionName /*= NAME_GameSession*/)
+{
+	return MultiplayerSessionsAsync::WaitForResult(PendingStartResults, StartSession(SessionName), OutHandle);
+}
+
+TFuture<FMultiplayerJoinSessionResult> UMultiplayerSessionsSubsystem::JoinSessionByIdAsync(const FString& InSessionId, const FString& InMatchType, FName SessionName /*= NAME_GameSession*/)
+{
+	//Found by the last search, no need to ask anyone
+	const int32 ResultIndex{ SearchCache.FindById(InSessionId) };
+	if(ResultIndex != INDEX_NONE && !SearchCache.IsStale(ResultIndex) && !SearchCache.IsTrimmed(ResultIndex))
+		return JoinAnySessionAsync(TArray<int32>{ ResultIndex }, nullptr, SessionName);
+
+	const TSharedRef<TPromise<FMultiplayerJoinSessionResult>> Promise{ MakeShared<TPromise<FMultiplayerJoinSessionResult>>() };
+	TFuture<FMultiplayerJoinSessionResult> Future{ Promise->GetFuture() };
+
+	FMultiplayerJoinSessionResult NotFoundResult;
+	NotFoundResult.SessionName = SessionName;
+	NotFoundResult.Result = EOnJoinSessionCompleteResult::SessionDoesNotExist;
+
+	const TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis{ this };
+
+	TFuture<TOptional<FOnlineSessionSearchResult>> Lookup{ FindSessionByIdAsync(InSessionId) };
+	if (Lookup.IsValid())
+	{
+		Lookup.Next([WeakThis, Promise, NotFoundResult, SessionName](const TOptional<FOnlineSessionSearchResult>& SearchResult)
+		{
+			UMultiplayerSessionsSubsystem* Subsystem{ WeakThis.Get() };
+			if (!Subsystem || !SearchResult.IsSet())
+			{
+				Promise->SetValue(NotFoundResult);
+				return;
+			}
+
+			MultiplayerSessionsAsync::Forward(MultiplayerSessionsAsync::WaitForResult(Subsystem->PendingJoinResults, Subsystem->JoinSession(SearchResult.GetValue(), SessionName), nullptr), Promise);
+		});
+
+		return Future;
+	}
+
+	//The backend can't look up single sessions, only the match type can be filtered on, the id is picked out of the results
+	MULTIPLAYER_LOG(Verbose, TEXT("Searching for session %s"), *InSessionId);
+
+	FMultiplayerSearchSettings SearchSettings;
+	SearchSettings.MatchType = InMatchType;
+	SearchSettings.MinOpenSlots = 1;
+
+	FindSessionsAsync(SearchSettings).Next([WeakThis, Promise, NotFoundResult, InSessionId, SessionName](const FMultiplayerFindSessionsResult& FindResult)
+	{
+		UMultiplayerSessionsSubsystem* Subsystem{ WeakThis.Get() };
+		const int32 ResultIndex{ Subsystem ? Subsystem->SearchCache.FindById(InSessionId) : INDEX_NONE };
+		if (ResultIndex == INDEX_NONE)
+		{
+			Promise->SetValue(NotFoundResult);
+			return;
+		}
+
+		MultiplayerSessionsAsync::Forward(Subsystem->JoinAnySessionAsync(TArray<int32>{ ResultIndex }, nullptr, SessionName), Promise);
+	});
+
+	return Future;
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::ShareGameSessionWithParty()
+{
+	if(!ResolveSessionBackend())
+		return FMultiplayerOperationHandle();
+
+	const FNamedOnlineSession* PartySession{ SessionBackend->GetNamedSession(NAME_PartySession) };
+	const FNamedOnlineSession* GameSession{ SessionBackend->GetNamedSession(NAME_GameSession) };
+	if (!PartySession || !PartySession->bHosting || !GameSession || !GameSession->SessionInfo.IsValid())
+	{
+		MULTIPLAYER_LOG(Error, TEXT("Failed to share the game session, needs to lead a party and be in a game session"));
+		return FMultiplayerOperationHandle();
+	}
+
+	const FString MatchType{ MultiplayerSessionAttributes::MatchType.Read(GameSession->SessionSettings) };
+
+	//Members only read it, nobody searches parties by it
+	const TSharedRef<FOnlineSessionSettings> PartySettings{ MakeShared<FOnlineSessionSettings>(PartySession->SessionSettings) };
+	MultiplayerSessionAttributes::PartyGameSessionId.Write(*PartySettings, GameSession->GetSessionIdStr());
+	MultiplayerSessionAttributes::PartyGameMatchType.Write(*PartySettings, MatchType);
+
+	return EnqueueUpdateSession(PartySettings, NAME_PartySession);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::HostDedicatedSession(const FMultiplayerMatchSettings& InMatchSettings)
+{
+	return StartDedicatedHosting(*MakeSessionSettings(InMatchSettings));
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::HostDedicatedSession(FName PresetName)
+{
+	const TSharedRef<const FOnlineSessionSettings>* SessionSettings{ SessionPresets.Find(PresetName) };
+	if (!SessionSettings)
+	{
+		MULTIPLAYER_LOG(Error, TEXT("Failed to host dedicated session, no preset named %s"), *PresetName.ToString());
+		return FMultiplayerOperationHandle();
+	}
+
+	return StartDedicatedHosting(**SessionSettings);
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::StopDedicatedHosting()
+{
+	if(!IsHostingDedicated())
+		return FMultiplayerOperationHandle();
+
+	StopDedicatedHeartbeat();
+	DedicatedSessionSettings.Reset();
+	bDedicatedSessionDirty = false;
+
+	return DestroySession(NAME_GameSession);
+}
+
+void UMultiplayerSessionsSubsystem::SetDedicatedSessionAttribute(FName Key, const FString& Value)
+{
+	if(!IsHostingDedicated())
+		return;
+
+	FString CurrentValue;
+	if(DedicatedSessionSettings->Get(Key, CurrentValue) && CurrentValue == Value)
+		return;
+
+	DedicatedSessionSettings->Set(Key, Value, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	bDedicatedSessionDirty = true;
+}
+
+bool UMultiplayerSessionsSubsystem::FollowPartyLeader()
+{
+	if(!ResolveSessionBackend())
+		return false;
+
+	const FNamedOnlineSession* PartySession{ SessionBackend->GetNamedSession(NAME_PartySession) };
+	FString GameSessionId;
+	if(!PartySession || !MultiplayerSessionAttributes::PartyGameSessionId.TryRead(PartySession->SessionSettings, GameSessionId) || GameSessionId.IsEmpty())
+		return false;
+
+	FString MatchType;
+	MultiplayerSessionAttributes::PartyGameMatchType.TryRead(PartySession->SessionSettings, MatchType);
+
+	MULTIPLAYER_LOG(Log, TEXT("Following the party leader to session %s"), *GameSessionId);
+
+	JoinSessionByIdAsync(GameSessionId, MatchType).Next([WeakThis = TWeakObjectPtr<UMultiplayerSessionsSubsystem>(this)](const FMultiplayerJoinSessionResult& JoinResult)
+	{
+		UMultiplayerSessionsSubsystem* Subsystem{ WeakThis.Get() };
+		if(!Subsystem)
+			return;
+
+		UGameInstance* GameInstance{ Subsystem->GetGameInstance() };
+		const bool bWasSuccessfull{ JoinResult.WasSuccessfull() && GameInstance && Subsystem->TravelToSession(GameInstance->GetFirstLocalPlayerController()) };
+		if (!bWasSuccessfull)
+		{
+			MULTIPLAYER_LOG(Error, TEXT("Failed to follow the party leader"));
+		}
+
+		Subsystem->MultiplayerOnFollowPartyLeaderComplete.Broadcast(bWasSuccessfull);
+	});
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::TravelToSession(APlayerController* PlayerController)
+{
+	if(!PlayerController)
+		return false;
+
+	const FString SessionAddress{ GetSessionAddress() };
+	if(SessionAddress.IsEmpty())
+		return false;
+
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Travel);
+	PlayerController->ClientTravel(SessionAddress, ETravelType::TRAVEL_Absolute);
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::PreloadMap(const FString& MapPackageName)
+{
+	const FName PackageName{ *MapPackageName };
+	if(PackageName.IsNone() || PackageName == PreloadingMapName)
+		return;
+
+	const UWorld* World{ GetWorld() };
+	if(World && World->IsPlayInEditor())
+		return;
+
+	ReleasePreloadedMap();
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Preloading %s"), *MapPackageName);
+
+	PreloadingMapName = PackageName;
+	PreloadStartTime = FPlatformTime::Seconds();
+	LoadPackageAsync(MapPackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnMapPreloaded));
+}
+
+void UMultiplayerSessionsSubsystem::ReleasePreloadedMap()
+{
+	//A load still in flight finishes on its own, OnMapPreloaded drops it
+	PreloadingMapName = NAME_None;
+	PreloadedMapPackage = nullptr;
+	PreloadedWorld = nullptr;
+}
+
+bool UMultiplayerSessionsSubsystem::IsMapPreloaded(const FString& MapPackageName) const
+{
+	return PreloadedWorld && PreloadingMapName == FName(*MapPackageName);
+}
+
+bool UMultiplayerSessionsSubsystem::ReconnectToLastSession(APlayerController* PlayerController)
+{
+	if(!PlayerController || ReconnectStage != EMultiplayerReconnectStage::None)
+		return false;
+
+	//Asked for before the slot finished loading, OnReconnectRecordLoaded goes on from there instead of reading it again on the game thread
+	if (!ReconnectRecord && !bReconnectRecordLoaded)
+	{
+		MULTIPLAYER_LOG(Log, TEXT("Reconnect record is still loading, reconnecting once it is there"));
+
+		ReconnectStage = EMultiplayerReconnectStage::Loading;
+		ReconnectPlayerController = PlayerController;
+		return true;
+	}
+
+	return StartDirectReconnect(PlayerController);
+}
+
+bool UMultiplayerSessionsSubsystem::StartDirectReconnect(APlayerController* PlayerController)
+{
+	if(!PlayerController || !HasReconnectRecord())
+		return false;
+
+	MULTIPLAYER_LOG(Log, TEXT("Reconnecting to %s"), *ReconnectRecord->SessionAddress);
+
+	ReconnectStage = EMultiplayerReconnectStage::Direct;
+
+	LatencyTracker.Begin(EMultiplayerSessionOperation::Travel);
+	PlayerController->ClientTravel(ReconnectRecord->SessionAddress, ETravelType::TRAVEL_Absolute);
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::HasReconnectRecord() const
+{
+	return ReconnectRecord && ReconnectRecord->IsValidFor(FTimespan::FromSeconds(MaxReconnectAge));
+}
+
+void UMultiplayerSessionsSubsystem::ClearReconnectRecord()
+{
+	if(!ReconnectRecord && !UGameplayStatics::DoesSaveGameExist(UMultiplayerSessionsReconnectRecord::SlotName, 0))
+		return;
+
+	ReconnectRecord = nullptr;
+	UGameplayStatics::DeleteGameInSlot(UMultiplayerSessionsReconnectRecord::SlotName, 0);
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteCreateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName)
+{
+	PendingCreateResults.SetRunning(OperationQueue.GetActiveHandle());
+	OperationSessionName = SessionName;
+
+	if (!ResolveSessionBackend())
+	{
+		// Broadcast failed
+		LatencyTracker.End(EMultiplayerSessionOperation::Create, false, TEXT("NoSessionBackend"));
+		MultiplayerOnCreateSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	FMultiplayerNamedSessionState& SessionState{ SessionStates.FindOrAdd(SessionName) };
+	SessionState.LastSessionSettings = InSessionSettings;
+
+	//Only known once the backend is, and the backend may have been swapped since the settings were made
+	const bool bIsLanMatch{ GetIsLanMatch() };
+	//Only advertised while something answers on it
+	const int32 LatencyEchoPort{ SessionName == NAME_GameSession ? StartLatencyEchoServer() : 0 };
+	if (InSessionSettings->bIsLANMatch != bIsLanMatch || MultiplayerSessionAttributes::LatencyEchoPort.Read(*InSessionSettings) != LatencyEchoPort)
+	{
+		TSharedRef<FOnlineSessionSettings> HostSessionSettings{ MakeShared<FOnlineSessionSettings>(*InSessionSettings) };
+		HostSessionSettings->bIsLANMatch = bIsLanMatch;
+		MultiplayerSessionAttributes::LatencyEchoPort.Write(*HostSessionSettings, LatencyEchoPort);
+		SessionState.LastSessionSettings = HostSessionSettings;
+	}
+
+	//Get rid of the old session first, OnDestroySessionComplete picks up from there
+	auto ExistingSession = SessionBackend->GetNamedSession(SessionName);
+	if (ExistingSession)
+	{
+		SessionState.bCreateSessionOnDestroy = true;
+		if (StartDestroySession(SessionName))
+			return true;
+
+		SessionState.bCreateSessionOnDestroy = false;
+		LatencyTracker.End(EMultiplayerSessionOperation::Create, false, TEXT("DestroyNotStarted"));
+		MultiplayerOnCreateSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	if (StartCreateSession(SessionName))
+		return true;
+
+	// Broadcast our own custom delegate
+	LatencyTracker.End(EMultiplayerSessionOperation::Create, false, TEXT("NotStarted"));
+	MultiplayerOnCreateSessionComplete.Broadcast(false);
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::StartCreateSession(FName SessionName)
+{
+	const FMultiplayerNamedSessionState* SessionState{ SessionStates.Find(SessionName) };
+	if (!ResolveSessionBackend() || !SessionState || !SessionState->LastSessionSettings.IsValid())
+		return false;
+
+	//A dedicated server registers as itself, not as whoever happens to be logged in locally
+	const FUniqueNetIdPtr HostingPlayerId{ SessionState->LastSessionSettings->bIsDedicated ? nullptr : GetLocalUserId() };
+
+	//Store the delegate in a FDelegateHandle so we can later remove it from the delegate list
+	CreateSessionCompleteDelegate_Handle = SessionBackend->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
+
+	//Create session
+	bool bWasSuccessfull = SessionBackend->CreateSession(HostingPlayerId, SessionName, *SessionState->LastSessionSettings);
+	if (!bWasSuccessfull)
+	{
+		//If session creation was failed - remove delegate from SessionBackend
+		SessionBackend->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+		return false;
+	}
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteFindSessions(const FMultiplayerSearchSettings& InSearchSettings)
+{
+	MULTIPLAYER_LOG(Verbose, TEXT("Searching for sessions"));
+
+	//A search that is still being indexed is thrown away for this one
+	FMultiplayerFindSessionsResult ReplacedResult;
+	ReplacedResult.bWasCancelled = true;
+	PendingFindResults.ResolveRunning(ReplacedResult);
+	PendingFindResults.SetRunning(OperationQueue.GetActiveHandle());
+
+	if (!ResolveSessionBackend())
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Find, false, TEXT("NoSessionBackend"));
+		MultiplayerOnFindSessionComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		MULTIPLAYER_LOG(Error, TEXT("No session interface available"));
+		return false;
+	}
+
+	//Probe results would point into the old result array
+	LatencyProber->CancelProbe();
+	ProbeCandidates.Reset();
+	RankedSessions.Reset();
+
+	LastSearchSettings = InSearchSettings;
+	bIsAdaptiveSearch = InSearchSettings.NumWantedResults > 0;
+	AdaptiveSearchSize = bIsAdaptiveSearch ? SearchSizer.GetInitialSize(InSearchSettings.MatchType, InSearchSettings.NumWantedResults, InSearchSettings.MaxSearchResults) : InSearchSettings.MaxSearchResults;
+
+	if (!StartSearchRound())
+	{
+		bIsAdaptiveSearch = false;
+		LatencyTracker.End(EMultiplayerSessionOperation::Find, false, TEXT("NotStarted"));
+		MultiplayerOnFindSessionComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		return false;
+	}
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::StartSearchRound()
+{
+	FMultiplayerSearchSettings RoundSettings{ LastSearchSettings };
+	RoundSettings.MaxSearchResults = AdaptiveSearchSize;
+
+	StopResultsProcessing();
+	RecycleSessionSearch(MoveTemp(LastSessionSearch));
+	LastSessionSearch = MakeSessionSearch(RoundSettings);
+	SearchCache.Reset();
+	LastSearchCompletedTime = 0.0;
+	NumCheckedResults = 0;
+	NumQualifiedResults = 0;
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Is lan query: %d, asking for %d results"), LastSessionSearch->bIsLanQuery, RoundSettings.MaxSearchResults);
+
+	FindSessionsCompleteDelegate_Handle = SessionBackend->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
+
+	StopSearchStream();
+	SearchStreamBatchSize = RoundSettings.BatchSize;
+	NumStreamedResults = 0;
+
+	bool bWasSuccessfull = SessionBackend->FindSessions(GetLocalUserId(), LastSessionSearch.ToSharedRef());
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
+		StopSearchStream();
+		return false;
+	}
+
+	//Some backends complete the search synchronously, nothing to stream or stop early then
+	if ((SearchStreamBatchSize > 0 || bIsAdaptiveSearch) && LastSessionSearch.IsValid() && LastSessionSearch->SearchState == EOnlineAsyncTaskState::InProgress)
+	{
+		SearchStreamTicker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickSearchStream), SearchStreamInterval);
+	}
+
+	return true;
+}
+
+int32 UMultiplayerSessionsSubsystem::CountQualifiedResults()
+{
+	if(!LastSessionSearch.IsValid())
+		return NumQualifiedResults;
+
+	const TArray<FOnlineSessionSearchResult>& SearchResults{ LastSessionSearch->SearchResults };
+	const int32 MinOpenSlots{ FMath::Max(LastSearchSettings.MinOpenSlots, 1) };
+
+	for (; NumCheckedResults < SearchResults.Num(); ++NumCheckedResults)
+	{
+		const FOnlineSessionSearchResult& SearchResult{ SearchResults[NumCheckedResults] };
+		const FOnlineSessionSettings& SessionSettings{ SearchResult.Session.SessionSettings };
+
+		//Same as the search cache, hosts with admission control advertise what is left after reservations
+		int32 OpenSlots{ SearchResult.Session.NumOpenPublicConnections };
+		int32 AdvertisedOpenSlots{ 0 };
+		if (MultiplayerSessionAttributes::OpenSlots.TryRead(SessionSettings, AdvertisedOpenSlots))
+		{
+			OpenSlots = FMath::Min(OpenSlots, AdvertisedOpenSlots);
+		}
+
+		if(OpenSlots < MinOpenSlots)
+			continue;
+
+		if(!LastSearchSettings.MatchType.IsEmpty() && MultiplayerSessionAttributes::MatchType.Read(SessionSettings) != LastSearchSettings.MatchType)
+			continue;
+
+		++NumQualifiedResults;
+	}
+
+	return NumQualifiedResults;
+}
+
+bool UMultiplayerSessionsSubsystem::TryWidenSearch(bool bWasSuccessfull)
+{
+	if(!bIsAdaptiveSearch || !LastSessionSearch.IsValid())
+		return false;
+
+	const int32 NumReturned{ LastSessionSearch->SearchResults.Num() };
+	const int32 NumQualified{ CountQualifiedResults() };
+	SearchSizer.RecordSearch(LastSearchSettings.MatchType, NumReturned, NumQualified);
+
+	//Enough is in, or the backend had nothing more to give
+	const bool bIsOver{ !bWasSuccessfull || NumQualified >= LastSearchSettings.NumWantedResults || NumReturned < AdaptiveSearchSize || AdaptiveSearchSize >= LastSearchSettings.MaxSearchResults };
+	if (bIsOver)
+	{
+		bIsAdaptiveSearch = false;
+		return false;
+	}
+
+	AdaptiveSearchSize = SearchSizer.GetWidenedSize(AdaptiveSearchSize, LastSearchSettings.NumWantedResults, NumReturned, NumQualified, LastSearchSettings.MaxSearchResults);
+	MULTIPLAYER_LOG(Verbose, TEXT("Only %d of %d sessions qualified, searching again for %d"), NumQualified, NumReturned, AdaptiveSearchSize);
+
+	if(StartSearchRound())
+		return true;
+
+	MULTIPLAYER_LOG(Warning, TEXT("Failed to widen the session search"));
+	bIsAdaptiveSearch = false;
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteRefreshSearch(const FMultiplayerSearchSettings& InSearchSettings)
+{
+	if(!ResolveSessionBackend())
+		return false;
+
+	//Nobody waits on a refresh, one round of the size adaptive searches settle on is enough
+	FMultiplayerSearchSettings RefreshSettings{ InSearchSettings };
+	if (InSearchSettings.NumWantedResults > 0)
+	{
+		RefreshSettings.MaxSearchResults = SearchSizer.GetInitialSize(InSearchSettings.MatchType, InSearchSettings.NumWantedResults, InSearchSettings.MaxSearchResults);
+	}
+
+	RefreshSessionSearch = MakeSessionSearch(RefreshSettings);
+	bIsRefreshSearch = true;
+
+	FindSessionsCompleteDelegate_Handle = SessionBackend->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
+
+	bool bWasSuccessfull{ SessionBackend->FindSessions(GetLocalUserId(), RefreshSessionSearch.ToSharedRef()) };
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
+		RefreshSessionSearch.Reset();
+		bIsRefreshSearch = false;
+		return false;
+	}
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteJoinSession(const FOnlineSessionSearchResult& FindSessionsResult, FName SessionName)
+{
+	PendingJoinResults.SetRunning(OperationQueue.GetActiveHandle());
+	OperationSessionName = SessionName;
+	JoinCandidates.Reset();
+	ActiveJoinResultIndex = INDEX_NONE;
+
+	if (StartJoinSession(FindSessionsResult, SessionName))
+		return true;
+
+	LatencyTracker.End(EMultiplayerSessionOperation::Join, false, TEXT("NotStarted"));
+	MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteJoinAnySession(const TArray<int32>& InCandidateResultIndices, TSharedPtr<FOnlineSessionSearch> InSearch, FName SessionName)
+{
+	PendingJoinResults.SetRunning(OperationQueue.GetActiveHandle());
+	OperationSessionName = SessionName;
+	JoinCandidates.Reset();
+	NextJoinCandidate = 0;
+	ActiveJoinResultIndex = INDEX_NONE;
+
+	//A newer search replaced the results the candidates point into
+	if (InSearch == LastSessionSearch)
+	{
+		JoinCandidates = InCandidateResultIndices;
+	}
+
+	if (TryNextJoinCandidate())
+		return true;
+
+	JoinCandidates.Reset();
+	LatencyTracker.End(EMultiplayerSessionOperation::Join, false, TEXT("NoCandidates"));
+	MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteDestroySession(FName SessionName)
+{
+	PendingDestroyResults.SetRunning(OperationQueue.GetActiveHandle());
+	OperationSessionName = SessionName;
+
+	if (StartDestroySession(SessionName))
+		return true;
+
+	LatencyTracker.End(EMultiplayerSessionOperation::Destroy, false, TEXT("NotStarted"));
+	MultiplayerOnDestroySessionComplete.Broadcast(false);
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::StartDestroySession(FName SessionName)
+{
+	if (!ResolveSessionBackend())
+		return false;
+
+	DestroySessionCompleteDelegate_Handle = SessionBackend->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
+
+	bool bWasSuccessfull{ SessionBackend->DestroySession(SessionName) };
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+		return false;
+	}
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteStartSession(FName SessionName)
+{
+	PendingStartResults.SetRunning(OperationQueue.GetActiveHandle());
+	OperationSessionName = SessionName;
+
+	if (!ResolveSessionBackend())
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Start, false, TEXT("NoSessionBackend"));
+		MultiplayerOnStartSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	StartSessionCompleteDelegate_Handle = SessionBackend->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
+
+	bool bWasSuccessfull{ SessionBackend->StartSession(SessionName) };
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate_Handle);
+		LatencyTracker.End(EMultiplayerSessionOperation::Start, false, TEXT("NotStarted"));
+		MultiplayerOnStartSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecuteUpdateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName)
+{
+	PendingUpdateResults.SetRunning(OperationQueue.GetActiveHandle());
+	OperationSessionName = SessionName;
+
+	if (!ResolveSessionBackend())
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Update, false, TEXT("NoSessionBackend"));
+		MultiplayerOnUpdateSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	//Only the host can change what is advertised
+	FNamedOnlineSession* ExistingSession{ SessionBackend->GetNamedSession(SessionName) };
+	if (!ExistingSession || !ExistingSession->bHosting)
+	{
+		MULTIPLAYER_LOG(Error, TEXT("Failed to update session, not hosting %s"), *SessionName.ToString());
+		LatencyTracker.End(EMultiplayerSessionOperation::Update, false, TEXT("NotHosting"));
+		MultiplayerOnUpdateSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	//Starts from the live settings, so the LAN flag stays what it was created with
+	FOnlineSessionSettings UpdatedSettings{ ExistingSession->SessionSettings };
+	int32 NumChanged{ ApplyChangedSettings(UpdatedSettings, *InSessionSettings) };
+
+	//Whoever asked for the update, the open slots advertised are the ones admission control has left
+	if (SessionName == NAME_GameSession && Admission.IsActive())
+	{
+		int32 OpenSlots{ INDEX_NONE };
+		MultiplayerSessionAttributes::OpenSlots.TryRead(UpdatedSettings, OpenSlots);
+
+		AdvertisedOpenSlots = Admission.GetNumOpenSlots();
+		if (OpenSlots != AdvertisedOpenSlots)
+		{
+			MultiplayerSessionAttributes::OpenSlots.Write(UpdatedSettings, AdvertisedOpenSlots);
+			++NumChanged;
+		}
+	}
+	if (NumChanged == 0)
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("Session already has these settings, nothing to update"));
+		LatencyTracker.End(EMultiplayerSessionOperation::Update, true);
+		MultiplayerOnUpdateSessionComplete.Broadcast(true);
+		return false;
+	}
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Updating %d session attributes"), NumChanged);
+
+	UpdateSessionCompleteDelegate_Handle = SessionBackend->AddOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate);
+
+	bool bWasSuccessfull{ SessionBackend->UpdateSession(SessionName, UpdatedSettings, true) };
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate_Handle);
+		LatencyTracker.End(EMultiplayerSessionOperation::Update, false, TEXT("NotStarted"));
+		MultiplayerOnUpdateSessionComplete.Broadcast(false);
+		return false;
+	}
+
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::AbortCreateSession(EMultiplayerOperationAbortReason Reason)
+{
+	if (Reason == EMultiplayerOperationAbortReason::Cancelled)
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Create, false, TEXT("Cancelled"));
+	}
+
+	//Only a running request can time out
+	if(Reason != EMultiplayerOperationAbortReason::TimedOut || !SessionBackend.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Error, TEXT("Session creation timed out"));
+
+	SessionBackend->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+	SessionBackend->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+	if (FMultiplayerNamedSessionState* SessionState{ SessionStates.Find(OperationSessionName) })
+	{
+		SessionState->bCreateSessionOnDestroy = false;
+	}
+
+	LatencyTracker.End(EMultiplayerSessionOperation::Create, false, TEXT("TimedOut"));
+	MultiplayerOnCreateSessionComplete.Broadcast(false);
+}
+
+void UMultiplayerSessionsSubsystem::AbortFindSessions(EMultiplayerOperationAbortReason Reason)
+{
+	StopActiveSearch();
+	bIsAdaptiveSearch = false;
+
+	//Nobody is waiting for a refresh, the cached results stay as they are
+	if (bIsRefreshSearch)
+	{
+		bIsRefreshSearch = false;
+		RefreshSessionSearch.Reset();
+		return;
+	}
+
+	//Cutting a search short once enough was found is a success for whoever cancelled it
+	if (Reason == EMultiplayerOperationAbortReason::Cancelled)
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Find, SearchCache.GetNumIndexed() > 0, TEXT("Cancelled"));
+	}
+
+	if(Reason != EMultiplayerOperationAbortReason::TimedOut || !LastSessionSearch.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Warning, TEXT("Session search timed out"));
+
+	//Whatever arrived in time is still worth something
+	SearchCache.IndexResults(LastSessionSearch->SearchResults);
+	LatencyTracker.End(EMultiplayerSessionOperation::Find, !LastSessionSearch->SearchResults.IsEmpty(), TEXT("TimedOut"));
+	const uint32 SearchGeneration{ SearchCache.GetGeneration() };
+	MultiplayerOnFindSessionComplete.Broadcast(LastSessionSearch->SearchResults, !LastSessionSearch->SearchResults.IsEmpty());
+	TrimSearchResultsAfterBroadcast(SearchGeneration);
+}
+
+void UMultiplayerSessionsSubsystem::AbortJoinSession(EMultiplayerOperationAbortReason Reason)
+{
+	if (Reason == EMultiplayerOperationAbortReason::Cancelled)
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Join, false, TEXT("Cancelled"));
+	}
+
+	if(Reason != EMultiplayerOperationAbortReason::TimedOut || !SessionBackend.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Error, TEXT("Joining session timed out"));
+
+	SessionBackend->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
+	JoinCandidates.Reset();
+	ActiveJoinResultIndex = INDEX_NONE;
+
+	LatencyTracker.End(EMultiplayerSessionOperation::Join, false, TEXT("TimedOut"));
+	MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+}
+
+void UMultiplayerSessionsSubsystem::AbortDestroySession(EMultiplayerOperationAbortReason Reason)
+{
+	if (Reason == EMultiplayerOperationAbortReason::Cancelled)
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Destroy, false, TEXT("Cancelled"));
+	}
+
+	if(Reason != EMultiplayerOperationAbortReason::TimedOut || !SessionBackend.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Error, TEXT("Destroying session timed out"));
+
+	SessionBackend->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+	LatencyTracker.End(EMultiplayerSessionOperation::Destroy, false, TEXT("TimedOut"));
+	MultiplayerOnDestroySessionComplete.Broadcast(false);
+}
+
+void UMultiplayerSessionsSubsystem::AbortStartSession(EMultiplayerOperationAbortReason Reason)
+{
+	if (Reason == EMultiplayerOperationAbortReason::Cancelled)
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Start, false, TEXT("Cancelled"));
+	}
+
+	if(Reason != EMultiplayerOperationAbortReason::TimedOut || !SessionBackend.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Error, TEXT("Starting session timed out"));
+
+	SessionBackend->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate_Handle);
+	LatencyTracker.End(EMultiplayerSessionOperation::Start, false, TEXT("TimedOut"));
+	MultiplayerOnStartSessionComplete.Broadcast(false);
+}
+
+void UMultiplayerSessionsSubsystem::AbortUpdateSession(EMultiplayerOperationAbortReason Reason)
+{
+	if (Reason == EMultiplayerOperationAbortReason::Cancelled)
+	{
+		LatencyTracker.End(EMultiplayerSessionOperation::Update, false, TEXT("Cancelled"));
+	}
+
+	if(Reason != EMultiplayerOperationAbortReason::TimedOut || !SessionBackend.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Error, TEXT("Updating session timed out"));
+
+	SessionBackend->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate_Handle);
+	LatencyTracker.End(EMultiplayerSessionOperation::Update, false, TEXT("TimedOut"));
+	MultiplayerOnUpdateSessionComplete.Broadcast(false);
+}
+
+void UMultiplayerSessionsSubsystem::OnOperationDropped(FMultiplayerOperationHandle Handle, EMultiplayerSessionOperation Type, EMultiplayerOperationAbortReason Reason, bool bWasStarted)
+{
+	//Repeated requests share one timing from the first of them. A running one ended it in its abort,
+	//if the last waiting one is gone without running there is nothing left to measure
+	if (!OperationQueue.IsActive(Type) && !OperationQueue.IsPending(Type))
+	{
+		LatencyTracker.Discard(Type);
+	}
+
+	//Timeouts are broadcasted like any other failure, those futures are already fulfilled
+	FMultiplayerSessionResult CancelledResult;
+	CancelledResult.bWasCancelled = true;
+
+	switch (Type)
+	{
+	case EMultiplayerSessionOperation::Create:
+		PendingCreateResults.Resolve(Handle, CancelledResult);
+		break;
+	case EMultiplayerSessionOperation::Destroy:
+		PendingDestroyResults.Resolve(Handle, CancelledResult);
+		break;
+	case EMultiplayerSessionOperation::Start:
+		PendingStartResults.Resolve(Handle, CancelledResult);
+		break;
+	case EMultiplayerSessionOperation::Update:
+		PendingUpdateResults.Resolve(Handle, CancelledResult);
+		break;
+	case EMultiplayerSessionOperation::Find:
+	{
+		//Cut short on purpose, what was found so far is still there. One that never ran found nothing,
+		//the last search belongs to an older request
+		FMultiplayerFindSessionsResult FindResult;
+		if (bWasStarted)
+		{
+			FindResult.Search = LastSessionSearch;
+			FindResult.bWasSuccessfull = SearchCache.GetNumIndexed() > 0;
+		}
+		FindResult.bWasCancelled = true;
+		PendingFindResults.Resolve(Handle, FindResult);
+		break;
+	}
+	case EMultiplayerSessionOperation::Join:
+	{
+		FMultiplayerJoinSessionResult JoinResult;
+		JoinResult.bWasCancelled = true;
+		PendingJoinResults.Resolve(Handle, JoinResult);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::CancelPendingResults()
+{
+	FMultiplayerSessionResult CancelledResult;
+	CancelledResult.bWasCancelled = true;
+	PendingCreateResults.ResolveAll(CancelledResult);
+	PendingDestroyResults.ResolveAll(CancelledResult);
+	PendingStartResults.ResolveAll(CancelledResult);
+	PendingUpdateResults.ResolveAll(CancelledResult);
+
+	FMultiplayerFindSessionsResult FindResult;
+	FindResult.bWasCancelled = true;
+	PendingFindResults.ResolveAll(FindResult);
+
+	FMultiplayerJoinSessionResult JoinResult;
+	JoinResult.bWasCancelled = true;
+	PendingJoinResults.ResolveAll(JoinResult);
+
+	DropFindBestResults();
+}
+
+void UMultiplayerSessionsSubsystem::DropFindBestResults()
+{
+	TArray<TPromise<FMultiplayerFindBestSessionResult>> Dropped{ MoveTemp(PendingFindBestResults) };
+	PendingFindBestResults.Reset();
+
+	for (TPromise<FMultiplayerFindBestSessionResult>& Promise : Dropped)
+	{
+		Promise.SetValue(FMultiplayerFindBestSessionResult());
+	}
+}
+
+void UMultiplayerSessionsSubsystem::BuildSessionPresets()
+{
+	SessionPresets.Reset();
+
+	const UMultiplayerSessionsSettings* Settings{ GetDefault<UMultiplayerSessionsSettings>() };
+	for (const FMultiplayerSessionPreset& Preset : Settings->SessionPresets)
+	{
+		if (Preset.Name.IsNone())
+		{
+			MULTIPLAYER_LOG(Error, TEXT("Skipping session preset without a name"));
+			continue;
+		}
+
+		if (SessionPresets.Contains(Preset.Name))
+		{
+			MULTIPLAYER_LOG(Error, TEXT("Skipping session preset %s, the name is already taken"), *Preset.Name.ToString());
+			continue;
+		}
+
+		if (Preset.PublicConnections < 1)
+		{
+			MULTIPLAYER_LOG(Error, TEXT("Skipping session preset %s, it needs at least one public connection"), *Preset.Name.ToString());
+			continue;
+		}
+
+		if (Preset.MatchType.IsEmpty())
+		{
+			MULTIPLAYER_LOG(Warning, TEXT("Session preset %s has no match type, searches filtering by match type won't find it"), *Preset.Name.ToString());
+		}
+
+		FMultiplayerMatchSettings MatchSettings;
+		MatchSettings.PublicConnections = Preset.PublicConnections;
+		MatchSettings.MatchType = Preset.MatchType;
+		MatchSettings.MatchName = Preset.MatchName;
+		MatchSettings.bAllowJoinInProgress = Preset.bAllowJoinInProgress;
+		MatchSettings.SkillBracket = Preset.SkillBracket;
+		MatchSettings.Region = Preset.Region;
+		SessionPresets.Add(Preset.Name, MakeSessionSettings(MatchSettings));
+	}
+
+	MULTIPLAYER_LOG(Verbose, TEXT("%d session presets ready"), SessionPresets.Num());
+}
+
+TSharedRef<FOnlineSessionSettings> UMultiplayerSessionsSubsystem::MakeSessionSettings(const FMultiplayerMatchSettings& InMatchSettings) const
+{
+	//bIsLANMatch is left to ExecuteCreateSession, presets are built before there is a backend to ask
+	TSharedRef<FOnlineSessionSettings> SessionSettings{ MakeShared<FOnlineSessionSettings>() };
+	SessionSettings->NumPublicConnections = InMatchSettings.PublicConnections;
+	SessionSettings->bAllowJoinInProgress = InMatchSettings.bAllowJoinInProgress;
+	SessionSettings->bAllowJoinViaPresence = true;
+	SessionSettings->bUsesPresence = true;
+	SessionSettings->bShouldAdvertise = true;
+	SessionSettings->bUseLobbiesIfAvailable = true;
+	SessionSettings->BuildUniqueId = 1;
+	MultiplayerSessionAttributes::MatchType.Write(*SessionSettings, InMatchSettings.MatchType);
+	MultiplayerSessionAttributes::MatchName.Write(*SessionSettings, InMatchSettings.MatchName);
+	MultiplayerSessionAttributes::GameName.WriteDefault(*SessionSettings);
+	MultiplayerSessionAttributes::BuildId.Write(*SessionSettings, SessionSettings->BuildUniqueId);
+
+	if (InMatchSettings.SkillBracket != 0)
+	{
+		MultiplayerSessionAttributes::SkillBracket.Write(*SessionSettings, InMatchSettings.SkillBracket);
+	}
+
+	if (!InMatchSettings.Region.IsEmpty())
+	{
+		MultiplayerSessionAttributes::Region.Write(*SessionSettings, InMatchSettings.Region);
+	}
+
+	return SessionSettings;
+}
+
+FMultiplayerOperationHandle UMultiplayerSessionsSubsystem::StartDedicatedHosting(const FOnlineSessionSettings& InSessionSettings)
+{
+	if (!IsRunningDedicatedServer())
+	{
+		MULTIPLAYER_LOG(Warning, TEXT("Hosting a dedicated session from a process that is not a dedicated server"));
+	}
+
+	//Players find dedicated servers through the server list, there is no owner to follow through presence or a lobby
+	DedicatedSessionSettings = MakeShared<FOnlineSessionSettings>(InSessionSettings);
+	DedicatedSessionSettings->bIsDedicated = true;
+	DedicatedSessionSettings->bUsesPresence = false;
+	DedicatedSessionSettings->bAllowJoinViaPresence = false;
+	DedicatedSessionSettings->bUseLobbiesIfAvailable = false;
+	MultiplayerSessionAttributes::NumPlayers.WriteDefault(*DedicatedSessionSettings);
+	bDedicatedSessionDirty = false;
+
+	const float HeartbeatInterval{ FMath::Max(GetDefault<UMultiplayerSessionsSettings>()->HeartbeatInterval, 1.f) };
+
+	StopDedicatedHeartbeat();
+	DedicatedHeartbeatTicker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickDedicatedHeartbeat), HeartbeatInterval);
+
+	MULTIPLAYER_LOG(Log, TEXT("Hosting dedicated session, heartbeat every %.0f s"), HeartbeatInterval);
+
+	//The live settings get ahead of what was registered, the heartbeat catches up with them
+	return EnqueueCreateSession(MakeShared<FOnlineSessionSettings>(*DedicatedSessionSettings), NAME_GameSession);
+}
+
+bool UMultiplayerSessionsSubsystem::TickDedicatedHeartbeat(float DeltaTime)
+{
+	if (!IsHostingDedicated())
+	{
+		DedicatedHeartbeatTicker_Handle.Reset();
+		return false;
+	}
+
+	//Not registered yet, whatever changed in the meantime goes out with the first heartbeat after that
+	if(!SessionBackend.IsValid() || !SessionBackend->GetNamedSession(NAME_GameSession))
+		return true;
+
+	//Read once per heartbeat, players coming and going in between cost nothing
+	UWorld* World{ GetWorld() };
+	AGameModeBase* GameMode{ World ? World->GetAuthGameMode() : nullptr };
+	if (GameMode)
+	{
+		if (MultiplayerSessionAttributes::NumPlayers.Read(*DedicatedSessionSettings) != GameMode->GetNumPlayers())
+		{
+			MultiplayerSessionAttributes::NumPlayers.Write(*DedicatedSessionSettings, GameMode->GetNumPlayers());
+			bDedicatedSessionDirty = true;
+		}
+	}
+
+	if(!bDedicatedSessionDirty)
+		return true;
+
+	MULTIPLAYER_LOG(VeryVerbose, TEXT("Dedicated session heartbeat"));
+
+	//A heartbeat the backend has not gotten to yet is replaced by this one
+	bDedicatedSessionDirty = false;
+	EnqueueUpdateSession(MakeShared<FOnlineSessionSettings>(*DedicatedSessionSettings), NAME_GameSession);
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::StopDedicatedHeartbeat()
+{
+	if(!DedicatedHeartbeatTicker_Handle.IsValid())
+		return;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(DedicatedHeartbeatTicker_Handle);
+	DedicatedHeartbeatTicker_Handle.Reset();
+}
+
+bool UMultiplayerSessionsSubsystem::ReserveSlot(const FUniqueNetIdRepl& PlayerId)
+{
+	if(!Admission.IsActive())
+		return false;
+
+	return Admission.Reserve(MultiplayerSessionsAdmission::GetPlayerId(PlayerId), FPlatformTime::Seconds());
+}
+
+void UMultiplayerSessionsSubsystem::StartAdmission()
+{
+	const FNamedOnlineSession* GameSession{ SessionBackend.IsValid() ? SessionBackend->GetNamedSession(NAME_GameSession) : nullptr };
+	if(!GameSession || !GameSession->bHosting)
+		return;
+
+	const UMultiplayerSessionsSettings* Settings{ GetDefault<UMultiplayerSessionsSettings>() };
+	Admission.Start(GameSession->SessionSettings.NumPublicConnections, Settings->MaxConcurrentHandshakes, Settings->ReservationTimeout);
+
+	//The session may have been created with players already on the map, e.g. from a lobby
+	UWorld* World{ GetWorld() };
+	AGameModeBase* GameMode{ World ? World->GetAuthGameMode() : nullptr };
+	if (GameMode && GameMode->GameState)
+	{
+		for (const APlayerState* PlayerState : GameMode->GameState->PlayerArray)
+		{
+			if (PlayerState)
+			{
+				Admission.CompleteHandshake(MultiplayerSessionsAdmission::GetPlayerId(PlayerState->GetUniqueId()));
+			}
+		}
+	}
+
+	//Nothing advertised yet, searching players go by the backend's count until the first change
+	AdvertisedOpenSlots = INDEX_NONE;
+
+	if (!AdmissionTicker_Handle.IsValid())
+	{
+		AdmissionTicker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickAdmission), AdmissionTickInterval);
+	}
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Admission control started, %d of %d slots open"), Admission.GetNumOpenSlots(), GameSession->SessionSettings.NumPublicConnections);
+}
+
+void UMultiplayerSessionsSubsystem::StopAdmission()
+{
+	Admission.Stop();
+	AdvertisedOpenSlots = INDEX_NONE;
+
+	if(!AdmissionTicker_Handle.IsValid())
+		return;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(AdmissionTicker_Handle);
+	AdmissionTicker_Handle.Reset();
+}
+
+int32 UMultiplayerSessionsSubsystem::StartLatencyEchoServer()
+{
+	if(LatencyEchoServer.IsValid())
+		return LatencyEchoServer->GetPort();
+
+	//Fake sessions have no address anyone could probe
+	const int32 EchoPort{ GetDefault<UMultiplayerSessionsSettings>()->LatencyEchoPort };
+	if(EchoPort <= 0 || !SessionBackend.IsValid() || SessionBackend->GetBackendName() == FMultiplayerSessionsFakeBackend::BackendName)
+		return 0;
+
+	//Another host on the same machine may have the port already, clients fall back to the reported ping for us then
+	TUniquePtr<FMultiplayerSessionsUdpEchoServer> EchoServer{ MakeUnique<FMultiplayerSessionsUdpEchoServer>(EchoPort) };
+	if (!EchoServer->Start())
+	{
+		MULTIPLAYER_LOG(Warning, TEXT("Could not answer latency probes on port %d"), EchoPort);
+		return 0;
+	}
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Answering latency probes on port %d"), EchoPort);
+
+	LatencyEchoServer = MoveTemp(EchoServer);
+	return EchoPort;
+}
+
+void UMultiplayerSessionsSubsystem::StopLatencyEchoServer()
+{
+	LatencyEchoServer.Reset();
+}
+
+bool UMultiplayerSessionsSubsystem::TickAdmission(float DeltaTime)
+{
+	if (!Admission.IsActive())
+	{
+		AdmissionTicker_Handle.Reset();
+		return false;
+	}
+
+	const int32 NumExpired{ Admission.ExpireReservations(FPlatformTime::Seconds()) };
+	if (NumExpired > 0)
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("%d slot reservations expired"), NumExpired);
+	}
+
+	if(Admission.GetNumOpenSlots() == AdvertisedOpenSlots)
+		return true;
+
+	//Dedicated servers send it with their next heartbeat
+	if (IsHostingDedicated())
+	{
+		bDedicatedSessionDirty = true;
+		return true;
+	}
+
+	//A queued update stamps the current count when it runs, and a burst of logins costs one update per tick at most
+	if(OperationQueue.IsPending(EMultiplayerSessionOperation::Update))
+		return true;
+
+	const FNamedOnlineSession* GameSession{ SessionBackend.IsValid() ? SessionBackend->GetNamedSession(NAME_GameSession) : nullptr };
+	if(!GameSession)
+		return true;
+
+	AdvertisedOpenSlots = Admission.GetNumOpenSlots();
+	EnqueueUpdateSession(MakeShared<FOnlineSessionSettings>(GameSession->SessionSettings), NAME_GameSession);
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::OnGameModePreLogin(AGameModeBase* GameMode, const FUniqueNetIdRepl& NewPlayer, FString& ErrorMessage)
+{
+	//Turned away already, or a login on another game instance (PIE)
+	if(!Admission.IsActive() || !ErrorMessage.IsEmpty() || !GameMode || GameMode->GetGameInstance() != GetGameInstance())
+		return;
+
+	switch (Admission.BeginHandshake(MultiplayerSessionsAdmission::GetPlayerId(NewPlayer), FPlatformTime::Seconds()))
+	{
+	case EMultiplayerAdmissionResult::Full:
+		MULTIPLAYER_LOG(Log, TEXT("Turned away a login, every slot is taken or reserved"));
+		ErrorMessage = TEXT("Server full");
+		break;
+	case EMultiplayerAdmissionResult::Busy:
+		MULTIPLAYER_LOG(Verbose, TEXT("Turned away a login, %d are being handled already"), Admission.GetNumHandshakes());
+		ErrorMessage = TEXT("Server busy, try again");
+		break;
+	default:
+		break;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	if(!Admission.IsActive() || !GameMode || GameMode->GetGameInstance() != GetGameInstance())
+		return;
+
+	Admission.CompleteHandshake(MultiplayerSessionsAdmission::GetPlayerId(NewPlayer));
+}
+
+void UMultiplayerSessionsSubsystem::OnGameModeLogout(AGameModeBase* GameMode, AController* Exiting)
+{
+	if(!Admission.IsActive() || !GameMode || GameMode->GetGameInstance() != GetGameInstance())
+		return;
+
+	Admission.Release(MultiplayerSessionsAdmission::GetPlayerId(Exiting));
+}
+
+int32 UMultiplayerSessionsSubsystem::ApplyChangedSettings(FOnlineSessionSettings& LiveSettings, const FOnlineSessionSettings& InSessionSettings)
+{
+	//Transport and presence flags can't change on a live session, only what players see and how many fit in
+	int32 NumChanged{ 0 };
+
+	if (LiveSettings.NumPublicConnections != InSessionSettings.NumPublicConnections)
+	{
+		LiveSettings.NumPublicConnections = InSessionSettings.NumPublicConnections;
+		++NumChanged;
+	}
+
+	if (LiveSettings.bAllowJoinInProgress != InSessionSettings.bAllowJoinInProgress)
+	{
+		LiveSettings.bAllowJoinInProgress = InSessionSettings.bAllowJoinInProgress;
+		++NumChanged;
+	}
+
+	for (const TPair<FName, FOnlineSessionSetting>& Setting : InSessionSettings.Settings)
+	{
+		const FOnlineSessionSetting* LiveSetting{ LiveSettings.Settings.Find(Setting.Key) };
+		if(LiveSetting && LiveSetting->Data == Setting.Value.Data && LiveSetting->AdvertisementType == Setting.Value.AdvertisementType)
+			continue;
+
+		LiveSettings.Settings.Add(Setting.Key, Setting.Value);
+		++NumChanged;
+	}
+
+	return NumChanged;
+}
+
+void UMultiplayerSessionsSubsystem::StopActiveSearch()
+{
+	StopSearchStream();
+
+	if (!SessionBackend.IsValid())
+		return;
+
+	//Nobody waits for the results anymore
+	SessionBackend->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
+
+	const TSharedPtr<FOnlineSessionSearch>& RunningSearch{ bIsRefreshSearch ? RefreshSessionSearch : LastSessionSearch };
+	if (!RunningSearch.IsValid() || RunningSearch->SearchState != EOnlineAsyncTaskState::InProgress)
+		return;
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Cancelling session search"));
+	SessionBackend->CancelFindSessions();
+}
+
+TSharedRef<FOnlineSessionSearch> UMultiplayerSessionsSubsystem::MakeSessionSearch(const FMultiplayerSearchSettings& InSearchSettings)
+{
+	TSharedRef<FOnlineSessionSearch> SessionSearch{ SearchStorage.Acquire() };
+	SessionSearch->MaxSearchResults = InSearchSettings.MaxSearchResults;
+	SessionSearch->bIsLanQuery = GetIsLanMatch();
+
+	//Steam and EOS list dedicated servers and lobbies apart
+	if (InSearchSettings.bDedicatedServers)
+	{
+		SessionSearch->QuerySettings.Set(SEARCH_DEDICATED_ONLY, true, EOnlineComparisonOp::Equals);
+	}
+	else
+	{
+		SessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
+	}
+
+	MultiplayerSessionAttributes::GameName.Query(SessionSearch->QuerySettings, MultiplayerSessionAttributes::GameName.Default);
+
+	//Let the backend drop what we don't want instead of downloading and filtering it here
+	if (!InSearchSettings.MatchType.IsEmpty())
+	{
+		MultiplayerSessionAttributes::MatchType.Query(SessionSearch->QuerySettings, InSearchSettings.MatchType);
+	}
+
+	if (InSearchSettings.MinOpenSlots > 0)
+	{
+		SessionSearch->QuerySettings.Set(SEARCH_MINSLOTSAVAILABLE, InSearchSettings.MinOpenSlots, EOnlineComparisonOp::GreaterThanEquals);
+	}
+
+	if (InSearchSettings.BuildId != 0)
+	{
+		MultiplayerSessionAttributes::BuildId.Query(SessionSearch->QuerySettings, InSearchSettings.BuildId);
+	}
+
+	return SessionSearch;
+}
+
+FUniqueNetIdPtr UMultiplayerSessionsSubsystem::GetLocalUserId() const
+{
+	const UWorld* World{ GetWorld() };
+	const ULocalPlayer* LocalPlayer{ World ? World->GetFirstLocalPlayerFromController() : nullptr };
+	if(!LocalPlayer)
+		return nullptr;
+
+	return LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId();
+}
+
+bool UMultiplayerSessionsSubsystem::StartJoinSession(const FOnlineSessionSearchResult& FindSessionsResult, FName SessionName)
+{
+	if (!ResolveSessionBackend())
+		return false;
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Connecting.."));
+
+	JoinSessionCompleteDelegate_Handle = SessionBackend->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
+	bool bWasSuccessfull{ SessionBackend->JoinSession(GetLocalUserId(), SessionName, FindSessionsResult) };
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
+		return false;
+	}
+
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::TryNextJoinCandidate()
+{
+	while (NextJoinCandidate < JoinCandidates.Num())
+	{
+		const int32 ResultIndex{ JoinCandidates[NextJoinCandidate++] };
+		if(SearchCache.IsStale(ResultIndex))
+			continue;
+
+		const FOnlineSessionSearchResult* SearchResult{ GetSearchResult(ResultIndex) };
+		if(!SearchResult)
+			continue;
+
+		ActiveJoinResultIndex = ResultIndex;
+		if (StartJoinSession(*SearchResult, OperationSessionName))
+			return true;
+
+		SearchCache.MarkStale(ResultIndex);
+	}
+
+	ActiveJoinResultIndex = INDEX_NONE;
+	return false;
+}
+
+void UMultiplayerSessionsSubsystem::SetLogToScreen(bool bInLogToScreen)
+{
+	MultiplayerSessionsLog::SetScreenSinkEnabled(bInLogToScreen);
+}
+
+void UMultiplayerSessionsSubsystem::SetLatencyProber(TSharedPtr<IMultiplayerSessionsLatencyProber> InLatencyProber)
+{
+	LatencyProber->CancelProbe();
+	LatencyProber = InLatencyProber.IsValid() ? InLatencyProber : MakeShared<FMultiplayerSessionsUdpEchoProber>();
+}
+
+void UMultiplayerSessionsSubsystem::SetSessionBackend(TSharedPtr<IMultiplayerSessionsBackend> InSessionBackend)
+{
+	StopActiveSearch();
+	OperationQueue.Reset();
+
+	for (int32 OperationIndex{ 0 }; OperationIndex < static_cast<int32>(EMultiplayerSessionOperation::Travel); ++OperationIndex)
+	{
+		LatencyTracker.End(static_cast<EMultiplayerSessionOperation>(OperationIndex), false, TEXT("BackendChanged"));
+	}
+
+	//Nothing the old backend still delivers should reach us
+	if (SessionBackend.IsValid())
+	{
+		SessionBackend->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+		SessionBackend->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate_Handle);
+		SessionBackend->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+		SessionBackend->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
+		SessionBackend->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate_Handle);
+		SessionBackend->ClearOnFindSessionByIdCompleteDelegate_Handle(FindSessionByIdCompleteDelegate_Handle);
+	}
+
+	LatencyProber->CancelProbe();
+	ProbeCandidates.Reset();
+	RankedSessions.Reset();
+	JoinCandidates.Reset();
+	StopAdmission();
+	bIsAdaptiveSearch = false;
+	ActiveJoinResultIndex = INDEX_NONE;
+	for (TPair<FName, FMultiplayerNamedSessionState>& SessionState : SessionStates)
+	{
+		SessionState.Value.bCreateSessionOnDestroy = false;
+	}
+
+	RecycleSessionSearch(MoveTemp(LastSessionSearch));
+	SearchCache.Reset();
+	SearchStorage.UpdateStats(nullptr, SearchCache);
+	LastSearchCompletedTime = 0.0;
+	RefreshSessionSearch.Reset();
+	bIsRefreshSearch = false;
+	StopResultsProcessing();
+
+	CancelPendingResults();
+	OnFindSessionByIdComplete(false, FOnlineSessionSearchResult());
+
+	SessionBackend = InSessionBackend;
+	bSessionBackendResolved = InSessionBackend.IsValid();
+}
+
+TSharedPtr<IMultiplayerSessionsBackend> UMultiplayerSessionsSubsystem::GetSessionBackend() const
+{
+	ResolveSessionBackend();
+	return SessionBackend;
+}
+
+TSharedPtr<FMultiplayerSessionsLanBackend> UMultiplayerSessionsSubsystem::GetLanBackend() const
+{
+	if(!ResolveSessionBackend() || SessionBackend->GetBackendName() != FMultiplayerSessionsLanBackend::BackendName)
+		return nullptr;
+
+	return StaticCastSharedPtr<FMultiplayerSessionsLanBackend>(SessionBackend);
+}
+
+bool UMultiplayerSessionsSubsystem::ResolveSessionBackend() const
+{
+	if (!bSessionBackendResolved)
+	{
+		bSessionBackendResolved = true;
+		SessionBackend = CreateSessionBackend();
+	}
+
+	return SessionBackend.IsValid();
+}
+
+TSharedPtr<IMultiplayerSessionsBackend> UMultiplayerSessionsSubsystem::CreateSessionBackend() const
+{
+	const EMultiplayerSessionsBackendType BackendType{ GetDefault<UMultiplayerSessionsSettings>()->GetBackendType() };
+	if (BackendType == EMultiplayerSessionsBackendType::Fake)
+	{
+		MULTIPLAYER_LOG(Log, TEXT("Using the fake session backend"));
+		return MakeShared<FMultiplayerSessionsFakeBackend>();
+	}
+
+	if (BackendType == EMultiplayerSessionsBackendType::Lan)
+	{
+		const UMultiplayerSessionsSettings* Settings{ GetDefault<UMultiplayerSessionsSettings>() };
+
+		FMultiplayerLanDiscoverySettings LanSettings;
+		LanSettings.Port = Settings->LanDiscoveryPort;
+		LanSettings.NumPorts = Settings->LanDiscoveryPortCount;
+		LanSettings.BroadcastInterval = Settings->LanBroadcastInterval;
+		LanSettings.ResponseTimeout = Settings->LanResponseTimeout;
+		LanSettings.NumRespondersToComplete = Settings->LanRespondersToComplete;
+		LanSettings.HostTimeout = Settings->LanHostTimeout;
+
+		MULTIPLAYER_LOG(Log, TEXT("Using LAN discovery on ports %d-%d for sessions"), LanSettings.Port, LanSettings.Port + LanSettings.NumPorts - 1);
+		return MakeShared<FMultiplayerSessionsLanBackend>(LanSettings);
+	}
+
+	FName SubsystemName{ NAME_None };
+	if (BackendType == EMultiplayerSessionsBackendType::Steam)
+	{
+		SubsystemName = STEAM_SUBSYSTEM;
+	}
+	else if (BackendType == EMultiplayerSessionsBackendType::Null)
+	{
+		SubsystemName = NULL_SUBSYSTEM;
+	}
+
+	//Looked up through the world so every PIE instance gets its own
+	IOnlineSubsystem* Subsystem{ Online::GetSubsystem(GetWorld(), SubsystemName) };
+	if (!Subsystem && !SubsystemName.IsNone())
+	{
+		MULTIPLAYER_LOG(Warning, TEXT("Online subsystem %s is not available, using the default one"), *SubsystemName.ToString());
+		Subsystem = Online::GetSubsystem(GetWorld());
+	}
+
+	if (!Subsystem || !Subsystem->GetSessionInterface().IsValid())
+	{
+		MULTIPLAYER_LOG(Error, TEXT("No online subsystem with sessions available"));
+		return nullptr;
+	}
+
+	MULTIPLAYER_LOG(Log, TEXT("Using the %s online subsystem for sessions"), *Subsystem->GetSubsystemName().ToString());
+	return MakeShared<FMultiplayerSessionsOnlineBackend>(Subsystem->GetSessionInterface(), Subsystem->GetSubsystemName());
+}
+
+void UMultiplayerSessionsSubsystem::RecycleSessionSearch(TSharedPtr<FOnlineSessionSearch>&& Search)
+{
+	SearchStorage.Recycle(MoveTemp(Search), GetSearchResultsBudget());
+}
+
+void UMultiplayerSessionsSubsystem::TrimSearchResultsAfterBroadcast(uint32 SearchGeneration)
+{
+	//A listener that started another search from the event already replaced the results
+	if(SearchCache.GetGeneration() != SearchGeneration)
+		return;
+
+	TrimSearchResults();
+}
+
+void UMultiplayerSessionsSubsystem::TrimSearchResults()
+{
+	if(!LastSessionSearch.IsValid())
+		return;
+
+	const SIZE_T BudgetBytes{ GetSearchResultsBudget() };
+	if (BudgetBytes > 0 && SearchStorage.EstimateFootprint(*LastSessionSearch) > BudgetBytes)
+	{
+		const int32 NumResults{ LastSessionSearch->SearchResults.Num() };
+		TBitArray<> KeptResults{ false, NumResults };
+		auto KeepResult = [&KeptResults](int32 ResultIndex)
+		{
+			if (KeptResults.IsValidIndex(ResultIndex))
+			{
+				KeptResults[ResultIndex] = true;
+			}
+		};
+
+		//The sessions matchmaking would go for first, and whatever is being probed or joined already
+		for (const FMultiplayerRankedSession& RankedSession : ScoreSessions(ScoringQuery, SearchStorage.GetNumResultsWithin(*LastSessionSearch, BudgetBytes)))
+		{
+			KeepResult(RankedSession.ResultIndex);
+		}
+
+		for (const FMultiplayerRankedSession& Candidate : ProbeCandidates)
+		{
+			KeepResult(Candidate.ResultIndex);
+		}
+
+		for (const int32 ResultIndex : JoinCandidates)
+		{
+			KeepResult(ResultIndex);
+		}
+
+		KeepResult(ActiveJoinResultIndex);
+
+		const TArray<int32> TrimmedResults{ SearchStorage.Trim(*LastSessionSearch, KeptResults) };
+		for (const int32 ResultIndex : TrimmedResults)
+		{
+			SearchCache.MarkTrimmed(ResultIndex);
+		}
+
+		MULTIPLAYER_LOG(Verbose, TEXT("Trimmed %d of %d search results to stay within %d KB"), TrimmedResults.Num(), NumResults, static_cast<int32>(BudgetBytes / 1024));
+	}
+
+	SearchStorage.UpdateStats(LastSessionSearch.Get(), SearchCache);
+}
+
+SIZE_T UMultiplayerSessionsSubsystem::GetSearchResultsBudget() const
+{
+	return static_cast<SIZE_T>(FMath::Max(GetDefault<UMultiplayerSessionsSettings>()->SearchResultsMemoryBudgetKB, 0)) * 1024;
+}
+
+const FOnlineSessionSearchResult* UMultiplayerSessionsSubsystem::FindSearchResultById(const FString& InSessionId) const
+{
+	return GetSearchResult(SearchCache.FindById(InSessionId));
+}
+
+TConstArrayView<int32> UMultiplayerSessionsSubsystem::FindSearchResultsByMatchType(const FString& InMatchType) const
+{
+	return SearchCache.FindByMatchType(InMatchType);
+}
+
+const FOnlineSessionSearchResult* UMultiplayerSessionsSubsystem::GetSearchResult(int32 ResultIndex) const
+{
+	if (!LastSessionSearch.IsValid() || !LastSessionSearch->SearchResults.IsValidIndex(ResultIndex) || SearchCache.IsTrimmed(ResultIndex))
+		return nullptr;
+
+	return &LastSessionSearch->SearchResults[ResultIndex];
+}
+
+double UMultiplayerSessionsSubsystem::GetSearchResultAge(int32 ResultIndex) const
+{
+	return SearchCache.GetAge(ResultIndex);
+}
+
+TConstArrayView<FMultiplayerSessionSummary> UMultiplayerSessionsSubsystem::GetSessionSummaries() const
+{
+	return SearchCache.GetSummaries();
+}
+
+uint16 UMultiplayerSessionsSubsystem::FindMatchTypeId(const FString& InMatchType) const
+{
+	return SearchCache.FindMatchTypeId(InMatchType);
+}
+
+const FString& UMultiplayerSessionsSubsystem::GetMatchTypeName(uint16 MatchTypeId) const
+{
+	return SearchCache.GetMatchTypeName(MatchTypeId);
+}
+
+FString UMultiplayerSessionsSubsystem::GetSessionAddress(FName SessionName /*= NAME_GameSession*/)
+{
+	if (!ResolveSessionBackend())
+		return TEXT("");
+
+	FString Address;
+	bool bWasSuccessful = SessionBackend->GetResolvedConnectString(SessionName, Address);
+	if(!bWasSuccessful)
+		return TEXT("");
+
+	return Address;
+}
+
+bool UMultiplayerSessionsSubsystem::GetIsLanMatch() const
+{
+	if(!ResolveSessionBackend())
+		return false;
+
+	const FName BackendName{ SessionBackend->GetBackendName() };
+	return BackendName == NULL_SUBSYSTEM || BackendName == FMultiplayerSessionsLanBackend::BackendName;
+}
+
+bool UMultiplayerSessionsSubsystem::GetOnlineSubsystemAvailable() const
+{
+	return ResolveSessionBackend();
+}
+
+void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessfull)
+{
+	//Another session of ours finished in the background, the one we are waiting for is still on its way
+	if(!SessionBackend.IsValid() || SessionName != OperationSessionName)
+		return;
+
+	SessionBackend->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+
+	if (SessionName == NAME_GameSession)
+	{
+		if (bWasSuccessfull)
+		{
+			StartAdmission();
+		}
+		else
+		{
+			StopLatencyEchoServer();
+		}
+	}
+
+	// Broadcast our own custom delegate
+	LatencyTracker.End(EMultiplayerSessionOperation::Create, bWasSuccessfull, TEXT("BackendFailure"));
+	MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessfull);
+
+	OperationQueue.CompleteActive(EMultiplayerSessionOperation::Create, SessionName);
+}
+
+void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessfull)
+{
+	if(!SessionBackend.IsValid())
+		return;
+
+	MULTIPLAYER_LOG(Log, TEXT("Finding finished"));
+
+	SessionBackend->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
+
+	if (bIsRefreshSearch)
+	{
+		CompleteRefreshSearch(bWasSuccessfull);
+		OperationQueue.CompleteActive(EMultiplayerSessionOperation::Find);
+		return;
+	}
+
+	//Hand out whatever was not streamed yet before the final event
+	if (SearchStreamBatchSize > 0)
+	{
+		FlushSearchStream(true);
+	}
+	StopSearchStream();
+
+	//Too few qualified, ask again for more. The operation stays active and its timeout covers every round
+	if(TryWidenSearch(bWasSuccessfull))
+		return;
+
+	//Timed up to the backend answering, the indexing below is ours
+	LatencyTracker.End(EMultiplayerSessionOperation::Find, !LastSessionSearch->SearchResults.IsEmpty(), bWasSuccessfull ? TEXT("NoResults") : TEXT("BackendFailure"));
+
+	//The backend is done either way, the next operation does not have to wait for our indexing
+	if (StartResultsProcessing(false, bWasSuccessfull))
+	{
+		OperationQueue.CompleteActive(EMultiplayerSessionOperation::Find);
+		return;
+	}
+
+	SearchCache.IndexResults(LastSessionSearch->SearchResults);
+
+	if (bWasSuccessfull)
+	{
+		LastSearchCompletedTime = FPlatformTime::Seconds();
+	}
+
+	//Broadcast our own custom delegate
+	const uint32 SearchGeneration{ SearchCache.GetGeneration() };
+	MultiplayerOnFindSessionComplete.Broadcast(LastSessionSearch->SearchResults, !LastSessionSearch->SearchResults.IsEmpty());
+	TrimSearchResultsAfterBroadcast(SearchGeneration);
+
+	OperationQueue.CompleteActive(EMultiplayerSessionOperation::Find);
+}
 
-UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
-	CreateSessionCompleteDelegate{ FOnCreateSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnCreateSessionComplete) },
-	FindSessionsCompleteDelegate{ FOnFindSessionsCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnFindSessionsComplete) },
-	JoinSessionCompleteDelegate{ FOnJoinSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnJoinSessionComplete) },
-	DestroySessionCompleteDelegate{ FOnDestroySessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnDestroySessionComplete) },
-	StartSessionCompleteDelegate{ FOnStartSessionCompleteDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::OnStartSessionComplete)}
+void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
 {
-	IOnlineSubsystem* Subsystem{ IOnlineSubsystem::Get() };
-	if (Subsystem)
+	if (!SessionBackend.IsValid() || SessionName != OperationSessionName)
+		return;
+
+	SessionBackend->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
+
+	if (ActiveJoinResultIndex != INDEX_NONE)
+	{
+		//Full or gone hosts won't get better, anything else is on our side and retrying elsewhere won't help
+		const bool bShouldTryNext{ Result == EOnJoinSessionCompleteResult::SessionIsFull || Result == EOnJoinSessionCompleteResult::SessionDoesNotExist };
+		if (bShouldTryNext)
+		{
+			MULTIPLAYER_LOG(Warning, TEXT("Join failed with %s, trying the next candidate"), LexToString(Result));
+			SearchCache.MarkStale(ActiveJoinResultIndex);
+
+			if (TryNextJoinCandidate())
+				return;
+		}
+
+		ActiveJoinResultIndex = INDEX_NONE;
+		JoinCandidates.Reset();
+	}
+
+	const bool bWasSuccessfull{ Result == EOnJoinSessionCompleteResult::Success || Result == EOnJoinSessionCompleteResult::AlreadyInSession };
+	//A party can't be reconnected to by address, only the game session is remembered
+	if (bWasSuccessfull && SessionName == NAME_GameSession && bReconnectRecordEnabled)
 	{
-		SessionInterface = Subsystem->GetSessionInterface();
+		SaveReconnectRecord();
 	}
 
+	LatencyTracker.End(EMultiplayerSessionOperation::Join, bWasSuccessfull, LexToString(Result));
+	MultiplayerOnJoinSessionComplete.Broadcast(Result);
+
+	OperationQueue.CompleteActive(EMultiplayerSessionOperation::Join, SessionName);
 }
 
-void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType)
+void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessfull)
 {
-	if (!SessionInterface.IsValid())
+	if(!SessionBackend.IsValid() || SessionName != OperationSessionName)
+		return;
+		
+	SessionBackend->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+
+	if (bWasSuccessfull && SessionName == NAME_GameSession)
 	{
-		// Broadcast failed
+		StopAdmission();
+	}
+
+	MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessfull);
+
+	//The old session was in the way of a CreateSession, still the same operation
+	FMultiplayerNamedSessionState* SessionState{ SessionStates.Find(SessionName) };
+	if (SessionState && SessionState->bCreateSessionOnDestroy)
+	{
+		SessionState->bCreateSessionOnDestroy = false;
+
+		if (bWasSuccessfull && StartCreateSession(SessionName))
+			return;
+
+		LatencyTracker.End(EMultiplayerSessionOperation::Create, false, TEXT("DestroyFailed"));
 		MultiplayerOnCreateSessionComplete.Broadcast(false);
+		OperationQueue.CompleteActive(EMultiplayerSessionOperation::Create, SessionName);
 		return;
 	}
 
-	auto ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSession)
+	//Left on purpose, nothing to come back to
+	if (bWasSuccessfull && SessionName == NAME_GameSession)
 	{
-		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = NumPublicConnections;
-		LastMatchType = MatchType;
+		if (bReconnectRecordEnabled)
+		{
+			ClearReconnectRecord();
+		}
 
+		StopLatencyEchoServer();
 	}
 
-	//Fill session settings
-	LastSessionSettings = MakeShareable(new FOnlineSessionSettings);
-	LastSessionSettings->bIsLANMatch = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL";
-	LastSessionSettings->NumPublicConnections = NumPublicConnections;
-	LastSessionSettings->bAllowJoinInProgress = true;
-	LastSessionSettings->bAllowJoinViaPresence = true;
-	LastSessionSettings->bUsesPresence = true;
-	LastSessionSettings->bShouldAdvertise = true;
-	LastSessionSettings->bUseLobbiesIfAvailable = true;
-	LastSessionSettings->Set(FName("MatchType"), MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->Set(FName("GameName"), FString("ShooterJam"), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->BuildUniqueId = 1;
+	LatencyTracker.End(EMultiplayerSessionOperation::Destroy, bWasSuccessfull, TEXT("BackendFailure"));
+	OperationQueue.CompleteActive(EMultiplayerSessionOperation::Destroy, SessionName);
+}
 
-	UWorld* World{ GetWorld() };
-	if(!World)
+void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessfull)
+{
+	if(!SessionBackend.IsValid() || SessionName != OperationSessionName)
 		return;
 
-	const ULocalPlayer* LocalPlayer{ World->GetFirstLocalPlayerFromController() };
-	if(!LocalPlayer)
+	SessionBackend->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate_Handle);
+
+	LatencyTracker.End(EMultiplayerSessionOperation::Start, bWasSuccessfull, TEXT("BackendFailure"));
+	MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessfull);
+
+	OperationQueue.CompleteActive(EMultiplayerSessionOperation::Start, SessionName);
+}
+
+void UMultiplayerSessionsSubsystem::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessfull)
+{
+	if(!SessionBackend.IsValid() || SessionName != OperationSessionName)
 		return;
 
-	//Store the delegate in a FDelegateHandle so we can later remove it from the delegate list
-	CreateSessionCompleteDelegate_Handle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
+	SessionBackend->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate_Handle);
 
-	//Create session
-	bool bWasSuccessfull = SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings);
-	if (!bWasSuccessfull)
+	//Resized sessions keep their players and reservations, only the number of slots changes
+	const FNamedOnlineSession* UpdatedSession{ SessionBackend->GetNamedSession(SessionName) };
+	if (bWasSuccessfull && SessionName == NAME_GameSession && UpdatedSession && Admission.IsActive())
 	{
-		//If session creation was failed - remove delegate from SessionInterface
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
-
-		// Broadcast our own custom delegate
-		MultiplayerOnCreateSessionComplete.Broadcast(false);
+		Admission.SetNumSlots(UpdatedSession->SessionSettings.NumPublicConnections);
 	}
+
+	LatencyTracker.End(EMultiplayerSessionOperation::Update, bWasSuccessfull, TEXT("BackendFailure"));
+	MultiplayerOnUpdateSessionComplete.Broadcast(bWasSuccessfull);
+
+	OperationQueue.CompleteActive(EMultiplayerSessionOperation::Update, SessionName);
+}
+
+void UMultiplayerSessionsSubsystem::ResolveCreateSession(bool bWasSuccessfull)
+{
+	FMultiplayerSessionResult Result;
+	Result.SessionName = OperationSessionName;
+	Result.bWasSuccessfull = bWasSuccessfull;
+	PendingCreateResults.ResolveRunning(Result);
+}
+
+void UMultiplayerSessionsSubsystem::ResolveDestroySession(bool bWasSuccessfull)
+{
+	FMultiplayerSessionResult Result;
+	Result.SessionName = OperationSessionName;
+	Result.bWasSuccessfull = bWasSuccessfull;
+	PendingDestroyResults.ResolveRunning(Result);
+}
+
+void UMultiplayerSessionsSubsystem::ResolveStartSession(bool bWasSuccessfull)
+{
+	FMultiplayerSessionResult Result;
+	Result.SessionName = OperationSessionName;
+	Result.bWasSuccessfull = bWasSuccessfull;
+	PendingStartResults.ResolveRunning(Result);
+}
+
+void UMultiplayerSessionsSubsystem::ResolveUpdateSession(bool bWasSuccessfull)
+{
+	FMultiplayerSessionResult Result;
+	Result.SessionName = OperationSessionName;
+	Result.bWasSuccessfull = bWasSuccessfull;
+	PendingUpdateResults.ResolveRunning(Result);
+}
+
+void UMultiplayerSessionsSubsystem::ResolveFindSessions(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull)
+{
+	FMultiplayerFindSessionsResult Result;
+	Result.Search = LastSessionSearch;
+	Result.bWasSuccessfull = bWasSuccessfull;
+	PendingFindResults.ResolveRunning(Result);
 }
 
-void UMultiplayerSessionsSubsystem::CreateSession(const FMultiplayerMatchSettings& InMatchSettings)
+void UMultiplayerSessionsSubsystem::ResolveFindBestSession(const TArray<FMultiplayerRankedSession>& InRankedSessions, bool bWasSuccessfull)
 {
-	if (!SessionInterface.IsValid())
+	TArray<TPromise<FMultiplayerFindBestSessionResult>> Resolved{ MoveTemp(PendingFindBestResults) };
+	PendingFindBestResults.Reset();
+
+	for (TPromise<FMultiplayerFindBestSessionResult>& Promise : Resolved)
 	{
-		// Broadcast failed
-		MultiplayerOnCreateSessionComplete.Broadcast(false);
-		return;
+		FMultiplayerFindBestSessionResult Result;
+		Result.RankedSessions = InRankedSessions;
+		Result.bWasSuccessfull = bWasSuccessfull;
+		Promise.SetValue(MoveTemp(Result));
 	}
+}
 
-	auto ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSession)
+void UMultiplayerSessionsSubsystem::ResolveJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	FMultiplayerJoinSessionResult JoinResult;
+	JoinResult.SessionName = OperationSessionName;
+	JoinResult.Result = Result;
+	if (JoinResult.WasSuccessfull())
 	{
-		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = InMatchSettings.PublicConnections;
-		LastMatchType = InMatchSettings.MatchType;
-	}
-
-	//Fill session settings
-	LastSessionSettings = MakeShareable(new FOnlineSessionSettings);
-	LastSessionSettings->bIsLANMatch = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
-	LastSessionSettings->NumPublicConnections = InMatchSettings.PublicConnections;
-	LastSessionSettings->bAllowJoinInProgress = true;
-	LastSessionSettings->bAllowJoinViaPresence = true;
-	LastSessionSettings->bUsesPresence = true;
-	LastSessionSettings->bShouldAdvertise = true;
-	LastSessionSettings->bUseLobbiesIfAvailable = true;
-	LastSessionSettings->Set(FName("MatchType"), InMatchSettings.MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->Set(FName("MatchName"), InMatchSettings.MatchName, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->Set(FName("GameName"), FString("ShooterJam"), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->BuildUniqueId = 1;
-
-	UWorld* World{ GetWorld() };
-	if (!World)
-		return;
+		JoinResult.SessionAddress = GetSessionAddress(OperationSessionName);
+	}
 
-	const ULocalPlayer* LocalPlayer{ World->GetFirstLocalPlayerFromController() };
-	if (!LocalPlayer)
-		return;
+	PendingJoinResults.ResolveRunning(JoinResult);
+}
 
-	//Store the delegate in a FDelegateHandle so we can later remove it from the delegate list
-	CreateSessionCompleteDelegate_Handle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
+void UMultiplayerSessionsSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	LatencyTracker.End(EMultiplayerSessionOperation::Travel, true);
 
-	//Create session
-	bool bWasSuccessfull = SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings);
-	if (!bWasSuccessfull)
+	//A failed connection brings us back to the default map, that one is not the host
+	if ((ReconnectStage == EMultiplayerReconnectStage::Direct || ReconnectStage == EMultiplayerReconnectStage::Search) && LoadedWorld && LoadedWorld->GetNetMode() == NM_Client)
 	{
-		//If session creation was failed - remove delegate from SessionInterface
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+		CompleteReconnect(true);
+	}
 
-		// Broadcast our own custom delegate
-		MultiplayerOnCreateSessionComplete.Broadcast(false);
+	//Either it was used just now or we went somewhere else, holding on to it only costs memory
+	if (PreloadedWorld || !PreloadingMapName.IsNone())
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("Releasing preloaded map %s"), *PreloadingMapName.ToString());
+		ReleasePreloadedMap();
 	}
 }
 
-void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults)
+void UMultiplayerSessionsSubsystem::OnMapPreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
 {
-	LogVerbose(TEXT("Searching for sessions"));
+	//Released or replaced by another map while loading
+	if(PackageName != PreloadingMapName)
+		return;
 
-	if (!SessionInterface.IsValid())
+	UWorld* LoadedWorld{ LoadedPackage && Result == EAsyncLoadingResult::Succeeded ? UWorld::FindWorldInPackage(LoadedPackage) : nullptr };
+	if (!LoadedWorld)
 	{
-		MultiplayerOnFindSessionComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
-		LogError(TEXT("No session interface available"));
+		MULTIPLAYER_LOG(Warning, TEXT("Failed to preload %s, travel will load it from disk"), *PackageName.ToString());
+		ReleasePreloadedMap();
 		return;
 	}
 
-	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
-	LastSessionSearch->MaxSearchResults = MaxSearchResults;
-	LastSessionSearch->bIsLanQuery = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL";
-	LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
-	LastSessionSearch->QuerySettings.Set(FName("GameName"), FString("ShooterJam"), EOnlineComparisonOp::Equals);
+	MULTIPLAYER_LOG(Verbose, TEXT("Preloaded %s in %.0f ms"), *PackageName.ToString(), (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
 
+	PreloadedMapPackage = LoadedPackage;
+	PreloadedWorld = LoadedWorld;
+}
 
-	LogVerbose(FString::Printf(TEXT("Is lan query: %d"), LastSessionSearch->bIsLanQuery));
-
-	if(!GetWorld())
-		return;
+void UMultiplayerSessionsSubsystem::OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString)
+{
+	LatencyTracker.End(EMultiplayerSessionOperation::Travel, false, ETravelFailure::ToString(FailureType));
 
-	const ULocalPlayer* LocalPlayer{ GetWorld()->GetFirstLocalPlayerFromController() };
-	if(!LocalPlayer)
-		return;
+	if (ReconnectStage == EMultiplayerReconnectStage::Direct)
+	{
+		StartReconnectSearch();
+	}
+	else if (ReconnectStage == EMultiplayerReconnectStage::Search)
+	{
+		CompleteReconnect(false);
+	}
+}
 
-	FindSessionsCompleteDelegate_Handle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
+void UMultiplayerSessionsSubsystem::OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString)
+{
+	LatencyTracker.End(EMultiplayerSessionOperation::Travel, false, ENetworkFailure::ToString(FailureType));
 
-	bool bWasSuccessfull = SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(), LastSessionSearch.ToSharedRef());
-	if (!bWasSuccessfull)
+	if (ReconnectStage == EMultiplayerReconnectStage::Direct)
 	{
-		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
-		MultiplayerOnFindSessionComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		StartReconnectSearch();
+	}
+	else if (ReconnectStage == EMultiplayerReconnectStage::Search)
+	{
+		CompleteReconnect(false);
 	}
 }
 
-void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& FindSessionsResult)
+void UMultiplayerSessionsSubsystem::OnReconnectRecordLoaded(const FString& SlotName, const int32 UserIndex, USaveGame* SaveGame)
 {
-	if (!SessionInterface.IsValid())
+	bReconnectRecordLoaded = true;
+
+	//Joined something while the slot was loading, that one is newer
+	if (!ReconnectRecord)
 	{
-		MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		ReconnectRecord = Cast<UMultiplayerSessionsReconnectRecord>(SaveGame);
 	}
 
-	LogVerbose(TEXT("Connecting.."));
-
-	if (!GetWorld())
+	if(ReconnectStage != EMultiplayerReconnectStage::Loading)
 		return;
 
-	const ULocalPlayer* LocalPlayer{ GetWorld()->GetFirstLocalPlayerFromController() };
-	if (!LocalPlayer)
-		return;
+	APlayerController* PlayerController{ ReconnectPlayerController.Get() };
+	ReconnectStage = EMultiplayerReconnectStage::None;
+	ReconnectPlayerController.Reset();
 
-	JoinSessionCompleteDelegate_Handle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
-	bool bWasSuccessfull{ SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, FindSessionsResult) };
-	if (!bWasSuccessfull)
+	if (!StartDirectReconnect(PlayerController))
 	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
-		MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		CompleteReconnect(false);
 	}
 }
 
-void UMultiplayerSessionsSubsystem::JoinSession(const FString& InSessionId)
+void UMultiplayerSessionsSubsystem::SaveReconnectRecord()
 {
-	LogVerbose(FString::Printf(TEXT("Trying to join using session id %s"), *InSessionId));
+	if(!SessionBackend.IsValid())
+		return;
 
-	if (!LastSessionSearch.IsValid())
-	{
-		LogVerbose(FString::Printf(TEXT("Failed to join using session id %s, not found on search list"), *InSessionId));
+	const FNamedOnlineSession* JoinedSession{ SessionBackend->GetNamedSession(NAME_GameSession) };
+	const FString SessionAddress{ GetSessionAddress() };
+	if(!JoinedSession || !JoinedSession->SessionInfo.IsValid() || SessionAddress.IsEmpty())
 		return;
-	}
 
-	for (const FOnlineSessionSearchResult& SearchResult : LastSessionSearch->SearchResults)
+	if (!ReconnectRecord)
 	{
-		if (SearchResult.GetSessionIdStr() == InSessionId)
-		{
-			JoinSession(SearchResult);
-		}
+		ReconnectRecord = NewObject<UMultiplayerSessionsReconnectRecord>(this);
 	}
+
+	ReconnectRecord->SessionId = JoinedSession->GetSessionIdStr();
+	ReconnectRecord->SessionAddress = SessionAddress;
+	ReconnectRecord->MatchType.Reset();
+	MultiplayerSessionAttributes::MatchType.TryRead(JoinedSession->SessionSettings, ReconnectRecord->MatchType);
+	ReconnectRecord->JoinedTime = FDateTime::UtcNow();
+
+	UGameplayStatics::AsyncSaveGameToSlot(ReconnectRecord, UMultiplayerSessionsReconnectRecord::SlotName, 0);
 }
 
-void UMultiplayerSessionsSubsystem::DestroySession()
+void UMultiplayerSessionsSubsystem::StartReconnectSearch()
 {
-	if (!SessionInterface.IsValid())
+	if(!ReconnectRecord)
 	{
-		MultiplayerOnDestroySessionComplete.Broadcast(false);
+		CompleteReconnect(false);
 		return;
 	}
 
-	DestroySessionCompleteDelegate_Handle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
+	MULTIPLAYER_LOG(Warning, TEXT("Host did not answer at its old address, looking up session %s"), *ReconnectRecord->SessionId);
+
+	ReconnectStage = EMultiplayerReconnectStage::Search;
+
+	JoinSessionByIdAsync(ReconnectRecord->SessionId, ReconnectRecord->MatchType).Next([WeakThis = TWeakObjectPtr<UMultiplayerSessionsSubsystem>(this)](const FMultiplayerJoinSessionResult& JoinResult)
+	{
+		UMultiplayerSessionsSubsystem* Subsystem{ WeakThis.Get() };
+		if(!Subsystem || Subsystem->ReconnectStage != EMultiplayerReconnectStage::Search)
+			return;
+
+		//The failed direct attempt sent us back to the default map, with a new player controller
+		UGameInstance* GameInstance{ Subsystem->GetGameInstance() };
+		APlayerController* PlayerController{ GameInstance ? GameInstance->GetFirstLocalPlayerController() : nullptr };
+
+		//OnPostLoadMap completes the reconnect once we are there
+		if(JoinResult.WasSuccessfull() && Subsystem->TravelToSession(PlayerController))
+			return;
+
+		Subsystem->CompleteReconnect(false);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::CompleteReconnect(bool bWasSuccessfull)
+{
+	ReconnectStage = EMultiplayerReconnectStage::None;
 
-	bool bWasSuccessfull{ SessionInterface->DestroySession(NAME_GameSession) };
 	if (!bWasSuccessfull)
 	{
-		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
-		MultiplayerOnDestroySessionComplete.Broadcast(false);
+		MULTIPLAYER_LOG(Error, TEXT("Failed to reconnect to the last session"));
 	}
+
+	MultiplayerOnReconnectComplete.Broadcast(bWasSuccessfull);
 }
 
-void UMultiplayerSessionsSubsystem::StartSession()
+TFuture<TOptional<FOnlineSessionSearchResult>> UMultiplayerSessionsSubsystem::FindSessionByIdAsync(const FString& InSessionId)
 {
+	//One lookup at a time, whoever comes second searches instead
+	if(!ResolveSessionBackend() || FindSessionByIdPromise.IsValid())
+		return TFuture<TOptional<FOnlineSessionSearchResult>>();
+
+	//Set up before asking, a backend may answer right away
+	FindSessionByIdPromise = MakeShared<TPromise<TOptional<FOnlineSessionSearchResult>>>();
+	TFuture<TOptional<FOnlineSessionSearchResult>> Future{ FindSessionByIdPromise->GetFuture() };
+
+	FindSessionByIdCompleteDelegate_Handle = SessionBackend->AddOnFindSessionByIdCompleteDelegate_Handle(FindSessionByIdCompleteDelegate);
 
+	bool bWasSuccessfull{ SessionBackend->FindSessionById(GetLocalUserId(), InSessionId) };
+	if (!bWasSuccessfull)
+	{
+		SessionBackend->ClearOnFindSessionByIdCompleteDelegate_Handle(FindSessionByIdCompleteDelegate_Handle);
+		FindSessionByIdPromise->SetValue(TOptional<FOnlineSessionSearchResult>());
+		FindSessionByIdPromise.Reset();
+		return TFuture<TOptional<FOnlineSessionSearchResult>>();
+	}
+
+	return Future;
 }
 
-void UMultiplayerSessionsSubsystem::SetLogToScreen(bool bInLogToScreen)
+void UMultiplayerSessionsSubsystem::OnFindSessionByIdComplete(bool bWasSuccessfull, const FOnlineSessionSearchResult& SearchResult)
 {
-	bLogToScreen = bInLogToScreen;
+	if (SessionBackend.IsValid())
+	{
+		SessionBackend->ClearOnFindSessionByIdCompleteDelegate_Handle(FindSessionByIdCompleteDelegate_Handle);
+	}
+
+	//Whoever waits may look up the next session from the continuation
+	const TSharedPtr<TPromise<TOptional<FOnlineSessionSearchResult>>> Promise{ MoveTemp(FindSessionByIdPromise) };
+	FindSessionByIdPromise.Reset();
+	if(!Promise.IsValid())
+		return;
+
+	Promise->SetValue(bWasSuccessfull ? TOptional<FOnlineSessionSearchResult>(SearchResult) : TOptional<FOnlineSessionSearchResult>());
 }
 
-FString UMultiplayerSessionsSubsystem::GetSessionAddress()
+bool UMultiplayerSessionsSubsystem::TickSearchStream(float DeltaTime)
 {
-	if (!SessionInterface.IsValid())
-		return TEXT("");
+	if (!LastSessionSearch.IsValid())
+	{
+		SearchStreamTicker_Handle.Reset();
+		return false;
+	}
 
-	FString Address;
-	bool bWasSuccessful = SessionInterface->GetResolvedConnectString(NAME_GameSession, Address);
-	if(!bWasSuccessful)
-		return TEXT("");
+	const TSharedPtr<FOnlineSessionSearch> StreamedSearch{ LastSessionSearch };
+	if (SearchStreamBatchSize > 0)
+	{
+		FlushSearchStream(false);
+	}
 
-	return Address;
+	//A listener cancelled or replaced the search, StopSearchStream already let go of this ticker
+	if (LastSessionSearch != StreamedSearch || (SearchStreamBatchSize <= 0 && !bIsAdaptiveSearch))
+		return false;
+
+	//Enough qualified sessions are in, the rest of the search is not worth waiting for
+	if (bIsAdaptiveSearch && CountQualifiedResults() >= LastSearchSettings.NumWantedResults)
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("%d sessions qualified, stopping the search early"), NumQualifiedResults);
+
+		//Hand out the rest first, stopping the search stops the stream too
+		if (SearchStreamBatchSize > 0)
+		{
+			FlushSearchStream(true);
+			if(LastSessionSearch != StreamedSearch || !bIsAdaptiveSearch)
+				return false;
+		}
+
+		StopActiveSearch();
+		OnFindSessionsComplete(true);
+		return false;
+	}
+
+	if (LastSessionSearch->SearchState == EOnlineAsyncTaskState::InProgress)
+		return true;
+
+	//Search is over, OnFindSessionsComplete flushes the rest
+	SearchStreamTicker_Handle.Reset();
+	return false;
 }
 
-bool UMultiplayerSessionsSubsystem::GetIsLanMatch() const
+void UMultiplayerSessionsSubsystem::FlushSearchStream(bool bFlushPartialBatch)
 {
-	return Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
+	if (!LastSessionSearch.IsValid())
+		return;
+
+	//Keep the search alive, a listener may cancel it or start a new one from the batch callback
+	const TSharedPtr<FOnlineSessionSearch> StreamedSearch{ LastSessionSearch };
+	const TArray<FOnlineSessionSearchResult>& SearchResults{ StreamedSearch->SearchResults };
+	SearchCache.IndexResults(SearchResults);
+	while (NumStreamedResults < SearchResults.Num())
+	{
+		const int32 NumPending{ SearchResults.Num() - NumStreamedResults };
+		if (NumPending < SearchStreamBatchSize && !bFlushPartialBatch)
+			return;
+
+		const int32 NumInBatch{ FMath::Min(NumPending, SearchStreamBatchSize) };
+		const int32 FirstResultIndex{ NumStreamedResults };
+		NumStreamedResults += NumInBatch;
+
+		MultiplayerOnFindSessionsBatch.Broadcast(MakeArrayView(SearchResults.GetData() + FirstResultIndex, NumInBatch), FirstResultIndex);
+
+		if (LastSessionSearch != StreamedSearch || SearchStreamBatchSize <= 0)
+			return;
+	}
 }
 
-bool UMultiplayerSessionsSubsystem::GetOnlineSubsystemAvailable() const
+void UMultiplayerSessionsSubsystem::StopSearchStream()
 {
-	return Online::GetSubsystem(GetWorld()) != nullptr;
+	if (SearchStreamTicker_Handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(SearchStreamTicker_Handle);
+		SearchStreamTicker_Handle.Reset();
+	}
+
+	SearchStreamBatchSize = 0;
 }
 
-void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessfull)
+void UMultiplayerSessionsSubsystem::StartBackgroundRefresh(const FMultiplayerSearchSettings& InSearchSettings, float IntervalSeconds /*= 15.f*/)
 {
-	if(!SessionInterface.IsValid())
-		return;
+	StopBackgroundRefresh();
 
-	SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate_Handle);
+	//Nobody listens to refresh batches, and a refresh is never served from the cache it is refreshing
+	RefreshSearchSettings = InSearchSettings;
+	RefreshSearchSettings.BatchSize = 0;
+	RefreshSearchSettings.MaxCacheAge = 0.f;
+	RefreshInterval = FMath::Max(IntervalSeconds, 1.f);
+	NextRefreshTime = 0.0;
 
-	// Broadcast our own custom delegate
-	MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessfull);
+	RefreshTicker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickBackgroundRefresh), RefreshTickInterval);
 }
 
-void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessfull)
+void UMultiplayerSessionsSubsystem::StopBackgroundRefresh()
 {
-	if(!SessionInterface.IsValid())
+	YieldRefreshSearch();
+
+	if(!RefreshTicker_Handle.IsValid())
 		return;
 
-	LogSuccess(TEXT("Finding finished"));
+	FTSTicker::GetCoreTicker().RemoveTicker(RefreshTicker_Handle);
+	RefreshTicker_Handle.Reset();
+}
 
-	SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate_Handle);
+bool UMultiplayerSessionsSubsystem::IsSearchCacheFresh(const FMultiplayerSearchSettings& InSearchSettings, float MaxAge) const
+{
+	if(!LastSessionSearch.IsValid() || LastSearchCompletedTime <= 0.0)
+		return false;
 
-	//Broadcast our own custom delegate
-	MultiplayerOnFindSessionComplete.Broadcast(LastSessionSearch->SearchResults, !LastSessionSearch->SearchResults.IsEmpty());
+	//A cache that was cut off at fewer results than asked for may miss what the caller is after
+	if(!LastSearchSettings.HasSameFilters(InSearchSettings) || LastSearchSettings.MaxSearchResults < InSearchSettings.MaxSearchResults)
+		return false;
+
+	//An adaptive search stops at what it wanted, which is too little for anyone wanting more
+	if(LastSearchSettings.NumWantedResults > 0 && (InSearchSettings.NumWantedResults <= 0 || InSearchSettings.NumWantedResults > LastSearchSettings.NumWantedResults))
+		return false;
+
+	const double Age{ FPlatformTime::Seconds() - LastSearchCompletedTime };
+	return Age <= FMath::Min(MaxAge, SearchResultTimeToLive);
 }
 
-void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+bool UMultiplayerSessionsSubsystem::TickBackgroundRefresh(float DeltaTime)
 {
-	if (!SessionInterface.IsValid())
-		return;
+	const double Now{ FPlatformTime::Seconds() };
 
-	SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate_Handle);
-	MultiplayerOnJoinSessionComplete.Broadcast(Result);
+	//Hosts not reported for a while are likely full or gone
+	const int32 NumExpired{ SearchCache.ExpireSeenBefore(Now - SearchResultTimeToLive) };
+	if (NumExpired > 0)
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("%d cached sessions expired"), NumExpired);
+	}
+
+	if(Now < NextRefreshTime || !ResolveSessionBackend())
+		return true;
+
+	//Only when the backend has nothing else to do, and there is no point in refreshing from inside a session
+	const bool bIsIdle{ !OperationQueue.GetActiveHandle().IsValid() && OperationQueue.GetNumPending() == 0 };
+	if(!bIsIdle || !CanReplaceSearchResults() || SessionBackend->GetNamedSession(NAME_GameSession))
+		return true;
+
+	NextRefreshTime = Now + RefreshInterval;
+
+	MULTIPLAYER_LOG(VeryVerbose, TEXT("Refreshing search cache"));
+
+	OperationQueue.Enqueue(EMultiplayerSessionOperation::Find,
+		[this, SearchSettings = RefreshSearchSettings]() { return ExecuteRefreshSearch(SearchSettings); },
+		[this](EMultiplayerOperationAbortReason Reason) { AbortFindSessions(Reason); },
+		FindSessionsTimeout);
+
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessfull)
+void UMultiplayerSessionsSubsystem::CompleteRefreshSearch(bool bWasSuccessfull)
 {
-	if(!SessionInterface.IsValid())
+	bIsRefreshSearch = false;
+	TSharedPtr<FOnlineSessionSearch> RefreshedSearch{ MoveTemp(RefreshSessionSearch) };
+
+	//Keep the old results, they expire on their own
+	if (!bWasSuccessfull || !RefreshedSearch.IsValid())
+	{
+		RecycleSessionSearch(MoveTemp(RefreshedSearch));
 		return;
-		
-	SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate_Handle);
+	}
 
-	if (bCreateSessionOnDestroy && bWasSuccessfull)
+	if (!CanReplaceSearchResults())
 	{
-		bCreateSessionOnDestroy = false;
-		CreateSession(LastNumPublicConnections, LastMatchType);
+		MULTIPLAYER_LOG(Verbose, TEXT("Dropping refreshed search results, the current ones are in use"));
+		RecycleSessionSearch(MoveTemp(RefreshedSearch));
+		return;
 	}
 
-	MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessfull);
+	RecycleSessionSearch(MoveTemp(LastSessionSearch));
+	LastSessionSearch = MoveTemp(RefreshedSearch);
+	LastSearchSettings = RefreshSearchSettings;
+	LastSearchCompletedTime = 0.0;
+	SearchCache.Reset();
+	RankedSessions.Reset();
+
+	if(StartResultsProcessing(true, true))
+		return;
+
+	SearchCache.IndexResults(LastSessionSearch->SearchResults);
+	LastSearchCompletedTime = FPlatformTime::Seconds();
+
+	const uint32 SearchGeneration{ SearchCache.GetGeneration() };
+	MultiplayerOnSearchCacheRefreshed.Broadcast();
+	TrimSearchResultsAfterBroadcast(SearchGeneration);
 }
 
-void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessfull)
+void UMultiplayerSessionsSubsystem::YieldRefreshSearch()
 {
+	if(!bIsRefreshSearch || !OperationQueue.IsActive(EMultiplayerSessionOperation::Find))
+		return;
 
+	OperationQueue.Cancel(OperationQueue.GetActiveHandle(), true);
 }
 
-void UMultiplayerSessionsSubsystem::LogError(FString ErrorText)
+bool UMultiplayerSessionsSubsystem::CanReplaceSearchResults() const
 {
-	DebugLog(ErrorText, FColor::Red);
+	return JoinCandidates.IsEmpty() && ActiveJoinResultIndex == INDEX_NONE && ProbeCandidates.IsEmpty() && !ProcessedSearch.IsValid()
+		&& !OperationQueue.IsActive(EMultiplayerSessionOperation::Join) && !OperationQueue.IsPending(EMultiplayerSessionOperation::Join);
 }
 
-void UMultiplayerSessionsSubsystem::LogWarning(FString WarningText)
+bool UMultiplayerSessionsSubsystem::StartResultsProcessing(bool bIsRefresh, bool bWasSuccessfull)
 {
-	DebugLog(WarningText, FColor::Yellow);
+	StopResultsProcessing();
+
+	if(!LastSessionSearch.IsValid() || LastSearchSettings.ProcessingBudgetMs <= 0.f)
+		return false;
+
+	const int32 NumResults{ LastSessionSearch->SearchResults.Num() };
+	if(SearchCache.GetNumIndexed() >= NumResults)
+		return false;
+
+	ProcessedSearch = LastSessionSearch;
+	ResultsProcessingBudgetMs = LastSearchSettings.ProcessingBudgetMs;
+	bIsProcessingRefresh = bIsRefresh;
+	bProcessedSearchSucceeded = bWasSuccessfull;
+
+	//The search is complete, nobody appends to its results anymore, so the task can read them while we keep it alive
+	if (LastSearchSettings.bParseOnWorkerThreads)
+	{
+		FirstParsedResultIndex = SearchCache.GetNumIndexed();
+		ParseResultsTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Search = ProcessedSearch, FirstResultIndex = FirstParsedResultIndex]()
+		{
+			const TArray<FOnlineSessionSearchResult>& SearchResults{ Search->SearchResults };
+
+			TArray<FMultiplayerSessionsSearchCache::FParsedResult> ParsedResults;
+			ParsedResults.Reserve(SearchResults.Num() - FirstResultIndex);
+			for (int32 ResultIndex{ FirstResultIndex }; ResultIndex < SearchResults.Num(); ++ResultIndex)
+			{
+				ParsedResults.Add(FMultiplayerSessionsSearchCache::ParseResult(SearchResults[ResultIndex]));
+			}
+
+			return ParsedResults;
+		});
+	}
+
+	MULTIPLAYER_LOG(Verbose, TEXT("Indexing %d sessions at %.1f ms per frame"), NumResults - SearchCache.GetNumIndexed(), ResultsProcessingBudgetMs);
+
+	ResultsProcessingTicker_Handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UMultiplayerSessionsSubsystem::TickResultsProcessing));
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::LogSuccess(FString SuccessText)
+bool UMultiplayerSessionsSubsystem::TickResultsProcessing(float DeltaTime)
 {
-	DebugLog(SuccessText, FColor::Green);
+	//Replaced by a newer search, StopResultsProcessing already let go of this ticker
+	if(!ProcessedSearch.IsValid() || ProcessedSearch != LastSessionSearch)
+		return false;
+
+	const double EndTime{ FPlatformTime::Seconds() + ResultsProcessingBudgetMs / 1000.0 };
+	bool bIsDone{ false };
+
+	if (ParseResultsTask.IsValid())
+	{
+		if(!ParseResultsTask.IsCompleted())
+			return true;
+
+		bIsDone = SearchCache.IndexParsedResults(ParseResultsTask.GetResult(), FirstParsedResultIndex, EndTime);
+	}
+	else
+	{
+		bIsDone = SearchCache.IndexResults(ProcessedSearch->SearchResults, EndTime);
+	}
+
+	MultiplayerOnSearchResultsProgress.Broadcast(SearchCache.GetNumIndexed(), ProcessedSearch->SearchResults.Num());
+
+	if(!bIsDone)
+		return true;
+
+	//A listener may start the next search from the final event
+	const bool bWasRefresh{ bIsProcessingRefresh };
+	const bool bWasSuccessfull{ bProcessedSearchSucceeded };
+	ResultsProcessingTicker_Handle.Reset();
+	StopResultsProcessing();
+
+	if (bWasSuccessfull)
+	{
+		LastSearchCompletedTime = FPlatformTime::Seconds();
+	}
+
+	const uint32 SearchGeneration{ SearchCache.GetGeneration() };
+	if (bWasRefresh)
+	{
+		MultiplayerOnSearchCacheRefreshed.Broadcast();
+	}
+	else
+	{
+		MultiplayerOnFindSessionComplete.Broadcast(LastSessionSearch->SearchResults, !LastSessionSearch->SearchResults.IsEmpty());
+	}
+	TrimSearchResultsAfterBroadcast(SearchGeneration);
+
+	return false;
 }
 
-void UMultiplayerSessionsSubsystem::LogVerbose(FString VerboseText)
+void UMultiplayerSessionsSubsystem::StopResultsProcessing()
 {
-	DebugLog(VerboseText, FColor::Cyan);
+	if (ResultsProcessingTicker_Handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(ResultsProcessingTicker_Handle);
+		ResultsProcessingTicker_Handle.Reset();
+	}
+
+	//A running parse task only holds on to the search, it finishes on its own
+	ParseResultsTask = {};
+	ProcessedSearch.Reset();
+	bIsProcessingRefresh = false;
 }
 
-void UMultiplayerSessionsSubsystem::DebugLog(FString Text, FColor Color)
+void UMultiplayerSessionsSubsystem::OnLatencyProbeComplete(const TArray<int32>& RttInMs)
 {
-	if (!GEngine)
-		return;
-	
-	FString LogText = FString::Printf(TEXT("MULTIPLAYER SUBSYSTEM: %s"), *Text);
+	RankedSessions.Reset(ProbeCandidates.Num());
+	const FMultiplayerScoringWeights& Weights{ GetScoringWeights(nullptr) };
 
-	if (bLogToScreen)
+	for (int32 CandidateIndex{ 0 }; CandidateIndex < ProbeCandidates.Num() && CandidateIndex < RttInMs.Num(); ++CandidateIndex)
 	{
-		GEngine->AddOnScreenDebugMessage
-		(
-			-1,
-			10.f,
-			Color,
-			LogText
-		);
+		//Did not answer, most likely gone already
+		if(RttInMs[CandidateIndex] == INDEX_NONE)
+			continue;
+
+		//Everything else the candidate was scored by still holds, only the ping is swapped for the measured one
+		const FMultiplayerRankedSession& Candidate{ ProbeCandidates[CandidateIndex] };
+		const float ScoredPingMs{ Candidate.RttInMs > 0 ? static_cast<float>(Candidate.RttInMs) : Weights.UnknownPingMs };
+
+		FMultiplayerRankedSession& RankedSession{ RankedSessions.AddDefaulted_GetRef() };
+		RankedSession.ResultIndex = Candidate.ResultIndex;
+		RankedSession.RttInMs = RttInMs[CandidateIndex];
+		RankedSession.OpenSlots = Candidate.OpenSlots;
+		RankedSession.Score = Candidate.Score + (RankedSession.RttInMs - ScoredPingMs) * Weights.PingWeight;
 	}
-	else
+
+	ProbeCandidates.Reset();
+
+	RankedSessions.Sort([](const FMultiplayerRankedSession& A, const FMultiplayerRankedSession& B)
 	{
-		if (Color == FColor::Red)
-		{
-			UE_LOG(LogTemp, Error, TEXT("%s"), *LogText);
-		}
-		else if (Color == FColor::Yellow)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("%s"), *LogText);
-		}
-		else
-		{
-			UE_LOG(LogTemp, Display, TEXT("%s"), *LogText);
-		}
+		return A.Score < B.Score;
+	});
+
+	if (!RankedSessions.IsEmpty())
+	{
+		MULTIPLAYER_LOG(Verbose, TEXT("Best session answers in %d ms"), RankedSessions[0].RttInMs);
 	}
-}
\ No newline at end of file
+
+	MultiplayerOnFindBestSessionComplete.Broadcast(RankedSessions, !RankedSessions.IsEmpty());
+}
@@ -0,0 +1,284 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ServerBrowser.h"
+#include "Algo/BinarySearch.h"
+#include "Components/ListView.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionsLog.h"
+
+void UServerBrowser::Search(int32 MaxSearchResults /*= 10000*/)
+{
+	if(!MultiplayerSessionsSubsystem)
+		return;
+
+	ResetList();
+	UpdateListView();
+
+	FMultiplayerSearchSettings SearchSettings;
+	SearchSettings.MaxSearchResults = MaxSearchResults;
+	SearchSettings.BatchSize = 64;
+	SearchSettings.MatchType = MatchTypeFilter;
+	SearchSettings.MinOpenSlots = bHideFullSessions ? 1 : 0;
+	MultiplayerSessionsSubsystem->FindSessions(SearchSettings);
+}
+
+void UServerBrowser::SetSort(EServerBrowserSort InSort, bool bInAscending /*= true*/)
+{
+	if(Sort == InSort && bAscending == bInAscending)
+		return;
+
+	Sort = InSort;
+	bAscending = bInAscending;
+
+	ListedItems.StableSort([this](const UObject& A, const UObject& B)
+	{
+		return IsSortedBefore(CastChecked<UServerBrowserItem>(&A)->Summary, CastChecked<UServerBrowserItem>(&B)->Summary);
+	});
+
+	UpdateListView();
+}
+
+void UServerBrowser::SetFilter(const FString& InMatchType, bool bInHideFullSessions /*= true*/)
+{
+	if(MatchTypeFilter == InMatchType && bHideFullSessions == bInHideFullSessions)
+		return;
+
+	MatchTypeFilter = InMatchType;
+	bHideFullSessions = bInHideFullSessions;
+	MatchTypeFilterId = 0;
+
+	RebuildList();
+}
+
+void UServerBrowser::JoinSelectedSession()
+{
+	if(!SessionList)
+		return;
+
+	OnSessionDoubleClicked(SessionList->GetSelectedItem());
+}
+
+bool UServerBrowser::Initialize()
+{
+	if(!Super::Initialize())
+		return false;
+
+	if(!SessionList)
+		return false;
+
+	SessionList->OnItemDoubleClicked().AddUObject(this, &UServerBrowser::OnSessionDoubleClicked);
+
+	return true;
+}
+
+void UServerBrowser::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	UGameInstance* GameInstance{ GetGameInstance() };
+	if (GameInstance)
+	{
+		MultiplayerSessionsSubsystem = GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>();
+	}
+
+	if(!MultiplayerSessionsSubsystem)
+		return;
+
+	MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsBatch.AddUObject(this, &UServerBrowser::OnFindSessionsBatch);
+	MultiplayerSessionsSubsystem->MultiplayerOnFindSessionComplete.AddUObject(this, &UServerBrowser::OnFindSessions);
+	MultiplayerSessionsSubsystem->MultiplayerOnSearchResultsProgress.AddUObject(this, &UServerBrowser::OnSearchResultsProgress);
+	MultiplayerSessionsSubsystem->MultiplayerOnSearchCacheRefreshed.AddUObject(this, &UServerBrowser::OnSearchCacheRefreshed);
+	MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &UServerBrowser::OnJoinSession);
+
+	//Whatever the last search found is worth showing until the next one comes in
+	RebuildList();
+}
+
+void UServerBrowser::NativeDestruct()
+{
+	if (MultiplayerSessionsSubsystem)
+	{
+		MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsBatch.RemoveAll(this);
+		MultiplayerSessionsSubsystem->MultiplayerOnFindSessionComplete.RemoveAll(this);
+		MultiplayerSessionsSubsystem->MultiplayerOnSearchResultsProgress.RemoveAll(this);
+		MultiplayerSessionsSubsystem->MultiplayerOnSearchCacheRefreshed.RemoveAll(this);
+		MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete.RemoveAll(this);
+	}
+
+	Super::NativeDestruct();
+}
+
+void UServerBrowser::OnFindSessionsBatch(TArrayView<const FOnlineSessionSearchResult> SearchResults, int32 FirstResultIndex)
+{
+	AppendNewSummaries();
+}
+
+void UServerBrowser::OnFindSessions(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull)
+{
+	AppendNewSummaries();
+}
+
+void UServerBrowser::OnSearchResultsProgress(int32 NumProcessed, int32 NumResults)
+{
+	AppendNewSummaries();
+}
+
+void UServerBrowser::OnSearchCacheRefreshed()
+{
+	RebuildList();
+}
+
+void UServerBrowser::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	if(!bIsJoining || (MultiplayerSessionsSubsystem && MultiplayerSessionsSubsystem->GetOperationSessionName() != NAME_GameSession))
+		return;
+
+	bIsJoining = false;
+
+	if (Result != EOnJoinSessionCompleteResult::Success)
+	{
+		MULTIPLAYER_LOG(Error, TEXT("Failed to join session"));
+		return;
+	}
+
+	if(!MultiplayerSessionsSubsystem || !GetGameInstance())
+		return;
+
+	MultiplayerSessionsSubsystem->TravelToSession(GetGameInstance()->GetFirstLocalPlayerController());
+}
+
+void UServerBrowser::OnSessionDoubleClicked(UObject* Item)
+{
+	const UServerBrowserItem* BrowserItem{ Cast<UServerBrowserItem>(Item) };
+	if(!BrowserItem || !MultiplayerSessionsSubsystem || bIsJoining)
+		return;
+
+	bIsJoining = true;
+	MultiplayerSessionsSubsystem->JoinAnySession(TArray<int32>{ BrowserItem->Summary.ResultIndex });
+}
+
+void UServerBrowser::ResetList()
+{
+	ListedItems.Reset();
+	NumItemsInUse = 0;
+	NumSummariesSeen = 0;
+	bItemsReused = true;
+}
+
+void UServerBrowser::RebuildList()
+{
+	ResetList();
+	AppendNewSummaries();
+}
+
+void UServerBrowser::AppendNewSummaries()
+{
+	if(!MultiplayerSessionsSubsystem)
+		return;
+
+	//The subsystem started over with a different search, whoever started it
+	if (SummariesGeneration != MultiplayerSessionsSubsystem->GetSessionSummariesGeneration())
+	{
+		SummariesGeneration = MultiplayerSessionsSubsystem->GetSessionSummariesGeneration();
+		ResetList();
+	}
+
+	const TConstArrayView<FMultiplayerSessionSummary> Summaries{ MultiplayerSessionsSubsystem->GetSessionSummaries() };
+	if(NumSummariesSeen >= Summaries.Num() && !bItemsReused)
+		return;
+
+	//Batches are small next to what is already listed, inserting in place beats sorting everything again
+	for (int32 SummaryIndex{ NumSummariesSeen }; SummaryIndex < Summaries.Num(); ++SummaryIndex)
+	{
+		const FMultiplayerSessionSummary& Summary{ Summaries[SummaryIndex] };
+		if(!PassesFilter(Summary))
+			continue;
+
+		const int32 InsertIndex{ Algo::UpperBound(ListedItems, Summary, [this](const FMultiplayerSessionSummary& Value, const UObject* Item)
+		{
+			return IsSortedBefore(Value, CastChecked<UServerBrowserItem>(Item)->Summary);
+		}) };
+
+		ListedItems.Insert(AcquireItem(Summary), InsertIndex);
+	}
+
+	NumSummariesSeen = Summaries.Num();
+
+	UpdateListView();
+}
+
+bool UServerBrowser::PassesFilter(const FMultiplayerSessionSummary& Summary)
+{
+	if(Summary.bIsStale || (bHideFullSessions && Summary.OpenSlots <= 0))
+		return false;
+
+	if(MatchTypeFilter.IsEmpty())
+		return true;
+
+	if (MatchTypeFilterId == 0)
+	{
+		MatchTypeFilterId = MultiplayerSessionsSubsystem->FindMatchTypeId(MatchTypeFilter);
+	}
+
+	return MatchTypeFilterId != 0 && Summary.MatchTypeId == MatchTypeFilterId;
+}
+
+bool UServerBrowser::IsSortedBefore(const FMultiplayerSessionSummary& A, const FMultiplayerSessionSummary& B) const
+{
+	//Unmeasured hosts go last whichever way the list is sorted
+	auto GetSortablePing = [](const FMultiplayerSessionSummary& Summary)
+	{
+		return Summary.PingInMs > 0 ? Summary.PingInMs : MAX_int32;
+	};
+
+	switch (Sort)
+	{
+	case EServerBrowserSort::OpenSlots:
+		if (A.OpenSlots != B.OpenSlots)
+			return bAscending ? A.OpenSlots < B.OpenSlots : A.OpenSlots > B.OpenSlots;
+		break;
+	case EServerBrowserSort::MatchType:
+		if (A.MatchTypeId != B.MatchTypeId)
+			return bAscending ? A.MatchTypeId < B.MatchTypeId : A.MatchTypeId > B.MatchTypeId;
+		break;
+	default:
+		if (GetSortablePing(A) != GetSortablePing(B))
+		{
+			if(GetSortablePing(A) == MAX_int32 || GetSortablePing(B) == MAX_int32)
+				return GetSortablePing(A) < GetSortablePing(B);
+
+			return bAscending ? A.PingInMs < B.PingInMs : A.PingInMs > B.PingInMs;
+		}
+		break;
+	}
+
+	//Ties keep the order the backend reported them in
+	return A.ResultIndex < B.ResultIndex;
+}
+
+UServerBrowserItem* UServerBrowser::AcquireItem(const FMultiplayerSessionSummary& Summary)
+{
+	if (NumItemsInUse == ItemPool.Num())
+	{
+		ItemPool.Add(NewObject<UServerBrowserItem>(this));
+	}
+
+	UServerBrowserItem* Item{ ItemPool[NumItemsInUse++] };
+	Item->Summary = Summary;
+	return Item;
+}
+
+void UServerBrowser::UpdateListView()
+{
+	if(!SessionList)
+		return;
+
+	SessionList->SetListItems(ListedItems);
+
+	if (bItemsReused)
+	{
+		bItemsReused = false;
+		SessionList->RegenerateAllEntries();
+	}
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ServerBrowserEntry.h"
+#include "Components/TextBlock.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionsAttributes.h"
+#include "ServerBrowser.h"
+
+void UServerBrowserEntry::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+	const UServerBrowserItem* BrowserItem{ Cast<UServerBrowserItem>(ListItemObject) };
+	if(!BrowserItem)
+		return;
+
+	const FMultiplayerSessionSummary& Summary{ BrowserItem->Summary };
+
+	UGameInstance* GameInstance{ GetGameInstance() };
+	const UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem{ GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr };
+
+	if (MatchNameText)
+	{
+		//Only visible rows get here, so reading the full search result is fine
+		FString MatchName;
+		const FOnlineSessionSearchResult* SearchResult{ MultiplayerSessionsSubsystem ? MultiplayerSessionsSubsystem->GetSearchResult(Summary.ResultIndex) : nullptr };
+		if (SearchResult)
+		{
+			MatchName = MultiplayerSessionAttributes::MatchName.Read(SearchResult->Session.SessionSettings);
+		}
+		MatchNameText->SetText(FText::FromString(MatchName));
+	}
+
+	if (MatchTypeText)
+	{
+		MatchTypeText->SetText(MultiplayerSessionsSubsystem ? FText::FromString(MultiplayerSessionsSubsystem->GetMatchTypeName(Summary.MatchTypeId)) : FText::GetEmpty());
+	}
+
+	if (SlotsText)
+	{
+		SlotsText->SetText(FText::Format(FText::FromString(TEXT("{0}/{1}")), FText::AsNumber(Summary.MaxSlots - Summary.OpenSlots), FText::AsNumber(Summary.MaxSlots)));
+	}
+
+	if (PingText)
+	{
+		PingText->SetText(Summary.PingInMs > 0 ? FText::AsNumber(Summary.PingInMs) : FText::FromString(TEXT("-")));
+	}
+}
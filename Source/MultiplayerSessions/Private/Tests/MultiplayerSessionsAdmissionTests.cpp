@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "MultiplayerSessionsAdmission.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsAdmissionFullTest, "MultiplayerSessions.Admission.Full",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsAdmissionFullTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsAdmission Admission;
+	Admission.Start(2, 4, 10.f);
+
+	TestEqual(TEXT("First player"), Admission.BeginHandshake(TEXT("A"), 0.0), EMultiplayerAdmissionResult::Admitted);
+	TestEqual(TEXT("Second player"), Admission.BeginHandshake(TEXT("B"), 0.0), EMultiplayerAdmissionResult::Admitted);
+	TestEqual(TEXT("Third player"), Admission.BeginHandshake(TEXT("C"), 0.0), EMultiplayerAdmissionResult::Full);
+	TestEqual(TEXT("Open slots while both log in"), Admission.GetNumOpenSlots(), 0);
+
+	Admission.CompleteHandshake(TEXT("A"));
+	Admission.CompleteHandshake(TEXT("B"));
+	TestEqual(TEXT("Handshakes after both logged in"), Admission.GetNumHandshakes(), 0);
+	TestEqual(TEXT("Logging in again after a travel"), Admission.BeginHandshake(TEXT("A"), 1.0), EMultiplayerAdmissionResult::Admitted);
+
+	Admission.Release(TEXT("B"));
+	TestEqual(TEXT("Open slots after one left"), Admission.GetNumOpenSlots(), 1);
+	TestEqual(TEXT("Third player after one left"), Admission.BeginHandshake(TEXT("C"), 1.0), EMultiplayerAdmissionResult::Admitted);
+
+	//Empty ids are let through without being counted
+	TestEqual(TEXT("Player without id"), Admission.BeginHandshake(FString(), 1.0), EMultiplayerAdmissionResult::Admitted);
+	TestEqual(TEXT("Handshakes after a player without id"), Admission.GetNumHandshakes(), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsAdmissionBusyTest, "MultiplayerSessions.Admission.Busy",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsAdmissionBusyTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsAdmission Admission;
+	Admission.Start(4, 1, 10.f);
+
+	TestTrue(TEXT("Reserve"), Admission.Reserve(TEXT("B"), 0.0));
+	TestEqual(TEXT("First login"), Admission.BeginHandshake(TEXT("A"), 0.0), EMultiplayerAdmissionResult::Admitted);
+	TestEqual(TEXT("Second login while the first is handled"), Admission.BeginHandshake(TEXT("B"), 0.0), EMultiplayerAdmissionResult::Busy);
+	TestEqual(TEXT("Reservations kept while busy"), Admission.GetNumReservations(), 2);
+	TestEqual(TEXT("Same login again"), Admission.BeginHandshake(TEXT("A"), 1.0), EMultiplayerAdmissionResult::Admitted);
+
+	Admission.CompleteHandshake(TEXT("A"));
+	TestEqual(TEXT("Second login once the first went through"), Admission.BeginHandshake(TEXT("B"), 1.0), EMultiplayerAdmissionResult::Admitted);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsAdmissionReservationTest, "MultiplayerSessions.Admission.Reservations",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsAdmissionReservationTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsAdmission Admission;
+	Admission.Start(2, 4, 10.f);
+
+	TestTrue(TEXT("Reserve A"), Admission.Reserve(TEXT("A"), 0.0));
+	TestTrue(TEXT("Reserve B"), Admission.Reserve(TEXT("B"), 0.0));
+	TestFalse(TEXT("Reserve C in a full session"), Admission.Reserve(TEXT("C"), 0.0));
+	TestEqual(TEXT("Unreserved login in a full session"), Admission.BeginHandshake(TEXT("C"), 0.0), EMultiplayerAdmissionResult::Full);
+	TestEqual(TEXT("Reserved login"), Admission.BeginHandshake(TEXT("A"), 0.0), EMultiplayerAdmissionResult::Admitted);
+	TestEqual(TEXT("Reservations"), Admission.GetNumReservations(), 2);
+
+	//Reserving again only extends the reservation
+	TestTrue(TEXT("Extend B"), Admission.Reserve(TEXT("B"), 5.0));
+	TestEqual(TEXT("Expired before the timeout"), Admission.ExpireReservations(9.0), 0);
+	TestEqual(TEXT("Expired after the timeout of A"), Admission.ExpireReservations(12.0), 1);
+	TestEqual(TEXT("Handshakes after A expired"), Admission.GetNumHandshakes(), 0);
+	TestEqual(TEXT("Expired after the timeout of B"), Admission.ExpireReservations(16.0), 1);
+	TestEqual(TEXT("Open slots after everything expired"), Admission.GetNumOpenSlots(), 2);
+
+	Admission.Stop();
+	TestFalse(TEXT("Reserve after stopping"), Admission.Reserve(TEXT("A"), 0.0));
+	return true;
+}
+
+#endif
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "OnlineSessionSettings.h"
+#include "MultiplayerSessionsFakeBackend.h"
+#include "MultiplayerSessionsLanBackend.h"
+#include "MultiplayerSessionsAttributes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MultiplayerSessionsBackendTests
+{
+	//Backends complete from the core ticker, latent commands give it the frames to do so
+	static constexpr double Timeout{ 5.0 };
+
+	struct FFakeBackendState
+	{
+		TSharedPtr<FMultiplayerSessionsFakeBackend> Backend;
+		TSharedPtr<FOnlineSessionSearch> Search;
+		TOptional<bool> FindResult;
+		TOptional<EOnJoinSessionCompleteResult::Type> JoinResult;
+		TOptional<EOnJoinSessionCompleteResult::Type> SecondJoinResult;
+		double StartTime{ 0.0 };
+	};
+
+	struct FLanBackendState
+	{
+		TSharedPtr<FMultiplayerSessionsLanBackend> Host;
+		TSharedPtr<FMultiplayerSessionsLanBackend> Client;
+		TSharedPtr<FOnlineSessionSearch> Search;
+		TOptional<bool> CreateResult;
+		TOptional<bool> FindResult;
+		FString HostedSessionId;
+		double StartTime{ 0.0 };
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsFakeBackendTest, "MultiplayerSessions.Backend.Fake",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsFakeBackendTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsBackendTests;
+
+	FMultiplayerFakeBackendSettings Settings;
+	Settings.NumSessions = 64;
+	Settings.MaxPublicConnections = 2;
+	Settings.FullSessionRate = 0.f;
+	Settings.MinResponseTime = 0.f;
+	Settings.MaxResponseTime = 0.01f;
+
+	TSharedRef<FFakeBackendState> State{ MakeShared<FFakeBackendState>() };
+	State->Backend = MakeShared<FMultiplayerSessionsFakeBackend>(Settings);
+	State->Search = MakeShared<FOnlineSessionSearch>();
+	State->Search->MaxSearchResults = 10;
+	State->StartTime = FPlatformTime::Seconds();
+
+	TestEqual(TEXT("Hosted sessions"), State->Backend->GetNumHostedSessions(), 64);
+
+	//Weak, the backend owning its delegates must not keep the state alive
+	const TWeakPtr<FFakeBackendState> WeakState{ State };
+	State->Backend->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateLambda([WeakState](bool bWasSuccessfull)
+	{
+		if (const TSharedPtr<FFakeBackendState> PinnedState{ WeakState.Pin() })
+		{
+			PinnedState->FindResult = bWasSuccessfull;
+		}
+	}));
+
+	State->Backend->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateLambda([WeakState](FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+	{
+		if (const TSharedPtr<FFakeBackendState> PinnedState{ WeakState.Pin() })
+		{
+			TOptional<EOnJoinSessionCompleteResult::Type>& JoinResult{ PinnedState->JoinResult.IsSet() ? PinnedState->SecondJoinResult : PinnedState->JoinResult };
+			JoinResult = Result;
+		}
+	}));
+
+	if(!TestTrue(TEXT("Find started"), State->Backend->FindSessions(nullptr, State->Search.ToSharedRef())))
+		return false;
+
+	TestFalse(TEXT("Second find while one runs"), State->Backend->FindSessions(nullptr, MakeShared<FOnlineSessionSearch>()));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		if (!State->FindResult.IsSet())
+		{
+			if(FPlatformTime::Seconds() - State->StartTime < Timeout)
+				return false;
+
+			AddError(TEXT("Find did not complete"));
+			return true;
+		}
+
+		TestTrue(TEXT("Find succeeded"), State->FindResult.GetValue());
+		TestEqual(TEXT("Results are capped"), State->Search->SearchResults.Num(), 10);
+		if(State->Search->SearchResults.IsEmpty())
+			return true;
+
+		const FOnlineSessionSearchResult& SearchResult{ State->Search->SearchResults[0] };
+		FString ConnectInfo;
+		TestTrue(TEXT("Connect string of a result"), State->Backend->GetResolvedConnectString(SearchResult, NAME_GamePort, ConnectInfo) && !ConnectInfo.IsEmpty());
+
+		State->Backend->JoinSession(nullptr, NAME_GameSession, SearchResult);
+		State->Backend->JoinSession(nullptr, NAME_GameSession, SearchResult);
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		if (!State->SecondJoinResult.IsSet())
+		{
+			if(FPlatformTime::Seconds() - State->StartTime < Timeout)
+				return false;
+
+			AddError(TEXT("Join did not complete"));
+			return true;
+		}
+
+		//Completions come out in request order, the second join finds the first one's session
+		TestEqual(TEXT("Join"), State->JoinResult.GetValue(), EOnJoinSessionCompleteResult::Success);
+		TestEqual(TEXT("Joining again"), State->SecondJoinResult.GetValue(), EOnJoinSessionCompleteResult::AlreadyInSession);
+		TestNotNull(TEXT("Joined session"), State->Backend->GetNamedSession(NAME_GameSession));
+
+		return true;
+	}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsLanBackendTest, "MultiplayerSessions.Backend.LanDiscovery",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsLanBackendTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsBackendTests;
+
+	//Away from the default range, so a game running on this machine does not answer
+	FMultiplayerLanDiscoverySettings Settings;
+	Settings.Port = 14511;
+	Settings.ResponseTimeout = 1.f;
+	Settings.NumRespondersToComplete = 1;
+
+	TSharedRef<FLanBackendState> State{ MakeShared<FLanBackendState>() };
+	State->Host = MakeShared<FMultiplayerSessionsLanBackend>(Settings);
+	State->Client = MakeShared<FMultiplayerSessionsLanBackend>(Settings);
+	State->StartTime = FPlatformTime::Seconds();
+
+	FOnlineSessionSettings SessionSettings;
+	SessionSettings.NumPublicConnections = 4;
+	SessionSettings.bShouldAdvertise = true;
+	SessionSettings.bIsLANMatch = true;
+	MultiplayerSessionAttributes::MatchType.Write(SessionSettings, TEXT("FreeForAll"));
+
+	const TWeakPtr<FLanBackendState> WeakState{ State };
+	State->Host->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateLambda([WeakState](FName SessionName, bool bWasSuccessfull)
+	{
+		if (const TSharedPtr<FLanBackendState> PinnedState{ WeakState.Pin() })
+		{
+			PinnedState->CreateResult = bWasSuccessfull;
+		}
+	}));
+
+	State->Client->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateLambda([WeakState](bool bWasSuccessfull)
+	{
+		if (const TSharedPtr<FLanBackendState> PinnedState{ WeakState.Pin() })
+		{
+			PinnedState->FindResult = bWasSuccessfull;
+		}
+	}));
+
+	if(!TestTrue(TEXT("Create started"), State->Host->CreateSession(nullptr, NAME_GameSession, SessionSettings)))
+		return false;
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		if (!State->CreateResult.IsSet())
+		{
+			if(FPlatformTime::Seconds() - State->StartTime < Timeout)
+				return false;
+
+			AddError(TEXT("Create did not complete"));
+			return true;
+		}
+
+		TestTrue(TEXT("Create succeeded"), State->CreateResult.GetValue());
+		TestTrue(TEXT("Host answers discovery"), State->Host->GetBeaconPort() != 0);
+
+		const FNamedOnlineSession* HostedSession{ State->Host->GetNamedSession(NAME_GameSession) };
+		State->HostedSessionId = HostedSession ? HostedSession->GetSessionIdStr() : FString();
+
+		State->Search = MakeShared<FOnlineSessionSearch>();
+		State->Search->MaxSearchResults = 10;
+		State->Search->bIsLanQuery = true;
+		TestTrue(TEXT("Find started"), State->Client->FindSessions(nullptr, State->Search.ToSharedRef()));
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		if (!State->FindResult.IsSet())
+		{
+			if(FPlatformTime::Seconds() - State->StartTime < Timeout)
+				return false;
+
+			AddError(TEXT("Find did not complete"));
+			return true;
+		}
+
+		const FOnlineSessionSearchResult* SearchResult{ State->Search->SearchResults.FindByPredicate([&State](const FOnlineSessionSearchResult& Result)
+		{
+			return Result.GetSessionIdStr() == State->HostedSessionId;
+		}) };
+
+		TestTrue(TEXT("Find succeeded"), State->FindResult.GetValue());
+		if (TestNotNull(TEXT("Hosted session found"), SearchResult))
+		{
+			TestEqual(TEXT("Open slots"), SearchResult->Session.NumOpenPublicConnections, 4);
+			TestEqual(TEXT("Match type"), MultiplayerSessionAttributes::MatchType.Read(SearchResult->Session.SessionSettings), FString(TEXT("FreeForAll")));
+
+			FString ConnectInfo;
+			TestTrue(TEXT("Connect string of the result"), State->Client->GetResolvedConnectString(*SearchResult, NAME_GamePort, ConnectInfo) && !ConnectInfo.IsEmpty());
+		}
+
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "MultiplayerSessionsOperationQueue.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MultiplayerSessionsOperationQueueTests
+{
+	//Records what the queue did with the operations, in order
+	struct FQueueLog
+	{
+		TArray<FString> Executed;
+		TArray<FString> Aborted;
+		TArray<TPair<FMultiplayerOperationHandle, bool>> Dropped;
+	};
+
+	static FMultiplayerOperationHandle Enqueue(FMultiplayerSessionsOperationQueue& Queue, FQueueLog& Log, EMultiplayerSessionOperation Type, const FString& Name, FName SessionName = NAME_None, bool bSupersedeActive = false)
+	{
+		return Queue.Enqueue(Type,
+			[&Log, Name]() { Log.Executed.Add(Name); return true; },
+			[&Log, Name](EMultiplayerOperationAbortReason) { Log.Aborted.Add(Name); },
+			0.f, bSupersedeActive, SessionName);
+	}
+
+	static void Track(FMultiplayerSessionsOperationQueue& Queue, FQueueLog& Log)
+	{
+		Queue.SetOnDropped([&Log](FMultiplayerOperationHandle Handle, EMultiplayerSessionOperation, EMultiplayerOperationAbortReason, bool bWasStarted)
+		{
+			Log.Dropped.Emplace(Handle, bWasStarted);
+		});
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsOperationQueueMergeTest, "MultiplayerSessions.OperationQueue.Merge",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsOperationQueueMergeTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsOperationQueueTests;
+
+	FQueueLog Log;
+	FMultiplayerSessionsOperationQueue Queue;
+	Track(Queue, Log);
+
+	Enqueue(Queue, Log, EMultiplayerSessionOperation::Create, TEXT("Create"), NAME_GameSession);
+	const FMultiplayerOperationHandle FirstFind{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find1")) };
+	const FMultiplayerOperationHandle SecondFind{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find2")) };
+
+	TestEqual(TEXT("Merged request keeps the handle"), SecondFind, FirstFind);
+	TestEqual(TEXT("Waiting operations"), Queue.GetNumPending(), 1);
+	TestEqual(TEXT("Merging aborts nothing"), Log.Aborted.Num(), 0);
+	TestEqual(TEXT("Merging drops nothing"), Log.Dropped.Num(), 0);
+
+	Queue.CompleteActive(EMultiplayerSessionOperation::Create, NAME_GameSession);
+	TestEqual(TEXT("Executed"), Log.Executed, TArray<FString>{ TEXT("Create"), TEXT("Find2") });
+	TestTrue(TEXT("Find is running"), Queue.IsActive(EMultiplayerSessionOperation::Find));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsOperationQueueLifetimeTest, "MultiplayerSessions.OperationQueue.SessionLifetime",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsOperationQueueLifetimeTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsOperationQueueTests;
+
+	FQueueLog Log;
+	FMultiplayerSessionsOperationQueue Queue;
+	Track(Queue, Log);
+
+	Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find"));
+	const FMultiplayerOperationHandle FirstUpdate{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Update, TEXT("Update1"), NAME_GameSession) };
+	Enqueue(Queue, Log, EMultiplayerSessionOperation::Destroy, TEXT("Destroy"), NAME_GameSession);
+	const FMultiplayerOperationHandle SecondUpdate{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Update, TEXT("Update2"), NAME_GameSession) };
+	const FMultiplayerOperationHandle PartyUpdate{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Update, TEXT("PartyUpdate"), NAME_PartySession) };
+
+	//The second update is meant for whatever session comes after the destroy
+	TestNotEqual(TEXT("Update behind a destroy is not merged"), SecondUpdate, FirstUpdate);
+	TestNotEqual(TEXT("Updates of different sessions are not merged"), PartyUpdate, FirstUpdate);
+	TestEqual(TEXT("Waiting operations"), Queue.GetNumPending(), 4);
+
+	Queue.CompleteActive(EMultiplayerSessionOperation::Find);
+	//Late callback for another session, ignored
+	Queue.CompleteActive(EMultiplayerSessionOperation::Update, NAME_PartySession);
+	TestTrue(TEXT("Game session update still running"), Queue.IsActive(EMultiplayerSessionOperation::Update));
+	TestEqual(TEXT("Running session"), Queue.GetActiveSessionName(), NAME_GameSession);
+
+	Queue.CompleteActive(EMultiplayerSessionOperation::Update, NAME_GameSession);
+	Queue.CompleteActive(EMultiplayerSessionOperation::Destroy, NAME_GameSession);
+	Queue.CompleteActive(EMultiplayerSessionOperation::Update, NAME_GameSession);
+	Queue.CompleteActive(EMultiplayerSessionOperation::Update, NAME_PartySession);
+	TestEqual(TEXT("Executed in request order"), Log.Executed, TArray<FString>{ TEXT("Find"), TEXT("Update1"), TEXT("Destroy"), TEXT("Update2"), TEXT("PartyUpdate") });
+	TestEqual(TEXT("Nothing left"), Queue.GetNumPending(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsOperationQueueCancelTest, "MultiplayerSessions.OperationQueue.Cancel",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsOperationQueueCancelTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsOperationQueueTests;
+
+	FQueueLog Log;
+	FMultiplayerSessionsOperationQueue Queue;
+	Track(Queue, Log);
+
+	const FMultiplayerOperationHandle RunningFind{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find1")) };
+	const FMultiplayerOperationHandle WaitingFind{ Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find2")) };
+
+	//Waiting ones never ran, cancelling one must not stop the running search
+	TestTrue(TEXT("Cancel waiting"), Queue.Cancel(WaitingFind, false));
+	TestEqual(TEXT("Aborted after cancelling a waiting one"), Log.Aborted.Num(), 0);
+	TestEqual(TEXT("Dropped after cancelling a waiting one"), Log.Dropped.Num(), 1);
+	TestFalse(TEXT("Waiting one was not started"), Log.Dropped.Num() == 1 && Log.Dropped[0].Value);
+	TestTrue(TEXT("First search still running"), Queue.IsActive(EMultiplayerSessionOperation::Find));
+
+	TestFalse(TEXT("Cancel running without permission"), Queue.Cancel(RunningFind, false));
+	TestTrue(TEXT("Cancel running"), Queue.Cancel(RunningFind, true));
+	TestEqual(TEXT("Aborted"), Log.Aborted, TArray<FString>{ TEXT("Find1") });
+	TestTrue(TEXT("Running one was started"), Log.Dropped.Num() == 2 && Log.Dropped[1].Key == RunningFind && Log.Dropped[1].Value);
+	TestFalse(TEXT("Cancel twice"), Queue.Cancel(RunningFind, true));
+
+	//A newer request that supersedes the running one aborts it and runs right away
+	Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find3"));
+	Enqueue(Queue, Log, EMultiplayerSessionOperation::Find, TEXT("Find4"), NAME_None, true);
+	TestEqual(TEXT("Aborted after superseding"), Log.Aborted, TArray<FString>{ TEXT("Find1"), TEXT("Find3") });
+	TestEqual(TEXT("Executed after superseding"), Log.Executed, TArray<FString>{ TEXT("Find1"), TEXT("Find3"), TEXT("Find4") });
+
+	TestTrue(TEXT("Cancel type"), Queue.CancelType(EMultiplayerSessionOperation::Find, true));
+	TestFalse(TEXT("Nothing of that type left"), Queue.IsActive(EMultiplayerSessionOperation::Find) || Queue.IsPending(EMultiplayerSessionOperation::Find));
+	return true;
+}
+
+#endif
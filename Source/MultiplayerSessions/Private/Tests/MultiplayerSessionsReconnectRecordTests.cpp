@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "MultiplayerSessionsReconnectRecord.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsReconnectRecordTest, "MultiplayerSessions.ReconnectRecord",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsReconnectRecordTest::RunTest(const FString& Parameters)
+{
+	//Never saved, the player's own slot stays untouched
+	UMultiplayerSessionsReconnectRecord* ReconnectRecord{ NewObject<UMultiplayerSessionsReconnectRecord>() };
+	const FTimespan MaxAge{ FTimespan::FromMinutes(15.0) };
+
+	TestFalse(TEXT("Empty record"), ReconnectRecord->IsValidFor(MaxAge));
+
+	ReconnectRecord->SessionId = TEXT("Session");
+	ReconnectRecord->JoinedTime = FDateTime::UtcNow();
+	TestFalse(TEXT("Record without an address to travel to"), ReconnectRecord->IsValidFor(MaxAge));
+
+	ReconnectRecord->SessionAddress = TEXT("127.0.0.1:7777");
+	TestTrue(TEXT("Recent record"), ReconnectRecord->IsValidFor(MaxAge));
+
+	ReconnectRecord->JoinedTime = FDateTime::UtcNow() - FTimespan::FromMinutes(20.0);
+	TestFalse(TEXT("Old record"), ReconnectRecord->IsValidFor(MaxAge));
+	TestTrue(TEXT("Old record with a longer max age"), ReconnectRecord->IsValidFor(FTimespan::FromHours(1.0)));
+	return true;
+}
+
+#endif
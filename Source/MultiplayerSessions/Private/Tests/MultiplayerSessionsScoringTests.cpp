@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "MultiplayerSessionsScoring.h"
+#include "MultiplayerSessionsSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MultiplayerSessionsScoringTests
+{
+	//Only ping counts, so the expected order is easy to tell
+	static FMultiplayerScoringWeights MakePingOnlyWeights()
+	{
+		FMultiplayerScoringWeights Weights;
+		Weights.FillWeight = 0.f;
+		Weights.SkillWeight = 0.f;
+		Weights.RegionMismatchPenalty = 0.f;
+		return Weights;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsScoringOrderTest, "MultiplayerSessions.Scoring.Order",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsScoringOrderTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsScoringTable ScoringTable;
+	ScoringTable.AddRow(0, 80, 4, 8, 1, 0, 0, 0);
+	ScoringTable.AddRow(1, 20, 4, 8, 1, 0, 0, 0);
+	ScoringTable.AddRow(2, 50, 4, 8, 1, 0, 0, 0);
+	ScoringTable.AddRow(3, 10, 4, 8, 1, 0, 0, 0);
+
+	TArray<FMultiplayerRankedSession> RankedSessions;
+	ScoringTable.Score(MultiplayerSessionsScoringTests::MakePingOnlyWeights(), FMultiplayerScoringQuery(), 0, 3, RankedSessions);
+
+	if (!TestEqual(TEXT("Number of ranked sessions"), RankedSessions.Num(), 3))
+		return false;
+
+	TestEqual(TEXT("Best"), RankedSessions[0].ResultIndex, 3);
+	TestEqual(TEXT("Second"), RankedSessions[1].ResultIndex, 1);
+	TestEqual(TEXT("Third"), RankedSessions[2].ResultIndex, 2);
+	TestEqual(TEXT("Ping of the best"), RankedSessions[0].RttInMs, 10);
+	TestTrue(TEXT("Scores ascend"), RankedSessions[0].Score <= RankedSessions[1].Score && RankedSessions[1].Score <= RankedSessions[2].Score);
+
+	//Hosts that did not report a ping are ranked as if they answered in UnknownPingMs
+	FMultiplayerScoringWeights Weights{ MultiplayerSessionsScoringTests::MakePingOnlyWeights() };
+	Weights.UnknownPingMs = 30.f;
+	ScoringTable.AddRow(4, 0, 4, 8, 1, 0, 0, 0);
+	ScoringTable.Score(Weights, FMultiplayerScoringQuery(), 0, 3, RankedSessions);
+	TestEqual(TEXT("Unknown ping ranks by UnknownPingMs"), RankedSessions.Num() == 3 ? RankedSessions[2].ResultIndex : INDEX_NONE, 4);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsScoringExclusionTest, "MultiplayerSessions.Scoring.Exclusion",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsScoringExclusionTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsScoringTable ScoringTable;
+	//Stale, full, another match type, another build, too slow and one that fits
+	ScoringTable.AddRow(0, 10, 4, 8, 1, 0, 0, 7);
+	ScoringTable.AddRow(1, 10, 0, 8, 1, 0, 0, 7);
+	ScoringTable.AddRow(2, 10, 4, 8, 2, 0, 0, 7);
+	ScoringTable.AddRow(3, 10, 4, 8, 1, 0, 0, 6);
+	ScoringTable.AddRow(4, 500, 4, 8, 1, 0, 0, 7);
+	ScoringTable.AddRow(5, 40, 4, 8, 1, 0, 0, 7);
+	ScoringTable.SetStale(0);
+
+	FMultiplayerScoringWeights Weights{ MultiplayerSessionsScoringTests::MakePingOnlyWeights() };
+	Weights.MaxPingMs = 200.f;
+
+	FMultiplayerScoringQuery Query;
+	Query.BuildId = 7;
+
+	TArray<FMultiplayerRankedSession> RankedSessions;
+	ScoringTable.Score(Weights, Query, 1, 10, RankedSessions);
+
+	if (!TestEqual(TEXT("Number of ranked sessions"), RankedSessions.Num(), 1))
+		return false;
+
+	TestEqual(TEXT("The only session that fits"), RankedSessions[0].ResultIndex, 5);
+
+	//Any match type and no build check brings back the ones left out for those
+	Weights.bRequireSameBuild = false;
+	ScoringTable.Score(Weights, Query, 0, 10, RankedSessions);
+	TestEqual(TEXT("Number of ranked sessions of any match type and build"), RankedSessions.Num(), 3);
+	TestFalse(TEXT("Stale session left out"), RankedSessions.ContainsByPredicate([](const FMultiplayerRankedSession& RankedSession) { return RankedSession.ResultIndex == 0; }));
+	TestFalse(TEXT("Full session left out"), RankedSessions.ContainsByPredicate([](const FMultiplayerRankedSession& RankedSession) { return RankedSession.ResultIndex == 1; }));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsScoringRegionTest, "MultiplayerSessions.Scoring.Region",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsScoringRegionTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsScoringTable ScoringTable;
+	const uint16 EuropeId{ ScoringTable.InternRegion(TEXT("EU")) };
+	const uint16 AmericaId{ ScoringTable.InternRegion(TEXT("NA")) };
+
+	TestEqual(TEXT("No region"), ScoringTable.InternRegion(FString()), static_cast<uint16>(0));
+	TestEqual(TEXT("Interning again"), ScoringTable.InternRegion(TEXT("EU")), EuropeId);
+	TestNotEqual(TEXT("Different regions"), EuropeId, AmericaId);
+
+	ScoringTable.AddRow(0, 10, 4, 8, 1, 0, AmericaId, 0);
+	ScoringTable.AddRow(1, 40, 4, 8, 1, 0, EuropeId, 0);
+
+	FMultiplayerScoringWeights Weights{ MultiplayerSessionsScoringTests::MakePingOnlyWeights() };
+	Weights.RegionMismatchPenalty = 60.f;
+
+	FMultiplayerScoringQuery Query;
+	Query.Region = TEXT("EU");
+
+	TArray<FMultiplayerRankedSession> RankedSessions;
+	ScoringTable.Score(Weights, Query, 0, 1, RankedSessions);
+	TestEqual(TEXT("Same region beats a lower ping"), RankedSessions.Num() == 1 ? RankedSessions[0].ResultIndex : INDEX_NONE, 1);
+
+	//Nobody advertises it, every session pays the penalty
+	Query.Region = TEXT("OCE");
+	ScoringTable.Score(Weights, Query, 0, 1, RankedSessions);
+	TestEqual(TEXT("Unknown region ranks by ping"), RankedSessions.Num() == 1 ? RankedSessions[0].ResultIndex : INDEX_NONE, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "MultiplayerSessionsSearchCache.h"
+#include "MultiplayerSessionsSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MultiplayerSessionsSearchCacheTests
+{
+	static FMultiplayerSessionsSearchCache::FParsedResult MakeParsedResult(const FString& SessionId, const FString& MatchType, int32 PingInMs, int16 OpenSlots)
+	{
+		FMultiplayerSessionsSearchCache::FParsedResult ParsedResult;
+		ParsedResult.SessionId = SessionId;
+		ParsedResult.SessionIdHash = GetTypeHash(SessionId);
+		ParsedResult.MatchType = MatchType;
+		ParsedResult.PingInMs = PingInMs;
+		ParsedResult.OpenSlots = OpenSlots;
+		ParsedResult.MaxSlots = 8;
+		return ParsedResult;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsSearchCacheIndexTest, "MultiplayerSessions.SearchCache.Index",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsSearchCacheIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsSearchCacheTests;
+
+	FMultiplayerSessionsSearchCache SearchCache;
+
+	//Streamed in two batches, the second one reports the first session again
+	TArray<FMultiplayerSessionsSearchCache::FParsedResult> FirstBatch{ MakeParsedResult(TEXT("A"), TEXT("FreeForAll"), 20, 4), MakeParsedResult(TEXT("B"), TEXT("TeamDeathMatch"), 30, 4) };
+	TArray<FMultiplayerSessionsSearchCache::FParsedResult> SecondBatch{ MakeParsedResult(TEXT("A"), TEXT("FreeForAll"), 20, 4), MakeParsedResult(TEXT("C"), TEXT("FreeForAll"), 40, 2) };
+
+	TestFalse(TEXT("Batch ahead of the cache"), SearchCache.IndexParsedResults(SecondBatch, 2, MAX_dbl));
+	TestTrue(TEXT("First batch"), SearchCache.IndexParsedResults(FirstBatch, 0, MAX_dbl));
+	TestTrue(TEXT("Second batch"), SearchCache.IndexParsedResults(SecondBatch, 2, MAX_dbl));
+
+	TestEqual(TEXT("Indexed results"), SearchCache.GetNumIndexed(), 4);
+	TestEqual(TEXT("Summaries without the duplicate"), SearchCache.GetSummaries().Num(), 3);
+	TestEqual(TEXT("Scoring rows without the duplicate"), SearchCache.GetScoringTable().Num(), 3);
+
+	TestEqual(TEXT("First report of A is kept"), SearchCache.FindById(TEXT("A")), 0);
+	TestEqual(TEXT("C"), SearchCache.FindById(TEXT("C")), 3);
+	TestEqual(TEXT("Unknown session"), SearchCache.FindById(TEXT("D")), INDEX_NONE);
+	TestNull(TEXT("Summary of the duplicate"), SearchCache.FindSummary(2));
+
+	const TConstArrayView<int32> FreeForAll{ SearchCache.FindByMatchType(TEXT("FreeForAll")) };
+	TestEqual(TEXT("FreeForAll results"), FreeForAll.Num(), 2);
+	TestTrue(TEXT("FreeForAll holds A and C"), FreeForAll.Contains(0) && FreeForAll.Contains(3));
+	TestEqual(TEXT("TeamDeathMatch results"), SearchCache.FindByMatchType(TEXT("TeamDeathMatch")).Num(), 1);
+
+	const uint16 FreeForAllId{ SearchCache.FindMatchTypeId(TEXT("FreeForAll")) };
+	TestEqual(TEXT("Match type name"), SearchCache.GetMatchTypeName(FreeForAllId), FString(TEXT("FreeForAll")));
+
+	//Match type ids outlive the search they were made for
+	const uint32 Generation{ SearchCache.GetGeneration() };
+	SearchCache.Reset();
+	TestNotEqual(TEXT("Generation after a reset"), SearchCache.GetGeneration(), Generation);
+	TestEqual(TEXT("Indexed results after a reset"), SearchCache.GetNumIndexed(), 0);
+	TestEqual(TEXT("A after a reset"), SearchCache.FindById(TEXT("A")), INDEX_NONE);
+	TestEqual(TEXT("FreeForAll results after a reset"), SearchCache.FindByMatchType(TEXT("FreeForAll")).Num(), 0);
+	TestEqual(TEXT("Match type id after a reset"), SearchCache.FindMatchTypeId(TEXT("FreeForAll")), FreeForAllId);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsSearchCacheStaleTest, "MultiplayerSessions.SearchCache.Stale",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsSearchCacheStaleTest::RunTest(const FString& Parameters)
+{
+	using namespace MultiplayerSessionsSearchCacheTests;
+
+	FMultiplayerSessionsSearchCache SearchCache;
+	TArray<FMultiplayerSessionsSearchCache::FParsedResult> ParsedResults{ MakeParsedResult(TEXT("A"), TEXT("FreeForAll"), 20, 4), MakeParsedResult(TEXT("B"), TEXT("FreeForAll"), 30, 4) };
+	SearchCache.IndexParsedResults(ParsedResults, 0, MAX_dbl);
+
+	SearchCache.MarkStale(0);
+	SearchCache.MarkTrimmed(1);
+	TestTrue(TEXT("A is stale"), SearchCache.IsStale(0));
+	TestFalse(TEXT("B is not stale"), SearchCache.IsStale(1));
+	TestTrue(TEXT("B is trimmed"), SearchCache.IsTrimmed(1));
+	TestTrue(TEXT("Age of an indexed result"), SearchCache.GetAge(0) >= 0.0);
+	TestTrue(TEXT("Age of a result that is not indexed"), SearchCache.GetAge(5) < 0.0);
+
+	//Stale sessions are never ranked, trimmed ones still are
+	TArray<FMultiplayerRankedSession> RankedSessions;
+	SearchCache.GetScoringTable().Score(FMultiplayerScoringWeights(), FMultiplayerScoringQuery(), 0, 10, RankedSessions);
+	TestEqual(TEXT("Ranked sessions"), RankedSessions.Num(), 1);
+	TestEqual(TEXT("Ranked session"), RankedSessions.Num() == 1 ? RankedSessions[0].ResultIndex : INDEX_NONE, 1);
+
+	TestEqual(TEXT("Expired, A already was"), SearchCache.ExpireSeenBefore(FPlatformTime::Seconds() + 1.0), 1);
+	TestTrue(TEXT("B is stale once expired"), SearchCache.IsStale(1));
+	return true;
+}
+
+#endif
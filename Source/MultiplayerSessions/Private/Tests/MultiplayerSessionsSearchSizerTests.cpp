@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "MultiplayerSessionsSearchSizer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsSearchSizerTest, "MultiplayerSessions.SearchSizer",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsSearchSizerTest::RunTest(const FString& Parameters)
+{
+	FMultiplayerSessionsSearchSizer SearchSizer;
+
+	//8 wanted with 1.5 headroom at the default hit rate of a quarter
+	TestEqual(TEXT("Initial size without history"), SearchSizer.GetInitialSize(TEXT("FreeForAll"), 8, 10000), 48);
+	TestEqual(TEXT("Initial size is at least the minimum"), SearchSizer.GetInitialSize(TEXT("FreeForAll"), 1, 10000), 16);
+	TestEqual(TEXT("Initial size is at most the maximum"), SearchSizer.GetInitialSize(TEXT("FreeForAll"), 8, 20), 20);
+
+	SearchSizer.RecordSearch(TEXT("FreeForAll"), 100, 50);
+	TestEqual(TEXT("First search is taken as is"), SearchSizer.GetHitRate(TEXT("FreeForAll")), 0.5f);
+	TestEqual(TEXT("Other match types keep the default"), SearchSizer.GetHitRate(TEXT("TeamDeathMatch")), 0.25f);
+	TestEqual(TEXT("Initial size after a good search"), SearchSizer.GetInitialSize(TEXT("FreeForAll"), 8, 10000), 24);
+
+	SearchSizer.RecordSearch(TEXT("FreeForAll"), 100, 0);
+	TestEqual(TEXT("Later searches are smoothed"), SearchSizer.GetHitRate(TEXT("FreeForAll")), 0.35f, UE_KINDA_SMALL_NUMBER);
+
+	SearchSizer.RecordSearch(TEXT("FreeForAll"), 0, 0);
+	TestEqual(TEXT("Empty searches are not recorded"), SearchSizer.GetHitRate(TEXT("FreeForAll")), 0.35f, UE_KINDA_SMALL_NUMBER);
+
+	TestEqual(TEXT("Widening at least doubles"), SearchSizer.GetWidenedSize(48, 8, 48, 40, 10000), 96);
+	TestEqual(TEXT("Widening after nothing usable"), SearchSizer.GetWidenedSize(48, 8, 48, 0, 10000), 600);
+	TestEqual(TEXT("Widening is at most the maximum"), SearchSizer.GetWidenedSize(48, 8, 48, 0, 200), 200);
+	return true;
+}
+
+#endif
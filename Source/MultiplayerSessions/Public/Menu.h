@@ -28,6 +28,8 @@ protected:
 	UFUNCTION()
 	void OnCreateSession(bool bWasSuccessfull);
 	void OnFindSession(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull);
+	void OnFindSessionsBatch(TArrayView<const FOnlineSessionSearchResult> SearchResults, int32 FirstResultIndex);
+	void OnFindBestSession(const TArray<struct FMultiplayerRankedSession>& RankedSessions, bool bWasSuccessfull);
 	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
 	UFUNCTION()
 	void OnDestroySession(bool bWasSuccessfull);
@@ -47,6 +49,21 @@ private:
 	int32 NumPublicConnections{ 4 };
 	FString MatchType{ TEXT("FreeForAll") };
 	FString PathToLobby{ TEXT("") };
+	//Package name of the lobby map, loaded in the background while the session is being created
+	FString LobbyMapName;
+
+	//How many search results the subsystem hands us at once while the search is still running
+	int32 SearchBatchSize{ 8 };
+	//Once this many sessions of our match type are found the search is cut short and they are latency probed
+	int32 NumSessionsToRank{ 8 };
+	bool bIsRanking{ false };
+	bool bIsJoining{ false };
+
+	//While the menu is open the server list is refreshed in the background, so Join can answer from the cache
+	float SessionRefreshInterval{ 15.f };
+	float MaxSearchCacheAge{ 30.f };
+	//Keeps the menu responsive when thousands of sessions come back at once
+	float ResultsProcessingBudgetMs{ 2.f };
 
 	UFUNCTION()
 	void OnHostButtonClicked();
@@ -56,9 +73,8 @@ private:
 
 	void MenuTearDown();
 
-	void LogError(FString ErrorText);
-	void LogWarning(FString WarningText);
-	void LogSuccess(FString SuccessText);
-	void LogVerbose(FString VerboseText);
-	void DebugLog(FString Text, FColor Color);
+	struct FMultiplayerSearchSettings MakeSearchSettings() const;
+
+	//Starts latency probing of the sessions found so far, returns false if there are none of our match type
+	bool TryRankMatchingSessions();
 };
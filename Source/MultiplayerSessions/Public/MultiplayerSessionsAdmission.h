@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EMultiplayerAdmissionResult : uint8
+{
+	Admitted,
+	//Every slot is taken or reserved for someone else
+	Full,
+	//Too many logins are being handled right now, the player may try again shortly
+	Busy
+};
+
+/**
+ * Host side bookkeeping of who may still get in.
+ * A slot is either taken by a player who finished logging in, or reserved for one who is on the way. Reservations are made
+ * ahead (Reserve) or when a login starts (BeginHandshake) and are given back if the player does not arrive in time.
+ * Players are identified by their unique net id string, empty ids are let through without being counted
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsAdmission
+{
+public:
+	void Start(int32 InNumSlots, int32 InMaxConcurrentHandshakes, float InReservationTimeout);
+	void Stop();
+	bool IsActive() const { return bIsActive; }
+
+	//The session was resized, players already in stay even if they no longer fit
+	void SetNumSlots(int32 InNumSlots) { NumSlots = InNumSlots; }
+
+	//False if there is no slot left to hold. Reserving again only extends the reservation
+	bool Reserve(const FString& PlayerId, double Now);
+	//A login started, takes the player's reservation or a free slot
+	EMultiplayerAdmissionResult BeginHandshake(const FString& PlayerId, double Now);
+	//The login went through, the reservation becomes a taken slot
+	void CompleteHandshake(const FString& PlayerId);
+	//The player left, or the login failed after it was admitted
+	void Release(const FString& PlayerId);
+	//Gives back reservations and stuck handshakes past their time, returns how many
+	int32 ExpireReservations(double Now);
+
+	int32 GetNumOpenSlots() const { return FMath::Max(0, NumSlots - Players.Num() - Reservations.Num()); }
+	int32 GetNumReservations() const { return Reservations.Num(); }
+	int32 GetNumHandshakes() const { return NumHandshakes; }
+
+private:
+	struct FReservation
+	{
+		double ExpireTime{ 0.0 };
+		//Counted against the handshake limit until it completes or expires
+		bool bIsHandshaking{ false };
+	};
+
+	TMap<FString, FReservation> Reservations;
+	TSet<FString> Players;
+	int32 NumSlots{ 0 };
+	int32 NumHandshakes{ 0 };
+	int32 MaxConcurrentHandshakes{ 0 };
+	float ReservationTimeout{ 0.f };
+	bool bIsActive{ false };
+
+	void RemoveReservation(const FString& PlayerId);
+};
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "MultiplayerSessionsOperationQueue.h"
+#include "MultiplayerSessionsAsyncActions.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMultiplayerAsyncActionPin);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerAsyncFindSessionsPin, int32, NumResults);
+
+/**
+ * Latent Blueprint nodes on top of the async API of the MultiplayerSessionsSubsystem
+ */
+UCLASS(Abstract)
+class MULTIPLAYERSESSIONS_API UMultiplayerSessionsAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	//Drops the request if it is still waiting (or still searching), the node then leaves through OnFailure
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void Cancel();
+
+protected:
+	TWeakObjectPtr<class UMultiplayerSessionsSubsystem> MultiplayerSessionsSubsystem;
+	FMultiplayerOperationHandle Handle;
+
+	//Null when called outside of a game
+	UMultiplayerSessionsSubsystem* InitSubsystem(UObject* WorldContextObject);
+};
+
+UCLASS()
+class MULTIPLAYERSESSIONS_API UAsyncCreateSession : public UMultiplayerSessionsAsyncAction
+{
+	GENERATED_BODY()
+
+public:
+	//Hosts with one of the presets from the project settings
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncCreateSession* CreateSessionFromPreset(UObject* WorldContextObject, FName PresetName);
+
+	virtual void Activate() override;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncActionPin OnSuccess;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncActionPin OnFailure;
+
+private:
+	FName PresetName;
+};
+
+UCLASS()
+class MULTIPLAYERSESSIONS_API UAsyncFindSessions : public UMultiplayerSessionsAsyncAction
+{
+	GENERATED_BODY()
+
+public:
+	//Results stay with the subsystem, join one by its index with Join Session By Index
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncFindSessions* FindSessions(UObject* WorldContextObject, const FString& MatchType, int32 MaxSearchResults = 10000, float MaxCacheAge = 0.f);
+
+	virtual void Activate() override;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncFindSessionsPin OnSuccess;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncFindSessionsPin OnFailure;
+
+private:
+	FString MatchType;
+	int32 MaxSearchResults{ 10000 };
+	float MaxCacheAge{ 0.f };
+};
+
+UCLASS()
+class MULTIPLAYERSESSIONS_API UAsyncJoinSession : public UMultiplayerSessionsAsyncAction
+{
+	GENERATED_BODY()
+
+public:
+	//Joins a result of the last search, bTravel moves the first local player there on success
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncJoinSession* JoinSessionByIndex(UObject* WorldContextObject, int32 ResultIndex, bool bTravel = true);
+
+	virtual void Activate() override;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncActionPin OnSuccess;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncActionPin OnFailure;
+
+private:
+	int32 ResultIndex{ INDEX_NONE };
+	bool bTravel{ true };
+};
+
+UCLASS()
+class MULTIPLAYERSESSIONS_API UAsyncDestroySession : public UMultiplayerSessionsAsyncAction
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncDestroySession* DestroySession(UObject* WorldContextObject);
+
+	virtual void Activate() override;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncActionPin OnSuccess;
+
+	UPROPERTY(BlueprintAssignable)
+	FMultiplayerAsyncActionPin OnFailure;
+};
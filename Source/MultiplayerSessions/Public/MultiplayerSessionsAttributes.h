@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include <type_traits>
+
+/**
+ * Every session attribute the plugin advertises or searches by, declared once:
+ * value type, key, how it is advertised, how searches compare it and what a session without it reads as
+ */
+#define MULTIPLAYER_SESSION_ATTRIBUTES(Attribute) \
+	Attribute(FString, MatchType,          ViaOnlineServiceAndPing, Equals, TEXT("")) \
+	Attribute(FString, MatchName,          ViaOnlineServiceAndPing, Equals, TEXT("")) \
+	Attribute(FString, GameName,           ViaOnlineServiceAndPing, Equals, TEXT("ShooterJam")) \
+	Attribute(int32,   BuildId,            ViaOnlineServiceAndPing, Equals, 0) \
+	/*Sent by dedicated servers with every heartbeat that found it changed*/ \
+	Attribute(int32,   NumPlayers,         ViaOnlineServiceAndPing, Equals, 0) \
+	/*Set on the party session by its leader, where the members should follow to. Members only read them*/ \
+	Attribute(FString, PartyGameSessionId, ViaOnlineService,        Equals, TEXT("")) \
+	Attribute(FString, PartyGameMatchType, ViaOnlineService,        Equals, TEXT("")) \
+	/*Free slots minus reservations, the backend itself only counts who is in*/ \
+	Attribute(int32,   OpenSlots,          ViaOnlineServiceAndPing, GreaterThanEquals, 0) \
+	/*Matchmaking criteria, see FMultiplayerSessionsScoringTable*/ \
+	Attribute(int32,   SkillBracket,       ViaOnlineServiceAndPing, Equals, 0) \
+	Attribute(FString, Region,             ViaOnlineServiceAndPing, Equals, TEXT("")) \
+	/*UDP port the host answers latency probes on, 0 if it answers none*/ \
+	Attribute(int32,   LatencyEchoPort,    ViaOnlineServiceAndPing, Equals, 0)
+
+enum class EMultiplayerSessionAttribute : uint8
+{
+#define MULTIPLAYER_SESSION_ATTRIBUTE_ID(ValueType, Name, Advertisement, Comparison, Default) Name,
+	MULTIPLAYER_SESSION_ATTRIBUTES(MULTIPLAYER_SESSION_ATTRIBUTE_ID)
+#undef MULTIPLAYER_SESSION_ATTRIBUTE_ID
+
+	Num
+};
+
+namespace MultiplayerSessionAttributes
+{
+	//Keys of all attributes by EMultiplayerSessionAttribute, made once so reading and writing never touches the name table
+	MULTIPLAYERSESSIONS_API const FName& GetKey(EMultiplayerSessionAttribute Attribute);
+}
+
+/**
+ * Typed key of a session attribute, only ever declared through MULTIPLAYER_SESSION_ATTRIBUTES
+ */
+template<typename ValueType>
+struct TMultiplayerSessionAttribute
+{
+	//FString has no constexpr constructor, string defaults are kept as literals
+	using FDefaultType = std::conditional_t<std::is_same_v<ValueType, FString>, const TCHAR*, ValueType>;
+
+	EMultiplayerSessionAttribute Id;
+	const TCHAR* Name;
+	EOnlineDataAdvertisementType::Type Advertisement;
+	EOnlineComparisonOp::Type Comparison;
+	FDefaultType Default;
+
+	const FName& GetKey() const { return MultiplayerSessionAttributes::GetKey(Id); }
+
+	void Write(FOnlineSessionSettings& Settings, const ValueType& Value) const
+	{
+		Settings.Set(GetKey(), Value, Advertisement);
+	}
+
+	void WriteDefault(FOnlineSessionSettings& Settings) const
+	{
+		Write(Settings, ValueType(Default));
+	}
+
+	//The default if the session does not advertise it
+	ValueType Read(const FOnlineSessionSettings& Settings) const
+	{
+		ValueType Value(Default);
+		Settings.Get(GetKey(), Value);
+		return Value;
+	}
+
+	//Leaves OutValue alone and returns false if the session does not advertise it
+	bool TryRead(const FOnlineSessionSettings& Settings, ValueType& OutValue) const
+	{
+		return Settings.Get(GetKey(), OutValue);
+	}
+
+	void Query(FOnlineSearchSettings& QuerySettings, const ValueType& Value) const
+	{
+		QuerySettings.Set(GetKey(), Value, Comparison);
+	}
+};
+
+namespace MultiplayerSessionAttributes
+{
+#define MULTIPLAYER_SESSION_ATTRIBUTE_DECLARATION(ValueType, AttributeName, InAdvertisement, InComparison, InDefault) \
+	inline constexpr TMultiplayerSessionAttribute<ValueType> AttributeName{ EMultiplayerSessionAttribute::AttributeName, TEXT(#AttributeName), \
+		EOnlineDataAdvertisementType::InAdvertisement, EOnlineComparisonOp::InComparison, InDefault };
+	MULTIPLAYER_SESSION_ATTRIBUTES(MULTIPLAYER_SESSION_ATTRIBUTE_DECLARATION)
+#undef MULTIPLAYER_SESSION_ATTRIBUTE_DECLARATION
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineDelegateMacros.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+class FNamedOnlineSession;
+class FOnlineSession;
+class FOnlineSessionSettings;
+class FOnlineSessionSearch;
+class FOnlineSessionSearchResult;
+
+//IOnlineSession takes a one-off delegate per lookup, the backend reports through a list like every other request
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnFindSessionByIdComplete, bool, const FOnlineSessionSearchResult&);
+typedef FOnFindSessionByIdComplete::FDelegate FOnFindSessionByIdCompleteDelegate;
+
+/**
+ * The part of IOnlineSession the subsystem talks to.
+ * Requests return false if they could not be started, otherwise the matching completion delegates fire later.
+ * A null user id means the backend should act for the default local user
+ */
+class MULTIPLAYERSESSIONS_API IMultiplayerSessionsBackend
+{
+public:
+	virtual ~IMultiplayerSessionsBackend() = default;
+
+	virtual FName GetBackendName() const = 0;
+
+	virtual bool CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) = 0;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) = 0;
+	virtual bool StartSession(FName SessionName) = 0;
+	virtual bool DestroySession(FName SessionName) = 0;
+	virtual bool FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) = 0;
+	virtual bool CancelFindSessions() = 0;
+	virtual bool JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) = 0;
+	//Looks up a single session without searching, e.g. the one a party leader is in. Not every backend can, false then
+	virtual bool FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId) = 0;
+
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) = 0;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo) = 0;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) = 0;
+
+	DEFINE_ONLINE_DELEGATE_TWO_PARAM(OnCreateSessionComplete, FName, bool);
+	DEFINE_ONLINE_DELEGATE_TWO_PARAM(OnUpdateSessionComplete, FName, bool);
+	DEFINE_ONLINE_DELEGATE_TWO_PARAM(OnStartSessionComplete, FName, bool);
+	DEFINE_ONLINE_DELEGATE_TWO_PARAM(OnDestroySessionComplete, FName, bool);
+	DEFINE_ONLINE_DELEGATE_ONE_PARAM(OnFindSessionsComplete, bool);
+	DEFINE_ONLINE_DELEGATE_TWO_PARAM(OnJoinSessionComplete, FName, EOnJoinSessionCompleteResult::Type);
+	DEFINE_ONLINE_DELEGATE_TWO_PARAM(OnFindSessionByIdComplete, bool, const FOnlineSessionSearchResult&);
+};
+
+namespace MultiplayerSessionsBackend
+{
+	//For backends that filter searches themselves: the subsystem's lobby, dedicated and open slot keys, and equality on attributes
+	MULTIPLAYERSESSIONS_API bool MatchesQuery(const FOnlineSession& Session, const FOnlineSessionSearch& Search);
+}
+
+/**
+ * Forwards to the session interface of an online subsystem (Steam, NULL, ...)
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsOnlineBackend : public IMultiplayerSessionsBackend
+{
+public:
+	FMultiplayerSessionsOnlineBackend(IOnlineSessionPtr InSessionInterface, FName InSubsystemName);
+	virtual ~FMultiplayerSessionsOnlineBackend() override;
+
+	virtual FName GetBackendName() const override { return SubsystemName; }
+
+	virtual bool CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName) override;
+	virtual bool FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool CancelFindSessions() override;
+	virtual bool JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId) override;
+
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+
+private:
+	IOnlineSessionPtr SessionInterface;
+	FName SubsystemName;
+	//Single session lookups take a one-off completion delegate that can't be removed, it checks this is still alive
+	TSharedRef<bool> LifetimeToken{ MakeShared<bool>(true) };
+
+	//Registered once for the lifetime of the backend, completions are passed on to our own delegate lists
+	FDelegateHandle CreateSessionCompleteDelegate_Handle;
+	FDelegateHandle UpdateSessionCompleteDelegate_Handle;
+	FDelegateHandle StartSessionCompleteDelegate_Handle;
+	FDelegateHandle DestroySessionCompleteDelegate_Handle;
+	FDelegateHandle FindSessionsCompleteDelegate_Handle;
+	FDelegateHandle JoinSessionCompleteDelegate_Handle;
+};
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "MultiplayerSessionsFakeBackend.h"
+#include "MultiplayerSessionsBenchmark.generated.h"
+
+class UMultiplayerSessionsSubsystem;
+class IMultiplayerSessionsBackend;
+
+struct FMultiplayerSessionsBenchmarkSettings
+{
+	//One cycle hosts (create, start, destroy) and then plays as a client (find, join, leave)
+	int32 NumCycles{ 100 };
+	FString MatchType{ TEXT("FreeForAll") };
+	int32 MaxSearchResults{ 10000 };
+	int32 SearchBatchSize{ 64 };
+	//How many of the found sessions the join may fall back to
+	int32 NumJoinCandidates{ 8 };
+
+	FMultiplayerFakeBackendSettings BackendSettings;
+
+	//Exit the process once done, with a non-zero code if any step failed
+	bool bQuitWhenDone{ false };
+};
+
+/**
+ * Drives UMultiplayerSessionsSubsystem through create/find/join cycles against the fake backend and reports
+ * throughput and per operation latency. Needs no network, runs headless:
+ * -nullrhi -unattended -ExecCmds="MultiplayerSessions.Benchmark Cycles=500 Sessions=20000 Quit"
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UMultiplayerSessionsBenchmark : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//The subsystem is switched to a fake backend for the duration of the run, returns null if a run is already going
+	static UMultiplayerSessionsBenchmark* Run(UMultiplayerSessionsSubsystem* InSubsystem, const FMultiplayerSessionsBenchmarkSettings& InSettings);
+
+	bool IsRunning() const { return Step != EStep::Done; }
+
+protected:
+	UFUNCTION()
+	void OnCreateSession(bool bWasSuccessfull);
+	UFUNCTION()
+	void OnStartSession(bool bWasSuccessfull);
+	UFUNCTION()
+	void OnDestroySession(bool bWasSuccessfull);
+	void OnFindSessions(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull);
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+
+private:
+	enum class EStep : uint8
+	{
+		Create,
+		Start,
+		StopHosting,
+		Find,
+		Join,
+		Leave,
+		Done
+	};
+
+	static TWeakObjectPtr<UMultiplayerSessionsBenchmark> ActiveBenchmark;
+
+	UPROPERTY()
+	TObjectPtr<UMultiplayerSessionsSubsystem> Subsystem;
+
+	FMultiplayerSessionsBenchmarkSettings Settings;
+	TSharedPtr<IMultiplayerSessionsBackend> PreviousBackend;
+	//Fake joins must not overwrite or delete the player's reconnect save slot
+	bool bPreviousReconnectRecordEnabled{ true };
+
+	EStep Step{ EStep::Done };
+	int32 NumCompletedCycles{ 0 };
+	int32 NumFailedSteps{ 0 };
+	int32 NumSearchResults{ 0 };
+	//Matchmaking scoring pass over every search, timed apart from the operations
+	int32 NumScoringPasses{ 0 };
+	double ScoringSeconds{ 0.0 };
+	double StartTime{ 0.0 };
+
+	void Start(UMultiplayerSessionsSubsystem* InSubsystem, const FMultiplayerSessionsBenchmarkSettings& InSettings);
+	void RunStep(EStep NextStep);
+	void CompleteStep(bool bWasSuccessfull, EStep NextStep, EStep NextStepOnFailure);
+	void Finish();
+	void Report() const;
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Math/RandomStream.h"
+#include "OnlineSessionSettings.h"
+#include "MultiplayerSessionsBackend.h"
+
+struct FMultiplayerFakeBackendSettings
+{
+	//Sessions other players are hosting, visible to FindSessions
+	int32 NumSessions{ 1000 };
+	int32 MaxPublicConnections{ 16 };
+	TArray<FString> MatchTypes{ TEXT("FreeForAll"), TEXT("TeamDeathMatch") };
+	int32 BuildId{ 1 };
+	//Share of the hosted sessions that are already full
+	float FullSessionRate{ 0.1f };
+	//Share of the hosted sessions that are dedicated servers instead of player hosted lobbies
+	float DedicatedServerRate{ 0.f };
+
+	//Every request completes after a random delay in this range, in seconds
+	float MinResponseTime{ 0.02f };
+	float MaxResponseTime{ 0.1f };
+	//Search results show up in chunks of this size every tick, like a server list filling up
+	int32 ResultsPerTick{ 256 };
+
+	//Chance of the backend failing a request, 0..1
+	float CreateFailureRate{ 0.f };
+	float FindFailureRate{ 0.f };
+	float JoinFailureRate{ 0.f };
+
+	int32 RandomSeed{ 0 };
+};
+
+/**
+ * In-process stand-in for an online backend, needs no network or platform services.
+ * Hosts a set of synthetic sessions that can be searched for and joined, taking a join fills a slot.
+ * Completions are delivered from the core ticker, same as a real online subsystem would
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsFakeBackend : public IMultiplayerSessionsBackend
+{
+public:
+	static const FName BackendName;
+
+	explicit FMultiplayerSessionsFakeBackend(const FMultiplayerFakeBackendSettings& InSettings = FMultiplayerFakeBackendSettings());
+	virtual ~FMultiplayerSessionsFakeBackend() override;
+
+	virtual FName GetBackendName() const override { return BackendName; }
+
+	virtual bool CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName) override;
+	virtual bool FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool CancelFindSessions() override;
+	virtual bool JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId) override;
+
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+
+	//Rebuilds the hosted sessions, pending requests are dropped without completing
+	void Reset(const FMultiplayerFakeBackendSettings& InSettings);
+	const FMultiplayerFakeBackendSettings& GetSettings() const { return Settings; }
+	int32 GetNumHostedSessions() const { return HostedSessions.Num(); }
+
+private:
+	struct FPendingRequest
+	{
+		double DueTime{ 0.0 };
+		TFunction<void()> Complete;
+	};
+
+	FMultiplayerFakeBackendSettings Settings;
+	FRandomStream RandomStream;
+
+	TArray<FOnlineSession> HostedSessions;
+	TArray<int32> HostedSessionPings;
+	TMap<FString, int32> HostedSessionIndices;
+	TMap<FName, TUniquePtr<FNamedOnlineSession>> NamedSessions;
+
+	TArray<FPendingRequest> PendingRequests;
+
+	//Only one search at a time, same as the online subsystems
+	TSharedPtr<FOnlineSessionSearch> ActiveSearch;
+	int32 NextSearchCandidate{ 0 };
+	double SearchDueTime{ 0.0 };
+	bool bSearchFails{ false };
+
+	FTSTicker::FDelegateHandle Ticker_Handle;
+
+	bool Tick(float DeltaTime);
+	void TickSearch(double Now);
+	void CompleteSearch(bool bWasSuccessfull);
+	void Defer(TFunction<void()>&& Complete);
+	double GetResponseTime();
+	bool RollFailure(float FailureRate);
+	void BuildHostedSessions();
+};
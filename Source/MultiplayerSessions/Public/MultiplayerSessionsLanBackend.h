@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "OnlineSessionSettings.h"
+#include "MultiplayerSessionsBackend.h"
+#include "MultiplayerSessionsLanDiscovery.h"
+
+/**
+ * LAN sessions over the plugin's own UDP discovery instead of the NULL online subsystem, whose searches always wait out a fixed timeout.
+ * Hosts answer on a range of ports, searches query all of them every BroadcastInterval and end after ResponseTimeout or
+ * as soon as enough hosts answered. While listening the host list is kept up to date in the background and searches complete right away.
+ * Works over loopback alone, several hosts on one machine each take their own port of the range
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsLanBackend : public IMultiplayerSessionsBackend
+{
+public:
+	static const FName BackendName;
+
+	explicit FMultiplayerSessionsLanBackend(const FMultiplayerLanDiscoverySettings& InSettings = FMultiplayerLanDiscoverySettings());
+	virtual ~FMultiplayerSessionsLanBackend() override;
+
+	virtual FName GetBackendName() const override { return BackendName; }
+
+	virtual bool CreateSession(FUniqueNetIdPtr HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName) override;
+	virtual bool FindSessions(FUniqueNetIdPtr SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool CancelFindSessions() override;
+	virtual bool JoinSession(FUniqueNetIdPtr PlayerId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool FindSessionById(FUniqueNetIdPtr SearchingPlayerId, const FString& SessionId) override;
+
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+
+	//Keeps discovering in the background until stopped
+	bool StartListening();
+	void StopListening();
+	bool IsListening() const { return bIsListening; }
+
+	//Hosts that answered lately, only kept while listening or searching
+	const TMap<FString, FMultiplayerLanHost>& GetHosts() const { return Discovery.GetHosts(); }
+	FOnMultiplayerLanHostsChanged& OnHostsChanged() { return Discovery.OnHostsChanged; }
+
+	const FMultiplayerLanDiscoverySettings& GetSettings() const { return Settings; }
+	//Discovery port this host answers on, 0 while it hosts nothing
+	int32 GetBeaconPort() const { return Beacon.GetPort(); }
+
+private:
+	struct FPendingLookup
+	{
+		FString SessionId;
+		double Deadline{ 0.0 };
+	};
+
+	FMultiplayerLanDiscoverySettings Settings;
+	FMultiplayerSessionsLanBeacon Beacon;
+	FMultiplayerSessionsLanDiscovery Discovery;
+
+	TMap<FName, TUniquePtr<FNamedOnlineSession>> NamedSessions;
+	TArray<TFunction<void()>> PendingCompletions;
+
+	bool bIsListening{ false };
+	double ListenStartTime{ 0.0 };
+
+	//Only one search at a time, same as the online subsystems
+	TSharedPtr<FOnlineSessionSearch> ActiveSearch;
+	TSet<FString> ActiveSearchSessionIds;
+	double SearchStartTime{ 0.0 };
+
+	TArray<FPendingLookup> PendingLookups;
+
+	FTSTicker::FDelegateHandle Ticker_Handle;
+
+	bool Tick(float DeltaTime);
+	void TickSearch(double Now);
+	void TickLookups(double Now);
+	void CompleteSearch(bool bWasSuccessfull);
+	//Completes on the next tick, same as an online subsystem would
+	void Defer(TFunction<void()>&& Complete);
+	//Runs discovery while anything needs it, false if it is needed but could not start
+	bool UpdateDiscovery();
+	//Advertises every hosted session, stops answering once there are none
+	void UpdateBeacon();
+	int32 GetGamePort() const;
+	FOnlineSessionSearchResult MakeSearchResult(const FMultiplayerLanHost& Host) const;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "OnlineSessionSettings.h"
+
+class FSocket;
+class FInternetAddr;
+
+struct FMultiplayerLanDiscoverySettings
+{
+	//First UDP port hosts answer discovery on. Each host takes the first free one of NumPorts in a row,
+	//so several hosts fit on one machine and a search asks all of them at once
+	int32 Port{ 14011 };
+	int32 NumPorts{ 4 };
+	//Seconds between queries while a search runs, lost datagrams are made up for by the next one
+	float BroadcastInterval{ 0.1f };
+	//Seconds between queries while only listening
+	float ListenInterval{ 1.f };
+	//A search lists whoever answered by then
+	float ResponseTimeout{ 0.5f };
+	//A search ends as soon as this many hosts answered, 0 always waits out the timeout
+	int32 NumRespondersToComplete{ 0 };
+	//Listening forgets hosts that did not answer for this long
+	float HostTimeout{ 3.f };
+	//Port clients travel to, 0 takes -Port= from the command line or the engine's default
+	int32 GamePort{ 0 };
+};
+
+/**
+ * A session some host on the network answered with
+ */
+struct FMultiplayerLanHost
+{
+	FString SessionId;
+	//Resolved connect string, "ip:port" of the host's game
+	FString Address;
+	//Everything but the session info, which the backend adds
+	FOnlineSession Session;
+	int32 PingInMs{ 0 };
+	double LastSeenTime{ 0.0 };
+	//Changes whenever the host advertises something else
+	uint32 DescriptionHash{ 0 };
+};
+
+/**
+ * Host side of LAN discovery: answers every query with the sessions it advertises.
+ * Binds to all interfaces, so it is reached both by broadcasts and by queries sent to loopback
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsLanBeacon
+{
+public:
+	~FMultiplayerSessionsLanBeacon();
+
+	//Binds the first free port of the range, false if all of them are taken
+	bool Start(const FMultiplayerLanDiscoverySettings& InSettings);
+	void Stop();
+	bool IsRunning() const { return Socket != nullptr; }
+	int32 GetPort() const { return Port; }
+
+	//What every query is answered with from now on, an empty list answers nothing
+	void SetSessions(TConstArrayView<const FOnlineSession*> Sessions, int32 GamePort);
+
+private:
+	FSocket* Socket{ nullptr };
+	int32 Port{ 0 };
+	//Reply without the header, serialized once per change instead of once per query
+	TArray<uint8> Description;
+	int32 NumSessions{ 0 };
+	FTSTicker::FDelegateHandle Ticker_Handle;
+
+	bool Tick(float DeltaTime);
+};
+
+DECLARE_MULTICAST_DELEGATE(FOnMultiplayerLanHostsChanged);
+
+/**
+ * Client side of LAN discovery: queries the whole port range by broadcast and on loopback, and keeps what comes back.
+ * Hosts are kept by session id until they stop answering for HostTimeout
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsLanDiscovery
+{
+public:
+	~FMultiplayerSessionsLanDiscovery();
+
+	bool Start(const FMultiplayerLanDiscoverySettings& InSettings);
+	void Stop();
+	bool IsRunning() const { return Socket != nullptr; }
+
+	//Searches query every BroadcastInterval, otherwise every ListenInterval
+	void SetSearching(bool bInSearching);
+	//Queries right away instead of waiting for the interval
+	void Broadcast();
+
+	const TMap<FString, FMultiplayerLanHost>& GetHosts() const { return Hosts; }
+	const FMultiplayerLanHost* FindHost(const FString& SessionId) const { return Hosts.Find(SessionId); }
+
+	//A host answered for the first time, changed what it advertises or timed out
+	FOnMultiplayerLanHostsChanged OnHostsChanged;
+
+private:
+	FMultiplayerLanDiscoverySettings Settings;
+	FSocket* Socket{ nullptr };
+	TArray<TSharedRef<FInternetAddr>> QueryAddresses;
+	TMap<FString, FMultiplayerLanHost> Hosts;
+	//Replies to another client's queries carry its nonce, not ours
+	uint32 Nonce{ 0 };
+	double LastQueryTime{ 0.0 };
+	bool bSearching{ false };
+	FTSTicker::FDelegateHandle Ticker_Handle;
+
+	bool Tick(float DeltaTime);
+	bool ReceiveReplies(double Now);
+	bool ExpireHosts(double Now);
+};
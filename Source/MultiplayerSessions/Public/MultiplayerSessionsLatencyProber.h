@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "HAL/Runnable.h"
+
+#include <atomic>
+
+class FSocket;
+class FInternetAddr;
+class FRunnableThread;
+
+struct FMultiplayerLatencyProbeTarget
+{
+	int32 ResultIndex{ INDEX_NONE };
+	//Resolved connect string of the session, "ip:port"
+	FString Address;
+	//What the backend measured during the search, if anything
+	int32 ReportedPingInMs{ 0 };
+	//Port the host answers probes on, as advertised by the session. 0 if it answers none
+	int32 EchoPort{ 0 };
+};
+
+//Round trip per target in the same order as the targets, INDEX_NONE for the ones that did not answer in time
+DECLARE_DELEGATE_OneParam(FOnMultiplayerLatencyProbeComplete, const TArray<int32>& RttInMs);
+
+/**
+ * Measures latency to a set of session hosts. All targets of one ProbeAsync call are probed concurrently
+ */
+class MULTIPLAYERSESSIONS_API IMultiplayerSessionsLatencyProber
+{
+public:
+	virtual ~IMultiplayerSessionsLatencyProber() = default;
+
+	//Only one probe runs at a time, starting a new one cancels the previous without calling its delegate
+	virtual void ProbeAsync(const TArray<FMultiplayerLatencyProbeTarget>& Targets, float TimeoutSeconds, FOnMultiplayerLatencyProbeComplete OnComplete) = 0;
+	virtual void CancelProbe() = 0;
+};
+
+/**
+ * Trusts the ping the backend measured during the search. Steam and LAN searches both report it, completes synchronously
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsReportedPingProber : public IMultiplayerSessionsLatencyProber
+{
+public:
+	virtual void ProbeAsync(const TArray<FMultiplayerLatencyProbeTarget>& Targets, float TimeoutSeconds, FOnMultiplayerLatencyProbeComplete OnComplete) override;
+	virtual void CancelProbe() override {}
+};
+
+/**
+ * Fires a UDP datagram at every target at once and measures the time until it comes back.
+ * Needs something on the other end that echoes the datagram, see FMultiplayerSessionsUdpEchoServer.
+ * Targets without an echo port keep the ping the backend reported for them
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsUdpEchoProber : public IMultiplayerSessionsLatencyProber
+{
+public:
+	//EchoPort > 0 probes that port on hosts that do not advertise one
+	explicit FMultiplayerSessionsUdpEchoProber(int32 InEchoPort = 0);
+	virtual ~FMultiplayerSessionsUdpEchoProber() override;
+
+	virtual void ProbeAsync(const TArray<FMultiplayerLatencyProbeTarget>& Targets, float TimeoutSeconds, FOnMultiplayerLatencyProbeComplete OnComplete) override;
+	virtual void CancelProbe() override;
+
+private:
+	int32 EchoPort{ 0 };
+	//Datagrams get lost, unanswered targets are pinged again every interval until the timeout
+	float ResendInterval{ 0.1f };
+
+	FSocket* Socket{ nullptr };
+	FTSTicker::FDelegateHandle Ticker_Handle;
+	FOnMultiplayerLatencyProbeComplete OnProbeComplete;
+
+	//Null for targets that are not probed
+	TArray<TSharedPtr<FInternetAddr>> TargetAddresses;
+	TArray<int32> RttInMs;
+	TArray<int32> ProbedRttInMs;
+	uint32 ProbeId{ 0 };
+	double ProbeStartTime{ 0.0 };
+	double LastSendTime{ 0.0 };
+	float ProbeTimeout{ 0.f };
+
+	bool TickProbe(float DeltaTime);
+	void SendPings();
+	void ReceivePongs();
+	void FinishProbe();
+	void CloseSocket();
+};
+
+/**
+ * Answers latency probes on the host by echoing every datagram it gets, optionally after an artificial delay to stand in
+ * for a remote host. Runs on its own thread so it answers even while the game thread is busy
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsUdpEchoServer : public FRunnable
+{
+public:
+	FMultiplayerSessionsUdpEchoServer(int32 InPort, int32 InArtificialLatencyMs = 0);
+	virtual ~FMultiplayerSessionsUdpEchoServer() override;
+
+	bool Start();
+	void Shutdown();
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	int32 GetPort() const { return Port; }
+
+private:
+	struct FPendingEcho
+	{
+		TArray<uint8> Data;
+		TSharedPtr<FInternetAddr> Address;
+		double DueTime{ 0.0 };
+	};
+
+	int32 Port{ 0 };
+	int32 ArtificialLatencyMs{ 0 };
+	FSocket* Socket{ nullptr };
+	FRunnableThread* Thread{ nullptr };
+	std::atomic<bool> bStopping{ false };
+	TArray<FPendingEcho> PendingEchoes;
+};
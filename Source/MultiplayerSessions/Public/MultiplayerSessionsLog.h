@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Logging/LogMacros.h"
+
+//Shipping keeps warnings and errors only, everything below is compiled out together with its arguments
+#if UE_BUILD_SHIPPING
+MULTIPLAYERSESSIONS_API DECLARE_LOG_CATEGORY_EXTERN(LogMultiplayerSessions, Log, Warning);
+#else
+MULTIPLAYERSESSIONS_API DECLARE_LOG_CATEGORY_EXTERN(LogMultiplayerSessions, Log, All);
+#endif
+
+namespace MultiplayerSessionsLog
+{
+	//Runtime switch for the on-screen sink, same as "MultiplayerSessions.LogToScreen 1"
+	MULTIPLAYERSESSIONS_API bool IsScreenSinkEnabled();
+	MULTIPLAYERSESSIONS_API void SetScreenSinkEnabled(bool bEnabled);
+	MULTIPLAYERSESSIONS_API void AddScreenMessage(ELogVerbosity::Type Verbosity, const FString& Message);
+}
+
+/**
+ * UE_LOG to LogMultiplayerSessions, mirrored to the screen while the screen sink is on.
+ * Arguments are only evaluated and formatted if the verbosity is compiled in and enabled, and only once for both
+ */
+#if UE_BUILD_SHIPPING
+#define MULTIPLAYER_LOG(Verbosity, Format, ...) \
+	UE_LOG(LogMultiplayerSessions, Verbosity, Format, ##__VA_ARGS__)
+#else
+#define MULTIPLAYER_LOG(Verbosity, Format, ...) \
+	do \
+	{ \
+		if (UE_LOG_ACTIVE(LogMultiplayerSessions, Verbosity)) \
+		{ \
+			const FString MultiplayerLogMessage{ FString::Printf(Format, ##__VA_ARGS__) }; \
+			UE_LOG(LogMultiplayerSessions, Verbosity, TEXT("%s"), *MultiplayerLogMessage); \
+			if (MultiplayerSessionsLog::IsScreenSinkEnabled()) \
+			{ \
+				MultiplayerSessionsLog::AddScreenMessage(ELogVerbosity::Verbosity, MultiplayerLogMessage); \
+			} \
+		} \
+	} while (0)
+#endif
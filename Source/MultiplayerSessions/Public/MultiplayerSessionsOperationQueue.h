@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+enum class EMultiplayerSessionOperation : uint8
+{
+	Create,
+	Find,
+	Join,
+	Destroy,
+	Start,
+	Update,
+	//Client travel after a successful join, only timed, never queued
+	Travel,
+
+	Num
+};
+
+enum class EMultiplayerOperationAbortReason : uint8
+{
+	//Cancelled by the caller through its handle
+	Cancelled,
+	//A newer request of the same type replaced it
+	Superseded,
+	TimedOut
+};
+
+struct FMultiplayerOperationHandle
+{
+	uint32 Id{ 0 };
+
+	bool IsValid() const { return Id != 0; }
+	bool operator==(const FMultiplayerOperationHandle& Other) const { return Id == Other.Id; }
+	bool operator!=(const FMultiplayerOperationHandle& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FMultiplayerOperationHandle& Handle) { return Handle.Id; }
+};
+
+/**
+ * Runs session operations one at a time in request order.
+ * A request for an operation type that is already waiting in the queue for the same named session is merged into
+ * the waiting one, the newest request wins but keeps the handle of the first one. Only if nothing that creates, destroys
+ * or joins that session waits behind it, otherwise the request is queued at the end
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsOperationQueue
+{
+public:
+	//Returns false if the operation could not even be started, it is then treated as completed
+	using FExecuteFunction = TFunction<bool()>;
+	//Called for the running operation on timeout, cancellation or when a newer request supersedes it.
+	//Never for waiting ones, those did not start anything that would need stopping
+	using FAbortFunction = TFunction<void(EMultiplayerOperationAbortReason)>;
+	//Called for every request that leaves the queue without completing, after the abort function of a running one.
+	//Merged requests keep their handle, so those don't count. bWasStarted is false for waiting ones that never ran
+	using FDroppedFunction = TFunction<void(FMultiplayerOperationHandle, EMultiplayerSessionOperation, EMultiplayerOperationAbortReason, bool bWasStarted)>;
+
+	~FMultiplayerSessionsOperationQueue();
+
+	//bSupersedeActive aborts a running operation of the same type instead of waiting for it.
+	//SessionName is the named session the operation acts on, NAME_None for ones that don't act on a session (searches)
+	FMultiplayerOperationHandle Enqueue(EMultiplayerSessionOperation Type, FExecuteFunction Execute, FAbortFunction Abort, float TimeoutSeconds, bool bSupersedeActive = false, FName SessionName = NAME_None);
+
+	//The running operation of that type reported back, starts the next one. With a SessionName only if it runs for that session
+	void CompleteActive(EMultiplayerSessionOperation Type, FName SessionName = NAME_None);
+
+	//Waiting operations are always cancellable, running ones only if bAllowActive
+	bool Cancel(FMultiplayerOperationHandle Handle, bool bAllowActive);
+	bool CancelType(EMultiplayerSessionOperation Type, bool bAllowActive);
+	//Drops everything without calling abort, used on shutdown
+	void Reset();
+
+	void SetOnDropped(FDroppedFunction InOnDropped) { OnDropped = MoveTemp(InOnDropped); }
+
+	bool IsActive(EMultiplayerSessionOperation Type) const;
+	bool IsPending(EMultiplayerSessionOperation Type) const;
+	FMultiplayerOperationHandle GetActiveHandle() const;
+	FName GetActiveSessionName() const { return ActiveOperation.IsSet() ? ActiveOperation->SessionName : NAME_None; }
+	int32 GetNumPending() const { return PendingOperations.Num(); }
+
+private:
+	struct FOperation
+	{
+		FMultiplayerOperationHandle Handle;
+		EMultiplayerSessionOperation Type{ EMultiplayerSessionOperation::Create };
+		FName SessionName;
+		FExecuteFunction Execute;
+		FAbortFunction Abort;
+		float TimeoutSeconds{ 0.f };
+		double StartTime{ 0.0 };
+	};
+
+	TArray<FOperation> PendingOperations;
+	TOptional<FOperation> ActiveOperation;
+	FDroppedFunction OnDropped;
+	uint32 NextHandleId{ 1 };
+	bool bIsStartingNext{ false };
+	FTSTicker::FDelegateHandle TimeoutTicker_Handle;
+
+	void StartNext();
+	void AbortActive(EMultiplayerOperationAbortReason Reason);
+	bool TickTimeouts(float DeltaTime);
+	void StopTimeoutTicker();
+	//Merging across one of these would run the request against another session than it was made for
+	static bool IsSessionLifetimeOperation(EMultiplayerSessionOperation Type);
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SaveGame.h"
+#include "MultiplayerSessionsReconnectRecord.generated.h"
+
+/**
+ * The session we joined last, saved so the player can get back to it after a crash or disconnect without searching
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UMultiplayerSessionsReconnectRecord : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	static const FString SlotName;
+
+	UPROPERTY()
+	FString SessionId;
+
+	//Connect string as resolved when we joined, what ClientTravel needs
+	UPROPERTY()
+	FString SessionAddress;
+
+	//Narrows down the search if the address does not work anymore
+	UPROPERTY()
+	FString MatchType;
+
+	UPROPERTY()
+	FDateTime JoinedTime;
+
+	bool IsValidFor(FTimespan MaxAge) const;
+};
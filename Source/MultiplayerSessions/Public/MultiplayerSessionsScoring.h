@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "MultiplayerSessionsScoring.generated.h"
+
+struct FMultiplayerRankedSession;
+
+/**
+ * How much each criterion costs, every score is a sum of penalties and lower is better
+ */
+USTRUCT(BlueprintType)
+struct FMultiplayerScoringWeights
+{
+	GENERATED_BODY()
+
+	//Per millisecond of reported ping
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ping", meta = (ClampMin = 0))
+	float PingWeight{ 1.f };
+
+	//What hosts that did not report a ping are assumed to answer in
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ping", meta = (ClampMin = 0))
+	float UnknownPingMs{ 150.f };
+
+	//Hosts slower than this are left out, 0 keeps everyone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ping", meta = (ClampMin = 0))
+	float MaxPingMs{ 0.f };
+
+	//Preferred share of taken slots. 0 spreads players over the emptier sessions, 1 fills up nearly full ones first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fill", meta = (ClampMin = 0, ClampMax = 1))
+	float TargetFillRatio{ 0.f };
+
+	//Cost of being as far from the target fill ratio as it gets
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fill", meta = (ClampMin = 0))
+	float FillWeight{ 30.f };
+
+	//Per bracket between the player and the session
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skill", meta = (ClampMin = 0))
+	float SkillWeight{ 25.f };
+
+	//Sessions more brackets away are left out, negative keeps everyone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skill")
+	int32 MaxSkillBracketDistance{ -1 };
+
+	//Added when the session is hosted in another region than the player asked for
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Region", meta = (ClampMin = 0))
+	float RegionMismatchPenalty{ 60.f };
+
+	//Sessions of another build can't be joined anyway, unless the backend does not report builds
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Build")
+	bool bRequireSameBuild{ true };
+};
+
+/**
+ * Matchmaking weights as an asset, so designers can tune them per game mode.
+ * The default profile is set in the plugin settings
+ */
+UCLASS(BlueprintType)
+class MULTIPLAYERSESSIONS_API UMultiplayerSessionsScoringProfile : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scoring")
+	FMultiplayerScoringWeights Weights;
+};
+
+/**
+ * What the player is looking for, sessions are scored against it
+ */
+struct FMultiplayerScoringQuery
+{
+	//Empty scores every match type
+	FString MatchType;
+	int32 SkillBracket{ 0 };
+	//Empty matches every region
+	FString Region;
+	//0 matches every build
+	int32 BuildId{ 0 };
+};
+
+/**
+ * Structure-of-arrays copy of what scoring needs from each search result, one row per summary of the search cache.
+ * Every criterion is one branch free pass over a packed column, which the compiler can vectorize.
+ * Rows are only ever appended during a search, same as the summaries
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsScoringTable
+{
+public:
+	void Reset();
+	void Reserve(int32 NumRows);
+
+	void AddRow(int32 ResultIndex, int32 PingInMs, int16 OpenSlots, int16 MaxSlots, uint16 MatchTypeId, int32 SkillBracket, uint16 RegionId, int32 BuildId);
+	void SetStale(int32 Row);
+
+	//Region ids stay valid across searches, 0 means no region
+	uint16 InternRegion(const FString& Region);
+	uint16 FindRegionId(const FString& Region) const;
+
+	//Scores every row and returns the best NumResults, best first. Stale, full and left out rows are never returned
+	void Score(const FMultiplayerScoringWeights& Weights, const FMultiplayerScoringQuery& Query, uint16 MatchTypeId, int32 NumResults, TArray<FMultiplayerRankedSession>& OutRankedSessions);
+
+	int32 Num() const { return ResultIndices.Num(); }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	TArray<int32> ResultIndices;
+	TArray<float> PingsMs;
+	TArray<float> FillRatios;
+	TArray<int32> SkillBrackets;
+	TArray<int32> BuildIds;
+	TArray<int16> OpenSlots;
+	TArray<uint16> MatchTypeIds;
+	TArray<uint16> RegionIds;
+	TArray<uint8> StaleFlags;
+
+	//Scratch column, kept to not allocate on every scoring pass
+	TArray<float> Scores;
+
+	TMap<FString, uint16> RegionIdsByName;
+};
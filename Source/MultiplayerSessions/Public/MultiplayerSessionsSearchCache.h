@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiplayerSessionsScoring.h"
+
+class FOnlineSessionSearchResult;
+
+/**
+ * Compact, copy-free view of a single search result.
+ * Everything the menu needs to pick a session without touching the heavy search result and its settings map
+ */
+struct FMultiplayerSessionSummary
+{
+	//Hash of the session id string, the full id is one GetSearchResult(ResultIndex) away
+	uint32 SessionIdHash{ 0 };
+	int32 ResultIndex{ INDEX_NONE };
+	int32 PingInMs{ 0 };
+	int16 OpenSlots{ 0 };
+	int16 MaxSlots{ 0 };
+	//Interned through FMultiplayerSessionsSearchCache, 0 means no match type was advertised
+	uint16 MatchTypeId{ 0 };
+	//Set once a join to this session failed, the host is full or gone, or the entry outlived its time to live
+	bool bIsStale{ false };
+	//The full search result was given up to stay within the memory budget, only this summary is left
+	bool bIsTrimmed{ false };
+	//FPlatformTime::Seconds() when the backend last reported this session
+	double SeenTime{ 0.0 };
+};
+
+/**
+ * Lookup tables over the results of the last session search.
+ * Stores indices into the search results array, so it has to be reset together with the search.
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsSearchCache
+{
+public:
+	//What indexing needs from a search result, pulled out without touching the cache so it can be done on any thread
+	struct FParsedResult
+	{
+		FString SessionId;
+		FString MatchType;
+		FString Region;
+		uint32 SessionIdHash{ 0 };
+		int32 PingInMs{ 0 };
+		int16 OpenSlots{ 0 };
+		int16 MaxSlots{ 0 };
+		int32 SkillBracket{ 0 };
+		int32 BuildId{ 0 };
+	};
+
+	FMultiplayerSessionsSearchCache();
+
+	void Reset();
+
+	//Indexes every result that was not indexed yet. Results are only ever appended during a search,
+	//so streamed batches and the final result array can be fed through here incrementally
+	void IndexResults(const TArray<FOnlineSessionSearchResult>& SearchResults);
+	//Same, but stops once FPlatformTime::Seconds() passes EndTime. Returns true when everything is indexed
+	bool IndexResults(const TArray<FOnlineSessionSearchResult>& SearchResults, double EndTime);
+	//Indexes results parsed ahead of time, ParsedResults[0] being the result at FirstResultIndex.
+	//Strings are moved out of the parsed results. Returns true when all of them are indexed
+	bool IndexParsedResults(TArrayView<FParsedResult> ParsedResults, int32 FirstResultIndex, double EndTime);
+
+	//Thread safe
+	static FParsedResult ParseResult(const FOnlineSessionSearchResult& SearchResult);
+
+	//INDEX_NONE if there is no result with that id
+	int32 FindById(const FString& SessionId) const;
+	TConstArrayView<int32> FindByMatchType(const FString& MatchType) const;
+	TConstArrayView<FMultiplayerSessionSummary> GetSummaries() const { return Summaries; }
+	const FMultiplayerSessionSummary* FindSummary(int32 ResultIndex) const;
+
+	void MarkStale(int32 ResultIndex);
+	bool IsStale(int32 ResultIndex) const;
+	//Marks everything reported before Time stale, returns how many entries expired
+	int32 ExpireSeenBefore(double Time);
+	//The full result is gone, it can only be joined by looking the session up again
+	void MarkTrimmed(int32 ResultIndex);
+	bool IsTrimmed(int32 ResultIndex) const;
+	//Seconds since the backend reported the result, negative if it is not indexed
+	double GetAge(int32 ResultIndex) const;
+
+	//Match type ids stay valid across searches
+	uint16 InternMatchType(const FString& MatchType);
+	uint16 FindMatchTypeId(const FString& MatchType) const;
+	const FString& GetMatchTypeName(uint16 MatchTypeId) const;
+
+	//One row per summary, in the same order
+	FMultiplayerSessionsScoringTable& GetScoringTable() { return ScoringTable; }
+
+	int32 GetNumIndexed() const { return NumIndexed; }
+	//Heap memory of the lookup tables, summaries and scoring columns
+	SIZE_T GetAllocatedSize() const;
+	//Reset keeps every allocation, the next search is indexed into the same memory.
+	//Changes with every Reset, tells views built on the summaries that they are looking at a different search
+	uint32 GetGeneration() const { return Generation; }
+
+private:
+	TMap<FString, int32> SessionIdToResult;
+	//Indexed by match type id
+	TArray<TArray<int32>> MatchTypeToResults;
+	TArray<FMultiplayerSessionSummary> Summaries;
+	//Summary index per result index, INDEX_NONE for duplicates
+	TArray<int32> ResultToSummary;
+	int32 NumIndexed{ 0 };
+	uint32 Generation{ 0 };
+	//How many results are indexed between two looks at the clock when indexing on a budget
+	static constexpr int32 TimeCheckInterval{ 32 };
+
+	TMap<FString, uint16> MatchTypeIds;
+	TArray<FString> MatchTypeNames;
+
+	FMultiplayerSessionsScoringTable ScoringTable;
+
+	void ReserveFor(int32 NumResults);
+	void AddParsedResult(int32 ResultIndex, FParsedResult&& ParsedResult, double SeenTime);
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Picks how many results an adaptive search asks the backend for.
+ * Remembers per match type which share of the results recent searches could actually use, smoothed so a single odd search
+ * does not swing it, and asks for just enough results to hold the wanted number of usable ones
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsSearchSizer
+{
+public:
+	//Size of the first search for NumWanted usable results, never more than MaxResults
+	int32 GetInitialSize(const FString& MatchType, int32 NumWanted, int32 MaxResults) const;
+	//Size of the next search after one of CurrentSize came back full but with too few usable results
+	int32 GetWidenedSize(int32 CurrentSize, int32 NumWanted, int32 NumReturned, int32 NumQualified, int32 MaxResults) const;
+
+	//A search returned NumReturned results, NumQualified of them usable
+	void RecordSearch(const FString& MatchType, int32 NumReturned, int32 NumQualified);
+
+	//Share of usable results, the default guess if no search of that match type finished yet
+	float GetHitRate(const FString& MatchType) const;
+
+private:
+	TMap<FString, float> HitRates;
+
+	//Guess for match types nobody searched for yet
+	static constexpr float DefaultHitRate{ 0.25f };
+	//Lower rates are treated as this, so a run of empty searches does not ask for everything at once
+	static constexpr float MinHitRate{ 0.02f };
+	//Weight of the newest search in the moving average
+	static constexpr float Smoothing{ 0.3f };
+	//Asks for this much more than the hit rate suggests, hosts fill up between searches
+	static constexpr float Headroom{ 1.5f };
+	static constexpr int32 MinSearchSize{ 16 };
+
+	int32 GetSizeFor(float HitRate, int32 NumWanted, int32 MaxResults) const;
+};
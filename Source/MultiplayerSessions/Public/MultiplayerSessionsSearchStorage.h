@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOnlineSessionSearch;
+class FOnlineSessionSearchResult;
+class FMultiplayerSessionsSearchCache;
+
+/**
+ * Owns the memory of retained search results.
+ * Hands out search objects whose result array still holds the allocation of an earlier search, and trims the full results
+ * of a finished search down to a memory budget. Trimmed results stay in place as empty entries so result indices keep
+ * pointing at the same sessions, their compact summaries in the search cache are kept
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsSearchStorage
+{
+public:
+	//A search object to run a new search into, reusing the storage of one given back through Recycle if there is any
+	TSharedRef<FOnlineSessionSearch> Acquire();
+	//Takes the search back once nobody else holds it. Its results are destroyed, the array allocation is kept for the next
+	//search unless it alone is over BudgetBytes
+	void Recycle(TSharedPtr<FOnlineSessionSearch>&& Search, SIZE_T BudgetBytes);
+
+	//Estimated heap memory of all results of the search and their array, from a sample of the results
+	SIZE_T EstimateFootprint(const FOnlineSessionSearch& Search) const;
+	//How many full results fit into BudgetBytes next to the result array itself, at least one
+	int32 GetNumResultsWithin(const FOnlineSessionSearch& Search, SIZE_T BudgetBytes) const;
+	//Empties every result not flagged in KeptResults, returns the indices of the results it emptied
+	TArray<int32> Trim(FOnlineSessionSearch& Search, const TBitArray<>& KeptResults);
+
+	//Publishes the footprint of the retained results and of the search cache to STATGROUP_MultiplayerSessions
+	void UpdateStats(const FOnlineSessionSearch* Search, const FMultiplayerSessionsSearchCache& SearchCache);
+	SIZE_T GetRetainedSize() const { return RetainedSize; }
+
+private:
+	TSharedPtr<FOnlineSessionSearch> SpareSearch;
+	SIZE_T RetainedSize{ 0 };
+	//Results looked at to estimate the size of a whole search, measuring every one of them would cost more than it saves
+	static constexpr int32 NumSampledResults{ 64 };
+
+	static SIZE_T GetResultHeapSize(const FOnlineSessionSearchResult& SearchResult);
+	SIZE_T GetAverageResultHeapSize(const FOnlineSessionSearch& Search) const;
+};
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "MultiplayerSessionsSettings.generated.h"
+
+class UMultiplayerSessionsScoringProfile;
+
+UENUM()
+enum class EMultiplayerSessionsBackendType : uint8
+{
+	//The engine's default online subsystem (DefaultPlatformService)
+	Default,
+	Steam,
+	//LAN sessions through the NULL online subsystem
+	Null,
+	//In-process sessions without any network, for tests and benchmarks
+	Fake,
+	//LAN sessions through the plugin's own UDP discovery, faster than the NULL subsystem's
+	Lan
+};
+
+USTRUCT()
+struct FMultiplayerSessionPreset
+{
+	GENERATED_BODY()
+
+	//What the game passes to CreateSession/UpdateSession
+	UPROPERTY(EditAnywhere, Category = "Session")
+	FName Name;
+
+	UPROPERTY(EditAnywhere, Category = "Session", meta = (ClampMin = 1))
+	int32 PublicConnections{ 4 };
+
+	UPROPERTY(EditAnywhere, Category = "Session")
+	FString MatchType;
+
+	UPROPERTY(EditAnywhere, Category = "Session")
+	FString MatchName;
+
+	UPROPERTY(EditAnywhere, Category = "Session")
+	bool bAllowJoinInProgress{ true };
+
+	//Advertised for matchmaking, 0 and empty advertise nothing
+	UPROPERTY(EditAnywhere, Category = "Matchmaking")
+	int32 SkillBracket{ 0 };
+
+	UPROPERTY(EditAnywhere, Category = "Matchmaking")
+	FString Region;
+};
+
+/**
+ * Project settings of the plugin, Project Settings -> Plugins -> Multiplayer Sessions
+ */
+UCLASS(config = Game, defaultconfig, meta = (DisplayName = "Multiplayer Sessions"))
+class MULTIPLAYERSESSIONS_API UMultiplayerSessionsSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UMultiplayerSessionsSettings();
+
+	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
+
+	//The configured backend, -MultiplayerSessionsBackend=Steam|Null|Lan|Fake|Default on the command line overrides it
+	EMultiplayerSessionsBackendType GetBackendType() const;
+
+	//Where sessions are hosted and searched. Created the first time a game instance needs it
+	UPROPERTY(config, EditAnywhere, Category = "Backend")
+	EMultiplayerSessionsBackendType Backend{ EMultiplayerSessionsBackendType::Default };
+
+	//Session settings built and validated once when the subsystem starts, invalid presets are skipped with an error
+	UPROPERTY(config, EditAnywhere, Category = "Presets")
+	TArray<FMultiplayerSessionPreset> SessionPresets;
+
+	//Weights FindBestSession and ScoreSessions rank sessions by, built in defaults if not set
+	UPROPERTY(config, EditAnywhere, Category = "Matchmaking")
+	TSoftObjectPtr<UMultiplayerSessionsScoringProfile> ScoringProfile;
+
+	//UDP port a hosted game session answers latency probes on. It is advertised with the session, so FindBestSession
+	//measures the round trip to the host before joining. 0 answers nothing, and so does a host that could not bind the port,
+	//clients then rank that host by the ping its search result reported
+	UPROPERTY(config, EditAnywhere, Category = "Matchmaking", meta = (ClampMin = 0, ClampMax = 65535))
+	int32 LatencyEchoPort{ 7787 };
+
+	//Memory the full results of the last search may keep after it finished, in kilobytes. Over it only the best sessions
+	//keep their full result and the rest are left as compact summaries. 0 keeps everything. Lower it per platform in that platform's Game.ini
+	UPROPERTY(config, EditAnywhere, Category = "Search", meta = (ClampMin = 0))
+	int32 SearchResultsMemoryBudgetKB{ 0 };
+
+	//First UDP port LAN hosts answer discovery on. Each host takes the first free one of the next LanDiscoveryPortCount ports,
+	//searches ask all of them at once, so several hosts can run on one machine
+	UPROPERTY(config, EditAnywhere, Category = "LAN", meta = (ClampMin = 1, ClampMax = 65535))
+	int32 LanDiscoveryPort{ 14011 };
+
+	UPROPERTY(config, EditAnywhere, Category = "LAN", meta = (ClampMin = 1, ClampMax = 64))
+	int32 LanDiscoveryPortCount{ 4 };
+
+	//Seconds between discovery queries while a search runs
+	UPROPERTY(config, EditAnywhere, Category = "LAN", meta = (ClampMin = 0.01))
+	float LanBroadcastInterval{ 0.1f };
+
+	//A LAN search lists whoever answered within this many seconds
+	UPROPERTY(config, EditAnywhere, Category = "LAN", meta = (ClampMin = 0.05))
+	float LanResponseTimeout{ 0.5f };
+
+	//A LAN search ends as soon as this many matching hosts answered, 0 always waits out the response timeout
+	UPROPERTY(config, EditAnywhere, Category = "LAN", meta = (ClampMin = 0))
+	int32 LanRespondersToComplete{ 0 };
+
+	//While listening, hosts that did not answer for this many seconds are dropped from the list
+	UPROPERTY(config, EditAnywhere, Category = "LAN", meta = (ClampMin = 0.5))
+	float LanHostTimeout{ 3.f };
+
+	//How often a dedicated server sends its player count and changed attributes to the backend, in seconds.
+	//Everything that changed in between goes out as one update
+	UPROPERTY(config, EditAnywhere, Category = "Dedicated Server", meta = (ClampMin = 1))
+	float HeartbeatInterval{ 15.f };
+
+	//Logins the host handles at once, more are turned away to try again instead of all waiting on the same few slots
+	UPROPERTY(config, EditAnywhere, Category = "Admission", meta = (ClampMin = 1))
+	int32 MaxConcurrentHandshakes{ 8 };
+
+	//A reserved slot, or a login that never finished, is given back after this many seconds
+	UPROPERTY(config, EditAnywhere, Category = "Admission", meta = (ClampMin = 1))
+	float ReservationTimeout{ 30.f };
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "MultiplayerSessionsOperationQueue.h"
+
+DECLARE_STATS_GROUP(TEXT("MultiplayerSessions"), STATGROUP_MultiplayerSessions, STATCAT_Advanced);
+
+/**
+ * Request to completion timings of session operations.
+ * Keeps a rolling window of recent samples per operation, publishes percentiles to STATGROUP_MultiplayerSessions
+ * and emits every finished operation on the MultiplayerSessions trace channel
+ */
+class MULTIPLAYERSESSIONS_API FMultiplayerSessionsLatencyTracker
+{
+public:
+	struct FOperationStats
+	{
+		int32 NumSucceeded{ 0 };
+		int32 NumFailed{ 0 };
+		float P50Ms{ 0.f };
+		float P95Ms{ 0.f };
+		float P99Ms{ 0.f };
+		float MaxMs{ 0.f };
+		TMap<FString, int32> FailureReasons;
+	};
+
+	FMultiplayerSessionsLatencyTracker();
+
+	//Does nothing if that operation is already being timed, repeated requests are measured from the first one
+	void Begin(EMultiplayerSessionOperation Type);
+	//Does nothing if that operation was not being timed
+	void End(EMultiplayerSessionOperation Type, bool bWasSuccessfull, const TCHAR* FailureReason = nullptr);
+	//Stops timing without taking a sample, for requests that were dropped before they ran
+	void Discard(EMultiplayerSessionOperation Type);
+	bool IsTiming(EMultiplayerSessionOperation Type) const;
+
+	FOperationStats GetStats(EMultiplayerSessionOperation Type) const;
+	FString ToCsv() const;
+	void Reset();
+
+	static const TCHAR* GetOperationName(EMultiplayerSessionOperation Type);
+
+private:
+	struct FOperationSamples
+	{
+		//Ring buffer of the most recent durations
+		TArray<float> DurationsMs;
+		int32 NextSample{ 0 };
+		int32 NumSucceeded{ 0 };
+		int32 NumFailed{ 0 };
+		TMap<FString, int32> FailureReasons;
+		uint64 StartCycles{ 0 };
+	};
+
+	static constexpr int32 MaxSamples{ 512 };
+	static constexpr int32 NumOperations{ static_cast<int32>(EMultiplayerSessionOperation::Num) };
+
+	FOperationSamples Operations[NumOperations];
+
+	void PublishStats(EMultiplayerSessionOperation Type) const;
+};
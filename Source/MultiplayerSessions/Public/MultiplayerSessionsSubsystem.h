@@ -5,6 +5,19 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "GameFramework/OnlineReplStructs.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
+#include "Async/Future.h"
+#include "MultiplayerSessionsSearchCache.h"
+#include "MultiplayerSessionsSearchStorage.h"
+#include "MultiplayerSessionsSearchSizer.h"
+#include "MultiplayerSessionsLatencyProber.h"
+#include "MultiplayerSessionsOperationQueue.h"
+#include "MultiplayerSessionsStats.h"
+#include "MultiplayerSessionsBackend.h"
+#include "MultiplayerSessionsLanBackend.h"
+#include "MultiplayerSessionsAdmission.h"
 
 #include "MultiplayerSessionsSubsystem.generated.h"
 
@@ -14,15 +27,202 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnCreateSessionComplete, bool, bWasSuccessfull);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsComplete, const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWassSuccessfull);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsBatch, TArrayView<const FOnlineSessionSearchResult> SearchResults, int32 FirstResultIndex);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindBestSessionComplete, const TArray<struct FMultiplayerRankedSession>& RankedSessions, bool bWasSuccessfull);
 DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnJoinSessionComplete, EOnJoinSessionCompleteResult::Type Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnDestroySessionComplete, bool, bWasSuccessfull);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnStartSessionComplete, bool, bWasSuccessfull);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnUpdateSessionComplete, bool, bWasSuccessfull);
+DECLARE_MULTICAST_DELEGATE(FMultiplayerOnSearchCacheRefreshed);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnSearchResultsProgress, int32 NumProcessed, int32 NumResults);
+DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnReconnectComplete, bool bWasSuccessfull);
+DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnFollowPartyLeaderComplete, bool bWasSuccessfull);
 
 struct FMultiplayerMatchSettings
 {
 	int32 PublicConnections{ 0 };
 	FString MatchType;
 	FString MatchName;
+	bool bAllowJoinInProgress{ true };
+	//Advertised for matchmaking, 0 and empty advertise nothing
+	int32 SkillBracket{ 0 };
+	FString Region;
+};
+
+struct FMultiplayerSearchSettings
+{
+	int32 MaxSearchResults{ 10000 };
+	//Adaptive sizing, 0 asks for MaxSearchResults right away. Otherwise the search starts with as many results as recent
+	//searches suggest will hold this many open sessions of MatchType, stops as soon as that many are in, and starts over
+	//wider (up to MaxSearchResults) while too few qualify. Starting over resets the result indices
+	int32 NumWantedResults{ 0 };
+	//Results are streamed through MultiplayerOnFindSessionsBatch in batches of this size, 0 to only get the final list
+	int32 BatchSize{ 0 };
+
+	//Filters passed to the backend query, leave empty/zero to not filter
+	FString MatchType;
+	int32 MinOpenSlots{ 0 };
+	int32 BuildId{ 0 };
+	//Dedicated servers are listed apart from player hosted lobbies on most backends
+	bool bDedicatedServers{ false };
+
+	//Results of an earlier search with the same filters that finished less than this many seconds ago are
+	//handed out right away instead of searching again. 0 always searches
+	float MaxCacheAge{ 0.f };
+
+	//Milliseconds per frame spent indexing the final results, spread over as many frames as it takes with
+	//MultiplayerOnSearchResultsProgress after each one. 0 indexes everything in the frame the search completes
+	float ProcessingBudgetMs{ 0.f };
+	//Parse the results on a worker task first, the game thread then only inserts them into the lookup tables.
+	//Only used with a ProcessingBudgetMs
+	bool bParseOnWorkerThreads{ false };
+
+	bool HasSameFilters(const FMultiplayerSearchSettings& Other) const
+	{
+		return MatchType == Other.MatchType && MinOpenSlots == Other.MinOpenSlots && BuildId == Other.BuildId && bDedicatedServers == Other.bDedicatedServers;
+	}
+};
+
+struct FMultiplayerRankedSession
+{
+	int32 ResultIndex{ INDEX_NONE };
+	int32 RttInMs{ 0 };
+	int16 OpenSlots{ 0 };
+	//Lower is better
+	float Score{ 0.f };
+};
+
+///
+/// Results of the async API, every future is fulfilled on the game thread right where the matching delegate is broadcasted
+///
+
+struct FMultiplayerSessionResult
+{
+	FName SessionName;
+	bool bWasSuccessfull{ false };
+	//Dropped before it completed, through CancelOperation or because a newer request replaced it
+	bool bWasCancelled{ false };
+};
+
+struct FMultiplayerFindSessionsResult
+{
+	//Holding on to it keeps the results alive, result indices match GetSearchResult as long as no newer search replaced it
+	TSharedPtr<const FOnlineSessionSearch> Search;
+	bool bWasSuccessfull{ false };
+	bool bWasCancelled{ false };
+};
+
+struct FMultiplayerJoinSessionResult
+{
+	FName SessionName;
+	EOnJoinSessionCompleteResult::Type Result{ EOnJoinSessionCompleteResult::UnknownError };
+	//What to ClientTravel to, empty unless the join succeeded
+	FString SessionAddress;
+	bool bWasCancelled{ false };
+
+	bool WasSuccessfull() const { return Result == EOnJoinSessionCompleteResult::Success || Result == EOnJoinSessionCompleteResult::AlreadyInSession; }
+};
+
+struct FMultiplayerFindBestSessionResult
+{
+	//Best first
+	TArray<FMultiplayerRankedSession> RankedSessions;
+	bool bWasSuccessfull{ false };
+};
+
+//What the subsystem keeps per named session it created or joined
+struct FMultiplayerNamedSessionState
+{
+	//What CreateSession was last asked to host with
+	TSharedPtr<const FOnlineSessionSettings> LastSessionSettings;
+	//An old session of the same name is being destroyed to make room for the new one
+	bool bCreateSessionOnDestroy{ false };
+};
+
+enum class EMultiplayerReconnectStage : uint8
+{
+	None,
+	//Asked for before the save slot finished loading, picks up once it has
+	Loading,
+	//ClientTravel straight to the address we had last time
+	Direct,
+	//The host moved or did not answer, searching for the same session again
+	Search
+};
+
+/**
+ * Promises of the async API waiting for one operation type, keyed by the handle of the request they belong to
+ */
+template<typename ResultType>
+class TMultiplayerPendingResults
+{
+public:
+	TFuture<ResultType> Add(FMultiplayerOperationHandle Handle)
+	{
+		//Requests that fail to start report back from inside the request, before anybody could wait for them
+		if (Handle.IsValid() && Handle == UnclaimedHandle)
+		{
+			UnclaimedHandle = FMultiplayerOperationHandle();
+			return MakeFulfilledPromise<ResultType>(MoveTemp(UnclaimedResult)).GetFuture();
+		}
+
+		return Promises.FindOrAdd(Handle).Emplace_GetRef().GetFuture();
+	}
+
+	//The request that reports back next
+	void SetRunning(FMultiplayerOperationHandle Handle) { RunningHandle = Handle; }
+
+	void ResolveRunning(const ResultType& Result)
+	{
+		const FMultiplayerOperationHandle Handle{ RunningHandle };
+		RunningHandle = FMultiplayerOperationHandle();
+
+		if (!Resolve(Handle, Result) && Handle.IsValid())
+		{
+			UnclaimedHandle = Handle;
+			UnclaimedResult = Result;
+		}
+	}
+
+	bool Resolve(FMultiplayerOperationHandle Handle, const ResultType& Result)
+	{
+		TArray<TPromise<ResultType>>* Found{ Promises.Find(Handle) };
+		if(!Found)
+			return false;
+
+		//Continuations may start the next request, which adds to the map
+		TArray<TPromise<ResultType>> Resolved{ MoveTemp(*Found) };
+		Promises.Remove(Handle);
+
+		for (TPromise<ResultType>& Promise : Resolved)
+		{
+			Promise.SetValue(Result);
+		}
+
+		return true;
+	}
+
+	void ResolveAll(const ResultType& Result)
+	{
+		TMap<FMultiplayerOperationHandle, TArray<TPromise<ResultType>>> Resolved{ MoveTemp(Promises) };
+		Promises.Reset();
+		RunningHandle = FMultiplayerOperationHandle();
+		UnclaimedHandle = FMultiplayerOperationHandle();
+
+		for (TPair<FMultiplayerOperationHandle, TArray<TPromise<ResultType>>>& Pair : Resolved)
+		{
+			for (TPromise<ResultType>& Promise : Pair.Value)
+			{
+				Promise.SetValue(Result);
+			}
+		}
+	}
+
+private:
+	TMap<FMultiplayerOperationHandle, TArray<TPromise<ResultType>>> Promises;
+	FMultiplayerOperationHandle RunningHandle;
+	FMultiplayerOperationHandle UnclaimedHandle;
+	ResultType UnclaimedResult;
 };
 
 /**
@@ -36,18 +236,140 @@ class MULTIPLAYERSESSIONS_API UMultiplayerSessionsSubsystem : public UGameInstan
 public:
 	UMultiplayerSessionsSubsystem();
 
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
 	//To handle session functionality the game will cal these
-	void CreateSession(int32 NumPublicConnections, FString MatchType);
-	void CreateSession(const FMultiplayerMatchSettings& InMatchSettings);
-	void FindSessions(int32 MaxSearchResults);
-	void JoinSession(const FOnlineSessionSearchResult& FindSessionsResult);
-	void JoinSession(const FString& InSessionId);
-	void DestroySession();
-	void StartSession();
+	//Operations run one at a time in request order, repeated requests of the same type for the same session waiting in
+	//line are merged into one. The returned handle can be used to cancel the request while it waits.
+	//Several named sessions can be kept at once, e.g. NAME_PartySession next to NAME_GameSession, everything defaults to the game session
+	FMultiplayerOperationHandle CreateSession(int32 NumPublicConnections, FString MatchType);
+	FMultiplayerOperationHandle CreateSession(const FMultiplayerMatchSettings& InMatchSettings, FName SessionName = NAME_GameSession);
+	//Hosts with one of the presets from the project settings, an unknown preset returns an invalid handle
+	FMultiplayerOperationHandle CreateSession(FName PresetName, FName SessionName = NAME_GameSession);
+	//Changes the session we are hosting without tearing it down. Only the attributes that differ from the live
+	//session are touched, if nothing differs the backend is not called at all
+	FMultiplayerOperationHandle UpdateSession(FName PresetName, FName SessionName = NAME_GameSession);
+	FMultiplayerOperationHandle UpdateSession(const FMultiplayerMatchSettings& InMatchSettings, FName SessionName = NAME_GameSession);
+	//With BatchSize > 0 results are streamed through MultiplayerOnFindSessionsBatch as the backend delivers them,
+	//MultiplayerOnFindSessionComplete is still broadcasted once the search is over.
+	//A new search replaces the running one. Answered from the cache when it is fresh enough (see MaxCacheAge),
+	//MultiplayerOnFindSessionComplete is then broadcasted right away and the returned handle is invalid
+	FMultiplayerOperationHandle FindSessions(int32 MaxSearchResults, int32 BatchSize = 0);
+	FMultiplayerOperationHandle FindSessions(const FMultiplayerSearchSettings& InSearchSettings);
+	void CancelFindSessions();
+	//Keeps the search cache warm while nothing else is going on, e.g. while a server browser is open.
+	//Refresh searches are silent, they swap in their results on completion and broadcast MultiplayerOnSearchCacheRefreshed.
+	//Any other session request cancels a running refresh so it never delays the player
+	void StartBackgroundRefresh(const FMultiplayerSearchSettings& InSearchSettings, float IntervalSeconds = 15.f);
+	void StopBackgroundRefresh();
+	bool IsBackgroundRefreshRunning() const { return RefreshTicker_Handle.IsValid(); }
+	bool IsSearchCacheFresh(const FMultiplayerSearchSettings& InSearchSettings, float MaxAge) const;
+	//Probes the NumCandidates best scored sessions of the last search concurrently and ranks them again
+	//with the measured latency in place of the reported ping. Hosts that advertise no echo port keep their reported ping
+	void FindBestSession(const FString& InMatchType, int32 NumCandidates = 8);
+	FMultiplayerOperationHandle JoinSession(const FOnlineSessionSearchResult& FindSessionsResult, FName SessionName = NAME_GameSession);
+	FMultiplayerOperationHandle JoinSession(const FString& InSessionId, FName SessionName = NAME_GameSession);
+	//Joins the candidates of the last search one after another until one succeeds. Full or vanished candidates
+	//are marked stale in the search cache, MultiplayerOnJoinSessionComplete only reports the final outcome
+	FMultiplayerOperationHandle JoinAnySession(const TArray<FMultiplayerRankedSession>& InRankedSessions, FName SessionName = NAME_GameSession);
+	FMultiplayerOperationHandle JoinAnySession(const TArray<int32>& InCandidateResultIndices, FName SessionName = NAME_GameSession);
+	FMultiplayerOperationHandle DestroySession(FName SessionName = NAME_GameSession);
+	FMultiplayerOperationHandle StartSession(FName SessionName = NAME_GameSession);
+	//Waiting operations can always be cancelled, a running one only if it is a search
+	bool CancelOperation(FMultiplayerOperationHandle Handle);
+
+	//Same requests returning a future instead, the delegates above are broadcasted all the same.
+	//Pass OutHandle to be able to cancel the request, its future then reports bWasCancelled
+	TFuture<FMultiplayerSessionResult> CreateSessionAsync(const FMultiplayerMatchSettings& InMatchSettings, FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	TFuture<FMultiplayerSessionResult> CreateSessionAsync(FName PresetName, FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	TFuture<FMultiplayerSessionResult> UpdateSessionAsync(FName PresetName, FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	TFuture<FMultiplayerFindSessionsResult> FindSessionsAsync(const FMultiplayerSearchSettings& InSearchSettings, FMultiplayerOperationHandle* OutHandle = nullptr);
+	TFuture<FMultiplayerFindBestSessionResult> FindBestSessionAsync(const FString& InMatchType, int32 NumCandidates = 8);
+	TFuture<FMultiplayerJoinSessionResult> JoinSessionAsync(const FString& InSessionId, FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	TFuture<FMultiplayerJoinSessionResult> JoinAnySessionAsync(const TArray<int32>& InCandidateResultIndices, FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	TFuture<FMultiplayerSessionResult> DestroySessionAsync(FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	TFuture<FMultiplayerSessionResult> StartSessionAsync(FMultiplayerOperationHandle* OutHandle = nullptr, FName SessionName = NAME_GameSession);
+	//Joins a session we know the id of without needing it in the last search: asks the backend for that one session,
+	//and if it can't, runs a search filtered by MatchType and picks it out of the results
+	TFuture<FMultiplayerJoinSessionResult> JoinSessionByIdAsync(const FString& InSessionId, const FString& InMatchType, FName SessionName = NAME_GameSession);
+
+	//Party leader: advertises the game session we are in through the party session we host, so members can follow
+	FMultiplayerOperationHandle ShareGameSessionWithParty();
+	//Party member: joins the game session the leader advertised and travels there, one join instead of a search per member.
+	//False if the leader did not advertise one, otherwise MultiplayerOnFollowPartyLeaderComplete reports the outcome
+	bool FollowPartyLeader();
+	//Dedicated servers have no local player to host with, the session is registered as the server itself without presence.
+	//The player count and attributes set with SetDedicatedSessionAttribute are sent with a heartbeat, one update per
+	//interval (project settings) no matter how many players came and went. Deregistered by StopDedicatedHosting or on shutdown
+	FMultiplayerOperationHandle HostDedicatedSession(const FMultiplayerMatchSettings& InMatchSettings);
+	FMultiplayerOperationHandle HostDedicatedSession(FName PresetName);
+	FMultiplayerOperationHandle StopDedicatedHosting();
+	void SetDedicatedSessionAttribute(FName Key, const FString& Value);
+	bool IsHostingDedicated() const { return DedicatedSessionSettings.IsValid(); }
+	//Host: holds a slot for a player known to be on the way, e.g. the party members of someone who just joined.
+	//False if the session is full. Players without a reservation take a free slot when their login arrives, if there is one
+	bool ReserveSlot(const FUniqueNetIdRepl& PlayerId);
+	//Host: slots neither taken nor reserved, what searching players are told
+	int32 GetNumOpenSlots() const { return Admission.GetNumOpenSlots(); }
+	//ClientTravel to the joined session, timed until the map is loaded
+	bool TravelToSession(APlayerController* PlayerController);
+	//Starts loading a map and everything it references in the background, e.g. the lobby while the session is being created.
+	//The packages are held until the next map is loaded so travelling there finds them in memory instead of on disk.
+	//Does nothing in PIE, maps are duplicated under a different name there
+	void PreloadMap(const FString& MapPackageName);
+	void ReleasePreloadedMap();
+	bool IsMapPreloaded(const FString& MapPackageName) const;
+	//Travels straight to the session joined last, only if that fails it searches for the same session and joins it again.
+	//False if there is no recent enough session to go back to, otherwise MultiplayerOnReconnectComplete reports the outcome.
+	//Asked for before the save slot finished loading it waits for the slot and may only fail through MultiplayerOnReconnectComplete
+	bool ReconnectToLastSession(APlayerController* PlayerController);
+	bool HasReconnectRecord() const;
+	//Leaving a session on purpose does this too
+	void ClearReconnectRecord();
+	//Off stops joins and leaves from saving or deleting the record, e.g. while the benchmark runs. ClearReconnectRecord still works
+	void SetReconnectRecordEnabled(bool bInEnabled) { bReconnectRecordEnabled = bInEnabled; }
+	bool IsReconnectRecordEnabled() const { return bReconnectRecordEnabled; }
 
+	//Mirrors the plugin log to the screen, same as "MultiplayerSessions.LogToScreen 1"
 	void SetLogToScreen(bool bInLogToScreen);
+	//Defaults to probing the echo port hosts advertise, hosts without one are ranked by the ping reported by the search
+	void SetLatencyProber(TSharedPtr<IMultiplayerSessionsLatencyProber> InLatencyProber);
+	//Defaults to the backend chosen in the project settings, created on first use. Null goes back to it.
+	//Drops everything in flight on the old backend
+	void SetSessionBackend(TSharedPtr<IMultiplayerSessionsBackend> InSessionBackend);
+	TSharedPtr<IMultiplayerSessionsBackend> GetSessionBackend() const;
+	//Null unless sessions go through the plugin's LAN discovery. Its StartListening keeps a live list of LAN hosts
+	TSharedPtr<FMultiplayerSessionsLanBackend> GetLanBackend() const;
 
-	FString GetSessionAddress();
+	//O(1) lookups into the results of the last search, indexed once as results come in
+	const FOnlineSessionSearchResult* FindSearchResultById(const FString& InSessionId) const;
+	TConstArrayView<int32> FindSearchResultsByMatchType(const FString& InMatchType) const;
+	//Null for results trimmed to stay within the search results memory budget, their summary is still there
+	const FOnlineSessionSearchResult* GetSearchResult(int32 ResultIndex) const;
+	//Estimated memory held by the full results of the last search
+	SIZE_T GetSearchResultsMemory() const { return SearchStorage.GetRetainedSize(); }
+	//Seconds since the backend last reported that result, negative if there is no such result
+	double GetSearchResultAge(int32 ResultIndex) const;
+	//Packed per-session data of the last search, cheap to scan every frame
+	TConstArrayView<FMultiplayerSessionSummary> GetSessionSummaries() const;
+	uint32 GetSessionSummariesGeneration() const { return SearchCache.GetGeneration(); }
+	uint16 FindMatchTypeId(const FString& InMatchType) const;
+	const FString& GetMatchTypeName(uint16 MatchTypeId) const;
+	//Result of the last FindBestSession, best first
+	const TArray<FMultiplayerRankedSession>& GetRankedSessions() const { return RankedSessions; }
+	//Scores every usable result of the last search in one pass and returns the best NumResults, best first.
+	//Uses the profile from the plugin settings unless given one. Cheap enough to run again on every cache refresh
+	TArray<FMultiplayerRankedSession> ScoreSessions(const FMultiplayerScoringQuery& Query, int32 NumResults, const UMultiplayerSessionsScoringProfile* Profile = nullptr);
+	//The player's side of FindBestSession scoring, its match type is replaced by the one FindBestSession is given
+	void SetScoringQuery(const FMultiplayerScoringQuery& InScoringQuery) { ScoringQuery = InScoringQuery; }
+
+	const FMultiplayerSessionsLatencyTracker& GetLatencyTracker() const { return LatencyTracker; }
+	void ResetLatencyTracker() { LatencyTracker.Reset(); }
+
+	FString GetSessionAddress(FName SessionName = NAME_GameSession);
+	//The named session the last Create/Join/Destroy/Start/Update completion was broadcasted for
+	FName GetOperationSessionName() const { return OperationSessionName; }
 	bool GetIsLanMatch() const;
 	bool GetOnlineSubsystemAvailable() const;
 
@@ -56,9 +378,16 @@ public:
 	/// 
 	FMultiplayerOnCreateSessionComplete MultiplayerOnCreateSessionComplete;
 	FMultiplayerOnFindSessionsComplete MultiplayerOnFindSessionComplete;
+	FMultiplayerOnFindSessionsBatch MultiplayerOnFindSessionsBatch;
+	FMultiplayerOnFindBestSessionComplete MultiplayerOnFindBestSessionComplete;
 	FMultiplayerOnJoinSessionComplete MultiplayerOnJoinSessionComplete;
 	FMultiplayerOnDestroySessionComplete MultiplayerOnDestroySessionComplete;
 	FMultiplayerOnStartSessionComplete MultiplayerOnStartSessionComplete;
+	FMultiplayerOnUpdateSessionComplete MultiplayerOnUpdateSessionComplete;
+	FMultiplayerOnSearchCacheRefreshed MultiplayerOnSearchCacheRefreshed;
+	FMultiplayerOnSearchResultsProgress MultiplayerOnSearchResultsProgress;
+	FMultiplayerOnReconnectComplete MultiplayerOnReconnectComplete;
+	FMultiplayerOnFollowPartyLeaderComplete MultiplayerOnFollowPartyLeaderComplete;
 protected:
 
 	//Internal callbacks for the delegates we'll add to the OnlineSubsystemInterface delegate list
@@ -68,15 +397,133 @@ protected:
 	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
 	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessfull);
 	void OnStartSessionComplete(FName SessionName, bool bWasSuccessfull);
+	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessfull);
+
+	//Fulfil the futures of the async API, bound to our own delegates so every place that broadcasts is covered
+	UFUNCTION()
+	void ResolveCreateSession(bool bWasSuccessfull);
+	UFUNCTION()
+	void ResolveDestroySession(bool bWasSuccessfull);
+	UFUNCTION()
+	void ResolveStartSession(bool bWasSuccessfull);
+	UFUNCTION()
+	void ResolveUpdateSession(bool bWasSuccessfull);
+	void ResolveFindSessions(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull);
+	void ResolveFindBestSession(const TArray<FMultiplayerRankedSession>& InRankedSessions, bool bWasSuccessfull);
+	void ResolveJoinSession(EOnJoinSessionCompleteResult::Type Result);
 
 private:
-	IOnlineSessionPtr SessionInterface{ nullptr };
-	TSharedPtr<FOnlineSessionSettings> LastSessionSettings;
+	//Map preloading, referenced here so garbage collection during travel keeps them
+	UPROPERTY()
+	TObjectPtr<UPackage> PreloadedMapPackage;
+	UPROPERTY()
+	TObjectPtr<UWorld> PreloadedWorld;
+	FName PreloadingMapName;
+	double PreloadStartTime{ 0.0 };
+
+	//Last joined session, loaded from its save slot on Initialize and saved on every successful join
+	UPROPERTY()
+	TObjectPtr<class UMultiplayerSessionsReconnectRecord> ReconnectRecord;
+	EMultiplayerReconnectStage ReconnectStage{ EMultiplayerReconnectStage::None };
+	bool bReconnectRecordLoaded{ false };
+	bool bReconnectRecordEnabled{ true };
+	//Who asked to reconnect while the slot was still loading
+	TWeakObjectPtr<APlayerController> ReconnectPlayerController;
+	//Older records are ignored, the host is most likely gone by then
+	float MaxReconnectAge{ 900.f };
+
+	//Created on first use and kept for the lifetime of the game instance, a failed attempt is not retried either
+	mutable TSharedPtr<IMultiplayerSessionsBackend> SessionBackend;
+	mutable bool bSessionBackendResolved{ false };
+	TMap<FName, FMultiplayerNamedSessionState> SessionStates;
+	//The named session the running operation acts on. Operations run one at a time, so one is enough
+	FName OperationSessionName{ NAME_GameSession };
+	//Built from UMultiplayerSessionsSettings on Initialize, never changed afterwards so requests can share them
+	TMap<FName, TSharedRef<const FOnlineSessionSettings>> SessionPresets;
 	TSharedPtr<FOnlineSessionSearch> LastSessionSearch;
-	bool bCreateSessionOnDestroy{ false };
-	bool bLogToScreen{ false };
-	int32 LastNumPublicConnections;
-	FString LastMatchType;
+	FMultiplayerSessionsSearchCache SearchCache;
+	FMultiplayerSessionsSearchStorage SearchStorage;
+
+	FMultiplayerSessionsOperationQueue OperationQueue;
+	FMultiplayerSessionsLatencyTracker LatencyTracker;
+	FDelegateHandle PostLoadMapDelegate_Handle;
+	FDelegateHandle TravelFailureDelegate_Handle;
+	FDelegateHandle NetworkFailureDelegate_Handle;
+	float CreateSessionTimeout{ 20.f };
+	float FindSessionsTimeout{ 30.f };
+	float JoinSessionTimeout{ 30.f };
+	float DestroySessionTimeout{ 10.f };
+	float StartSessionTimeout{ 10.f };
+	float UpdateSessionTimeout{ 10.f };
+
+	//Adaptive search state, the round size is what the backend is asked for right now
+	FMultiplayerSessionsSearchSizer SearchSizer;
+	bool bIsAdaptiveSearch{ false };
+	int32 AdaptiveSearchSize{ 0 };
+	//Results of the running round checked against the filters so far, and how many of them qualified
+	int32 NumCheckedResults{ 0 };
+	int32 NumQualifiedResults{ 0 };
+
+	//Streaming search state. The backend appends to LastSessionSearch->SearchResults while the search is running,
+	//we poll it and hand out everything that arrived since the last batch
+	FTSTicker::FDelegateHandle SearchStreamTicker_Handle;
+	int32 SearchStreamBatchSize{ 0 };
+	int32 NumStreamedResults{ 0 };
+	float SearchStreamInterval{ 0.05f };
+
+	//Search cache freshness and background refresh
+	FMultiplayerSearchSettings LastSearchSettings;
+	//0 while the last search is still running or did not finish successfully
+	double LastSearchCompletedTime{ 0.0 };
+	//Results older than this are marked stale and never served from the cache
+	float SearchResultTimeToLive{ 60.f };
+	FTSTicker::FDelegateHandle RefreshTicker_Handle;
+	FMultiplayerSearchSettings RefreshSearchSettings;
+	//Refresh searches run into their own search object so the cached results stay usable until they are replaced
+	TSharedPtr<FOnlineSessionSearch> RefreshSessionSearch;
+	bool bIsRefreshSearch{ false };
+	float RefreshInterval{ 15.f };
+	float RefreshTickInterval{ 0.5f };
+	double NextRefreshTime{ 0.0 };
+
+	//Budgeted indexing of a completed search, MultiplayerOnFindSessionComplete (or MultiplayerOnSearchCacheRefreshed)
+	//waits until it is done
+	TSharedPtr<FOnlineSessionSearch> ProcessedSearch;
+	FTSTicker::FDelegateHandle ResultsProcessingTicker_Handle;
+	UE::Tasks::TTask<TArray<FMultiplayerSessionsSearchCache::FParsedResult>> ParseResultsTask;
+	int32 FirstParsedResultIndex{ 0 };
+	float ResultsProcessingBudgetMs{ 0.f };
+	bool bIsProcessingRefresh{ false };
+	bool bProcessedSearchSucceeded{ false };
+
+	//Latency probing of search candidates
+	TSharedPtr<IMultiplayerSessionsLatencyProber> LatencyProber;
+	//Scored with the reported ping, the measured one replaces it once the probe is back
+	TArray<FMultiplayerRankedSession> ProbeCandidates;
+	TArray<FMultiplayerRankedSession> RankedSessions;
+	float LatencyProbeTimeout{ 1.f };
+
+	//Matchmaking
+	UPROPERTY()
+	TObjectPtr<UMultiplayerSessionsScoringProfile> DefaultScoringProfile;
+	bool bDefaultScoringProfileLoaded{ false };
+	FMultiplayerScoringQuery ScoringQuery;
+	const FMultiplayerScoringWeights& GetScoringWeights(const UMultiplayerSessionsScoringProfile* Profile);
+
+	//Join fallback, result indices of the last search in the order they should be tried
+	TArray<int32> JoinCandidates;
+	int32 NextJoinCandidate{ 0 };
+	int32 ActiveJoinResultIndex{ INDEX_NONE };
+
+	//Async API
+	TMultiplayerPendingResults<FMultiplayerSessionResult> PendingCreateResults;
+	TMultiplayerPendingResults<FMultiplayerSessionResult> PendingDestroyResults;
+	TMultiplayerPendingResults<FMultiplayerSessionResult> PendingStartResults;
+	TMultiplayerPendingResults<FMultiplayerSessionResult> PendingUpdateResults;
+	TMultiplayerPendingResults<FMultiplayerFindSessionsResult> PendingFindResults;
+	TMultiplayerPendingResults<FMultiplayerJoinSessionResult> PendingJoinResults;
+	//Latency probing is not queued, a new probe replaces the running one
+	TArray<TPromise<FMultiplayerFindBestSessionResult>> PendingFindBestResults;
 
 	//To add to the OnlineSessionInterface delegate list
 	//We'll bind out MultiplayerSessionSybsystem internal callbacks to these
@@ -86,16 +533,139 @@ private:
 	FOnJoinSessionCompleteDelegate JoinSessionCompleteDelegate;
 	FOnDestroySessionCompleteDelegate DestroySessionCompleteDelegate;
 	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
+	FOnUpdateSessionCompleteDelegate UpdateSessionCompleteDelegate;
+	FOnFindSessionByIdCompleteDelegate FindSessionByIdCompleteDelegate;
 
 	FDelegateHandle CreateSessionCompleteDelegate_Handle;
 	FDelegateHandle FindSessionsCompleteDelegate_Handle;
 	FDelegateHandle JoinSessionCompleteDelegate_Handle;
 	FDelegateHandle DestroySessionCompleteDelegate_Handle;
 	FDelegateHandle StartSessionCompleteDelegate_Handle;
+	FDelegateHandle UpdateSessionCompleteDelegate_Handle;
+	FDelegateHandle FindSessionByIdCompleteDelegate_Handle;
+
+	//What the dedicated session should advertise, the heartbeat sends it when it changed
+	TSharedPtr<FOnlineSessionSettings> DedicatedSessionSettings;
+	bool bDedicatedSessionDirty{ false };
+	FTSTicker::FDelegateHandle DedicatedHeartbeatTicker_Handle;
+
+	//Admission control of the hosted game session, active from its creation until it is destroyed
+	FMultiplayerSessionsAdmission Admission;
+	//Open slots the game session advertises, sent again when admission changed it
+	int32 AdvertisedOpenSlots{ INDEX_NONE };
+	FTSTicker::FDelegateHandle AdmissionTicker_Handle;
+	float AdmissionTickInterval{ 1.f };
+	FDelegateHandle GameModePreLoginDelegate_Handle;
+	FDelegateHandle GameModePostLoginDelegate_Handle;
+	FDelegateHandle GameModeLogoutDelegate_Handle;
+	//Answers latency probes of searching players while we host the game session
+	TUniquePtr<FMultiplayerSessionsUdpEchoServer> LatencyEchoServer;
+
+	//Single session lookup of JoinSessionByIdAsync, not queued since it does not touch any session or search state
+	TSharedPtr<TPromise<TOptional<FOnlineSessionSearchResult>>> FindSessionByIdPromise;
+
+	//Run by the operation queue, return false if the operation finished right away
+	bool ExecuteCreateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName);
+	bool ExecuteFindSessions(const FMultiplayerSearchSettings& InSearchSettings);
+	bool ExecuteRefreshSearch(const FMultiplayerSearchSettings& InSearchSettings);
+	bool ExecuteJoinSession(const FOnlineSessionSearchResult& FindSessionsResult, FName SessionName);
+	bool ExecuteJoinAnySession(const TArray<int32>& InCandidateResultIndices, TSharedPtr<FOnlineSessionSearch> InSearch, FName SessionName);
+	bool ExecuteDestroySession(FName SessionName);
+	bool ExecuteStartSession(FName SessionName);
+	bool ExecuteUpdateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName);
+
+	void AbortCreateSession(EMultiplayerOperationAbortReason Reason);
+	void AbortFindSessions(EMultiplayerOperationAbortReason Reason);
+	void AbortJoinSession(EMultiplayerOperationAbortReason Reason);
+	void AbortDestroySession(EMultiplayerOperationAbortReason Reason);
+	void AbortStartSession(EMultiplayerOperationAbortReason Reason);
+	void AbortUpdateSession(EMultiplayerOperationAbortReason Reason);
+
+	void BuildSessionPresets();
+	TSharedRef<FOnlineSessionSettings> MakeSessionSettings(const FMultiplayerMatchSettings& InMatchSettings) const;
+	FMultiplayerOperationHandle StartDedicatedHosting(const FOnlineSessionSettings& InSessionSettings);
+	bool TickDedicatedHeartbeat(float DeltaTime);
+	void StopDedicatedHeartbeat();
+	void StartAdmission();
+	void StopAdmission();
+	//Expires reservations and advertises the open slots when they changed, at most once per tick
+	bool TickAdmission(float DeltaTime);
+	//Port the hosted game session can advertise for latency probes, 0 if nothing answers them
+	int32 StartLatencyEchoServer();
+	void StopLatencyEchoServer();
+	void OnGameModePreLogin(class AGameModeBase* GameMode, const FUniqueNetIdRepl& NewPlayer, FString& ErrorMessage);
+	void OnGameModePostLogin(class AGameModeBase* GameMode, APlayerController* NewPlayer);
+	void OnGameModeLogout(class AGameModeBase* GameMode, class AController* Exiting);
+	//Copies what differs between the two into LiveSettings, returns how many attributes changed
+	static int32 ApplyChangedSettings(FOnlineSessionSettings& LiveSettings, const FOnlineSessionSettings& InSessionSettings);
+
+	//Fulfils the futures of requests that left the queue without completing
+	void OnOperationDropped(FMultiplayerOperationHandle Handle, EMultiplayerSessionOperation Type, EMultiplayerOperationAbortReason Reason, bool bWasStarted);
+	void CancelPendingResults();
+	void DropFindBestResults();
+
+	FMultiplayerOperationHandle EnqueueCreateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName);
+	FMultiplayerOperationHandle EnqueueUpdateSession(TSharedRef<const FOnlineSessionSettings> InSessionSettings, FName SessionName);
+
+	//Creates the configured backend if there is none yet, false if there is none to be had
+	bool ResolveSessionBackend() const;
+	TSharedPtr<IMultiplayerSessionsBackend> CreateSessionBackend() const;
+
+	bool StartCreateSession(FName SessionName);
+	bool StartDestroySession(FName SessionName);
+	void StopActiveSearch();
+	TSharedRef<FOnlineSessionSearch> MakeSessionSearch(const FMultiplayerSearchSettings& InSearchSettings);
+	//Gives the search's storage back for the next one
+	void RecycleSessionSearch(TSharedPtr<FOnlineSessionSearch>&& Search);
+	//Keeps the full results of the best sessions within the memory budget once the last search is indexed
+	void TrimSearchResults();
+	//Trims once listeners got the full results, unless one of them started another search meanwhile
+	void TrimSearchResultsAfterBroadcast(uint32 SearchGeneration);
+	SIZE_T GetSearchResultsBudget() const;
+	//Null when there is no local player, the backend then acts for its default user
+	FUniqueNetIdPtr GetLocalUserId() const;
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+	void OnMapPreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+	void OnReconnectRecordLoaded(const FString& SlotName, const int32 UserIndex, class USaveGame* SaveGame);
+	void SaveReconnectRecord();
+	bool StartDirectReconnect(APlayerController* PlayerController);
+	void StartReconnectSearch();
+	void CompleteReconnect(bool bWasSuccessfull);
+
+	//Invalid future if the backend can't look up single sessions right now, the caller then has to search.
+	//An unset result means the session is gone
+	TFuture<TOptional<FOnlineSessionSearchResult>> FindSessionByIdAsync(const FString& InSessionId);
+	void OnFindSessionByIdComplete(bool bWasSuccessfull, const FOnlineSessionSearchResult& SearchResult);
+	void OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString);
+	void OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString);
+
+	//Runs LastSearchSettings against the backend with AdaptiveSearchSize results, replacing the results of the last round
+	bool StartSearchRound();
+	//Counts results of the running round that arrived since the last call, returns the total that qualified
+	int32 CountQualifiedResults();
+	//Starts the next round of an adaptive search that came back with too few qualified results, false when it is over
+	bool TryWidenSearch(bool bWasSuccessfull);
+	bool TickSearchStream(float DeltaTime);
+	void FlushSearchStream(bool bFlushPartialBatch);
+	void StopSearchStream();
+
+	bool TickBackgroundRefresh(float DeltaTime);
+	void CompleteRefreshSearch(bool bWasSuccessfull);
+	//Cancels a running refresh search, called before any request the player is waiting for
+	void YieldRefreshSearch();
+	//False while result indices of the current search are in use by a join or a latency probe
+	bool CanReplaceSearchResults() const;
+
+	//Indexes LastSessionSearch on the budget of LastSearchSettings, returns false if there is nothing to spread out
+	bool StartResultsProcessing(bool bIsRefresh, bool bWasSuccessfull);
+	bool TickResultsProcessing(float DeltaTime);
+	void StopResultsProcessing();
+
+	void ProbeBestSessions(const FString& InMatchType, int32 NumCandidates);
+	void OnLatencyProbeComplete(const TArray<int32>& RttInMs);
 
-	void LogError(FString ErrorText);
-	void LogWarning(FString WarningText);
-	void LogSuccess(FString SuccessText);
-	void LogVerbose(FString VerboseText);
-	void DebugLog(FString Text, FColor Color);
+	bool StartJoinSession(const FOnlineSessionSearchResult& FindSessionsResult, FName SessionName);
+	bool TryNextJoinCandidate();
 };
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "MultiplayerSessionsSearchCache.h"
+#include "ServerBrowser.generated.h"
+
+UENUM(BlueprintType)
+enum class EServerBrowserSort : uint8
+{
+	Ping,
+	OpenSlots,
+	MatchType
+};
+
+/**
+ * List view item of the server browser. Only points at a search result, pooled and reused across searches
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UServerBrowserItem : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//Copied from the search cache when the item is handed out, everything sorting and filtering look at
+	FMultiplayerSessionSummary Summary;
+};
+
+/**
+ * Server list on top of a UListView, only the visible rows get an entry widget and those are recycled while scrolling.
+ * Fills itself from the results of whatever search the subsystem runs, as they are streamed in.
+ * Set the entry widget class (usually a child of UServerBrowserEntry) on the SessionList list view
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UServerBrowser : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable)
+	void Search(int32 MaxSearchResults = 10000);
+
+	UFUNCTION(BlueprintCallable)
+	void SetSort(EServerBrowserSort InSort, bool bInAscending = true);
+
+	//Empty shows every match type
+	UFUNCTION(BlueprintCallable)
+	void SetFilter(const FString& InMatchType, bool bInHideFullSessions = true);
+
+	UFUNCTION(BlueprintCallable)
+	void JoinSelectedSession();
+
+	UFUNCTION(BlueprintPure)
+	int32 GetNumListedSessions() const { return ListedItems.Num(); }
+
+protected:
+	virtual bool Initialize() override;
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	///
+	/// Callbacks for the custom delegates on the MultiplayerSessionsSubsystem
+	///
+	void OnFindSessionsBatch(TArrayView<const FOnlineSessionSearchResult> SearchResults, int32 FirstResultIndex);
+	void OnFindSessions(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessfull);
+	void OnSearchResultsProgress(int32 NumProcessed, int32 NumResults);
+	void OnSearchCacheRefreshed();
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+
+	void OnSessionDoubleClicked(UObject* Item);
+
+private:
+	UPROPERTY(meta = (BindWidget))
+	class UListView* SessionList;
+
+	UPROPERTY()
+	class UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem;
+
+	//Every item ever handed out, the first NumItemsInUse are currently listed
+	UPROPERTY()
+	TArray<TObjectPtr<UServerBrowserItem>> ItemPool;
+	int32 NumItemsInUse{ 0 };
+	//Set when pooled items were handed out again, rows still showing them need to be set up anew
+	bool bItemsReused{ false };
+
+	//Sorted and filtered, kept alive by ItemPool
+	TArray<UObject*> ListedItems;
+	//Summaries of the current search looked at so far, new ones are merged into the list as they come in
+	int32 NumSummariesSeen{ 0 };
+	uint32 SummariesGeneration{ 0 };
+
+	EServerBrowserSort Sort{ EServerBrowserSort::Ping };
+	bool bAscending{ true };
+	FString MatchTypeFilter;
+	bool bHideFullSessions{ true };
+	//Resolved lazily, the match type may only show up with a later batch
+	uint16 MatchTypeFilterId{ 0 };
+
+	bool bIsJoining{ false };
+
+	void ResetList();
+	void RebuildList();
+	//Merges summaries that arrived since the last call into the sorted list
+	void AppendNewSummaries();
+	bool PassesFilter(const FMultiplayerSessionSummary& Summary);
+	bool IsSortedBefore(const FMultiplayerSessionSummary& A, const FMultiplayerSessionSummary& B) const;
+	UServerBrowserItem* AcquireItem(const FMultiplayerSessionSummary& Summary);
+	void UpdateListView();
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/IUserObjectListEntry.h"
+#include "ServerBrowserEntry.generated.h"
+
+/**
+ * Row of the server browser. Only as many exist as fit on screen, the list view hands them a different item while scrolling
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UServerBrowserEntry : public UUserWidget, public IUserObjectListEntry
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+
+private:
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UTextBlock* MatchNameText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* MatchTypeText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* SlotsText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* PingText;
+};